@@ -0,0 +1,84 @@
+// Quadtree container comparison example code
+
+#include <vector>
+
+#include "voro++_2d.hh"
+using namespace voro;
+
+// Set the number of particles to add to the containers
+const int particles=2000;
+
+// This function returns a random floating point number between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// Computes the Voronoi cells in a quadtree container, by visiting each leaf of
+// the tree, and stores the cell areas in an array indexed by particle ID
+void quad_areas(quadtree &qt,std::vector<double> &area) {
+	if(qt.id==NULL) {
+		quad_areas(*qt.qsw,area);quad_areas(*qt.qse,area);
+		quad_areas(*qt.qnw,area);quad_areas(*qt.qne,area);
+	} else {
+		voronoicell_2d c;
+		for(int j=0;j<qt.co;j++) if(qt.compute_cell(c,j)) area[qt.id[j]]=c.area();
+	}
+}
+
+// Computes the Voronoi cells in a grid-based container, and stores the cell
+// areas in an array indexed by particle ID
+template<class c_class>
+void grid_areas(c_class &con,std::vector<double> &area) {
+	voronoicell_2d c;
+	c_loop_all_2d vl(con);
+	if(vl.start()) do if(con.compute_cell(c,vl)) area[vl.pid()]=c.area();
+	while(vl.inc());
+}
+
+// Prints the largest difference between two sets of cell areas
+void compare(const char *name,std::vector<double> &a1,std::vector<double> &a2) {
+	double d,dmax=0,t1=0,t2=0;
+	for(int i=0;i<particles;i++) {
+		d=fabs(a1[i]-a2[i]);
+		if(d>dmax) dmax=d;
+		t1+=a1[i];t2+=a2[i];
+	}
+	printf("%s:\n  Total areas             : %g %g\n"
+	       "  Maximum area difference : %g\n",name,t1,t2,dmax);
+}
+
+int main() {
+	int i;double x,y,r;
+	std::vector<double> a1(particles,0),a2(particles,0);
+
+	// Create a quadtree container and a grid-based container for the
+	// square [-1,1]^2, and add the same random particles to both. The
+	// particles are clustered toward the center, so that the quadtree is
+	// refined unevenly.
+	container_quad_2d qcon(-1,1,-1,1);
+	container_2d con(-1,1,-1,1,12,12,false,false,8);
+	for(i=0;i<particles;i++) {
+		x=2*rnd()-1;y=2*rnd()-1;r=0.2+0.8*(x*x+y*y)*0.5;
+		qcon.put(i,x*r,y*r);
+		con.put(i,x*r,y*r);
+	}
+
+	// Compute the cells in both containers and compare their areas
+	qcon.setup_neighbors();
+	quad_areas(qcon,a1);
+	grid_areas(con,a2);
+	compare("Voronoi tessellation",a1,a2);
+
+	// Repeat the comparison for the radical tessellation, using particles
+	// with random radii
+	container_quad_poly_2d qpcon(-1,1,-1,1);
+	container_poly_2d pcon(-1,1,-1,1,12,12,false,false,8);
+	for(i=0;i<particles;i++) {
+		x=2*rnd()-1;y=2*rnd()-1;r=0.005+0.02*rnd();
+		qpcon.put(i,x,y,r);
+		pcon.put(i,x,y,r);
+	}
+	qpcon.setup_neighbors();
+	a1.assign(particles,0);a2.assign(particles,0);
+	quad_areas(qpcon,a1);
+	grid_areas(pcon,a2);
+	compare("Radical tessellation",a1,a2);
+}
@@ -0,0 +1,53 @@
+#include <ctime>
+
+#include "voro++_2d.hh"
+using namespace voro;
+
+// Set up the number of blocks that the container is divided into. If the
+// preprocessor variable NNN hasn't been passed to the code, then initialize it
+// to a good value. Otherwise, use the value that has been passed.
+#ifndef NNN
+#define NNN 26
+#endif
+
+// Set the number of particles that are going to be randomly introduced, and
+// the number of times that each computation is repeated
+const int particles=100000;
+const int repeats=10;
+
+// This function returns a random floating point number between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	clock_t start,end;
+	int i;double x,y;
+
+	// Initialize the container class to be the unit square, with
+	// non-periodic boundary conditions, and randomly add particles into it
+	container_2d con(0,1,0,1,NNN,NNN,false,false,16);
+	for(i=0;i<particles;i++) {
+		x=rnd();
+		y=rnd();
+		con.put(i,x,y);
+	}
+
+	// Time the computation of all cells using the container
+	start=clock();
+	for(i=0;i<repeats;i++) con.compute_all_cells();
+	end=clock();
+	double t_scalar=double(end-start)/(CLOCKS_PER_SEC*repeats);
+
+	// Time the computation of all cells using the lockstep class, which
+	// includes sorting the particles into its grid
+	voro_lockstep_2d vl(con);
+	start=clock();
+	for(i=0;i<repeats;i++) vl.compute_all_cells();
+	end=clock();
+	double t_lockstep=double(end-start)/(CLOCKS_PER_SEC*repeats);
+
+	// Print the timings, and check that the two methods give the same
+	// total area
+	printf("Container: %g s\nLockstep:  %g s (%d cells computed by the container)\n"
+	       "Speedup:   %g\n",t_scalar,t_lockstep,vl.fallbacks,t_scalar/t_lockstep);
+	printf("Total areas: %.12g %.12g\n",con.sum_cell_areas(),vl.sum_cell_areas());
+}
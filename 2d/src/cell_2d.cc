@@ -7,10 +7,39 @@
 namespace voro {
 
 /** Constructs a 2D Voronoi cell and sets up the initial memory. */
-voronoicell_base_2d::voronoicell_base_2d() :
-	current_vertices(init_vertices), current_delete_size(init_delete_size),
-	ed(new int[2*current_vertices]), pts(new double[2*current_vertices]),
-	ds(new int[current_delete_size]), stacke(ds+current_delete_size) {
+voronoicell_base_2d::voronoicell_base_2d() {
+	allocate_memory();
+}
+
+/** Allocates the vertex, edge, and delete stack memory with the default
+ * sizes. This is called by the constructor, and by the initialization routines
+ * of a cell that has been moved from. */
+void voronoicell_base_2d::allocate_memory() {
+	current_vertices=init_vertices;current_delete_size=init_delete_size;
+	ed=new int[2*current_vertices];pts=new double[2*current_vertices];
+	ds=new int[current_delete_size];stacke=ds+current_delete_size;
+}
+
+/** The move constructor takes over the dynamically allocated memory of
+ * another cell, and does not allocate any memory. The other cell is left
+ * empty, and its memory is allocated again when it is next initialized.
+ * \param[in] vb the cell to move from. */
+voronoicell_base_2d::voronoicell_base_2d(voronoicell_base_2d &&vb) noexcept :
+	current_vertices(vb.current_vertices), current_delete_size(vb.current_delete_size),
+	p(vb.p), ed(vb.ed), pts(vb.pts), ds(vb.ds), stacke(vb.stacke) {
+	vb.current_vertices=vb.current_delete_size=vb.p=0;
+	vb.ed=vb.ds=vb.stacke=0;vb.pts=0;
+}
+
+/** Exchanges the vertex and memory information with another cell, without
+ * allocating any memory.
+ * \param[in] vb the cell to exchange with. */
+void voronoicell_base_2d::swap(voronoicell_base_2d &vb) noexcept {
+	std::swap(current_vertices,vb.current_vertices);
+	std::swap(current_delete_size,vb.current_delete_size);
+	std::swap(p,vb.p);
+	std::swap(ed,vb.ed);std::swap(pts,vb.pts);
+	std::swap(ds,vb.ds);std::swap(stacke,vb.stacke);
 }
 
 /** The voronoicell_2d destructor deallocates all of the dynamic memory. */
@@ -24,6 +53,7 @@ voronoicell_base_2d::~voronoicell_base_2d() {
  * \param[in] (xmin,xmax) the minimum and maximum x coordinates.
  * \param[in] (ymin,ymax) the minimum and maximum y coordinates. */
 void voronoicell_base_2d::init_base(double xmin,double xmax,double ymin,double ymax) {
+	if(current_vertices==0) allocate_memory();
 	p=4;xmin*=2;xmax*=2;ymin*=2;ymax*=2;
 	*pts=xmin;pts[1]=ymin;
 	pts[2]=xmax;pts[3]=ymin;
@@ -530,6 +560,7 @@ void voronoicell_neighbor_2d::neighbors(vector<int> &v) const {
 
 void voronoicell_neighbor_2d::init(double xmin,double xmax,double ymin,double ymax) {
 	init_base(xmin,xmax,ymin,ymax);
+	if(ne==0) ne=new int[current_vertices];
 	*ne=-3;ne[1]=-2;ne[2]=-4;ne[3]=-1;
 }
 
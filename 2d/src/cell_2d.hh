@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <vector>
+#include <utility>
 using namespace std;
 
 #include "common_2d.hh"
@@ -35,7 +36,17 @@ class voronoicell_base_2d {
 		 * the positions of the vertices. */
 		double *pts;
 		voronoicell_base_2d();
+		voronoicell_base_2d(voronoicell_base_2d &&vb) noexcept;
 		~voronoicell_base_2d();
+		void swap(voronoicell_base_2d &vb) noexcept;
+		/** Moves another cell into this class by exchanging their
+		 * memory, so that no allocation takes place.
+		 * \param[in] vb the cell to move from.
+		 * \return A reference to this class. */
+		inline voronoicell_base_2d& operator=(voronoicell_base_2d &&vb) noexcept {
+			swap(vb);
+			return *this;
+		}
 		void init_base(double xmin,double xmax,double ymin,double ymax);
 		void draw_gnuplot(double x,double y,FILE *fp=stdout);
 		/** Outputs the edges of the Voronoi cell in gnuplot format to
@@ -108,6 +119,7 @@ class voronoicell_base_2d {
 		inline double pos(double x,double y,double rsq,int qp) {
 			return x*pts[2*qp]+y*pts[2*qp+1]-rsq;
 		}
+		void allocate_memory();
 	private:
 		template<class vc_class>
 		void add_memory_vertices(vc_class &vc);
@@ -152,7 +164,22 @@ class voronoicell_neighbor_2d : public voronoicell_base_2d {
 		using voronoicell_base_2d::nplane;
 		int *ne;
 		voronoicell_neighbor_2d() : ne(new int[init_vertices]) {}
+		/** Moves another cell into this class, taking over its memory
+		 * and neighbor information. The other cell is left empty,
+		 * and its memory is allocated again when it is next
+		 * initialized.
+		 * \param[in] c the cell to move from. */
+		voronoicell_neighbor_2d(voronoicell_neighbor_2d &&c) noexcept
+			: voronoicell_base_2d(std::move(c)), ne(c.ne) {c.ne=0;}
 		~voronoicell_neighbor_2d() {delete [] ne;}
+		/** Moves another cell into this class by exchanging their
+		 * memory and neighbor information.
+		 * \param[in] c the cell to move from.
+		 * \return A reference to this class. */
+		inline voronoicell_neighbor_2d& operator=(voronoicell_neighbor_2d &&c) noexcept {
+			swap(c);std::swap(ne,c.ne);
+			return *this;
+		}
 		inline bool nplane(double x,double y,double rs,int p_id) {
 			return nplane(*this,x,y,rs,p_id);
 		}
@@ -15,10 +15,12 @@ namespace voro {
 void voronoicell_nonconvex_neighbor_2d::init(double xmin,double xmax,double ymin,double ymax) {
 	nonconvex=exclude=false;
 	init_base(xmin,xmax,ymin,ymax);
+	if(ne==0) ne=new int[current_vertices];
 	*ne=-3;ne[1]=-2;ne[2]=-4;ne[3]=-1;
 }
 
 void voronoicell_nonconvex_base_2d::init_nonconvex_base(double xmin,double xmax,double ymin,double ymax,double wx0,double wy0,double wx1,double wy1) {
+	if(current_vertices==0) allocate_memory();
 	xmin*=2;xmax*=2;ymin*=2;ymax*=2;
 	int f0=face(xmin,xmax,ymin,ymax,wx0,wy0),
 	    f1=face(xmin,xmax,ymin,ymax,wx1,wy1);
@@ -61,6 +63,7 @@ void voronoicell_nonconvex_base_2d::init_nonconvex_base(double xmin,double xmax,
 
 void voronoicell_nonconvex_neighbor_2d::init_nonconvex(double xmin,double xmax,double ymin,double ymax,double wx0,double wy0,double wx1,double wy1) {
 	init_nonconvex_base(xmin,xmax,ymin,ymax,wx0,wy0,wx1,wy1);
+	if(ne==0) ne=new int[current_vertices];
 	*ne=-5;
 	for(int i=1;i<p-1;i++) ne[i]=-99;
 	ne[p-1]=-5;
@@ -69,7 +69,23 @@ class voronoicell_nonconvex_neighbor_2d : public voronoicell_nonconvex_base_2d {
 	public:
 		int *ne;
 		voronoicell_nonconvex_neighbor_2d() : ne(new int[init_vertices]) {}
+		/** Moves another cell into this class, taking over its memory
+		 * and neighbor information. The other cell is left empty,
+		 * and its memory is allocated again when it is next
+		 * initialized.
+		 * \param[in] c the cell to move from. */
+		voronoicell_nonconvex_neighbor_2d(voronoicell_nonconvex_neighbor_2d &&c) noexcept
+			: voronoicell_nonconvex_base_2d(std::move(c)), ne(c.ne) {c.ne=0;}
 		~voronoicell_nonconvex_neighbor_2d() {delete [] ne;}
+		/** Moves another cell into this class by exchanging their
+		 * memory and neighbor information.
+		 * \param[in] c the cell to move from.
+		 * \return A reference to this class. */
+		inline voronoicell_nonconvex_neighbor_2d& operator=(voronoicell_nonconvex_neighbor_2d &&c) noexcept {
+			voronoicell_nonconvex_base_2d::operator=(std::move(c));
+			std::swap(ne,c.ne);
+			return *this;
+		}
 		inline bool nplane(double x,double y,double rs,int p_id) {
 			return nplane_base(*this,x,y,rs,p_id);
 		}
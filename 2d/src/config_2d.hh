@@ -24,6 +24,18 @@ const int max_temp_label_size=16777216;
 
 const double large_number=1e30;
 
+/** The number of cells that the voro_lockstep_2d class computes together.
+ * Each step of the computation is carried out for all of these cells in a
+ * short fixed-length loop, which the compiler can turn into vector
+ * instructions. */
+const int lockstep_width=4;
+/** The maximum number of vertices of a cell in the voro_lockstep_2d class.
+ * Cells with more vertices are computed separately by the container. */
+const int lockstep_max_vertices=16;
+/** The average number of particles per block in the grid that the
+ * voro_lockstep_2d class uses to search for neighbors. */
+const double lockstep_block_particles=3;
+
 // If the initial memory is too small, the program dynamically allocates more.
 // However, if the limits below are reached, then the program bails out.
 /** The maximum memory allocation for the number of vertices. */
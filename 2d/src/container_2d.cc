@@ -38,9 +38,21 @@ container_base_2d::container_base_2d(double ax_,double bx_,double ay_,double by_
 	for(l=0;l<nxy;l++) p[l]=new double[ps*init_mem];
 }
 
+/** The move constructor takes over the particle storage and walls of another
+ * container. The other container is left without any particle storage, and
+ * may only be destroyed.
+ * \param[in] cb the container to move from. */
+container_base_2d::container_base_2d(container_base_2d &&cb) noexcept
+	: voro_base_2d(std::move(cb)), wall_list_2d(std::move(cb)),
+	ax(cb.ax), bx(cb.bx), ay(cb.ay), by(cb.by), xperiodic(cb.xperiodic), yperiodic(cb.yperiodic),
+	id(cb.id), p(cb.p), co(cb.co), mem(cb.mem), ps(cb.ps) {
+	cb.id=0;cb.p=0;cb.co=cb.mem=0;
+}
+
 /** The container destructor frees the dynamically allocated memory. */
 container_base_2d::~container_base_2d() {
 	int l;
+	if(p==0) return;
 	for(l=nxy-1;l>=0;l--) delete [] p[l];
 	for(l=nxy-1;l>=0;l--) delete [] id[l];
 	delete [] id;
@@ -75,6 +87,20 @@ container_poly_2d::container_poly_2d(double ax_,double bx_,double ay_,double by_
 	: container_base_2d(ax_,bx_,ay_,by_,nx_,ny_,xperiodic_,yperiodic_,init_mem,3),
 	vc(*this,xperiodic_?2*nx_+1:nx_,yperiodic_?2*ny_+1:ny_) {ppr=p;}
 
+/** The move constructor takes over the particles of another container, and
+ * rebinds the computation class to this container.
+ * \param[in] c the container to move from. */
+container_2d::container_2d(container_2d &&c) noexcept
+	: container_base_2d(std::move(c)), vc(*this,std::move(c.vc)) {}
+
+/** The move constructor takes over the particles of another container, and
+ * rebinds the computation class to this container.
+ * \param[in] c the container to move from. */
+container_poly_2d::container_poly_2d(container_poly_2d &&c) noexcept
+	: container_base_2d(std::move(c)), vc(*this,std::move(c.vc)) {
+	ppr=p;max_radius=c.max_radius;
+}
+
 /** Put a particle into the correct region of the container.
  * \param[in] n the numerical ID of the inserted particle.
  * \param[in] (x,y) the position vector of the inserted particle. */
@@ -486,6 +512,15 @@ void container_base_2d::draw_domain_pov(FILE *fp) {
 wall_list_2d::wall_list_2d() : walls(new wall_2d*[init_wall_size]), wep(walls), wel(walls+init_wall_size),
 	current_wall_size(init_wall_size) {}
 
+/** The move constructor takes over the array of wall pointers from another
+ * wall_list. The other list is left empty.
+ * \param[in] wl the wall_list to move from. */
+wall_list_2d::wall_list_2d(wall_list_2d &&wl) noexcept : walls(wl.walls), wep(wl.wep), wel(wl.wel),
+	current_wall_size(wl.current_wall_size) {
+	wl.walls=wl.wep=wl.wel=0;
+	wl.current_wall_size=0;
+}
+
 /** The wall_list destructor frees the array of pointers to the wall classes.
  */
 wall_list_2d::~wall_list_2d() {
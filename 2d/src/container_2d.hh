@@ -60,6 +60,7 @@ class wall_list_2d {
 		 */
 		wall_2d **wep;
 		wall_list_2d();
+		wall_list_2d(wall_list_2d &&wl) noexcept;
 		~wall_list_2d();
 		/** Adds a wall to the list.
 		 * \param[in] w the wall to add. */
@@ -157,6 +158,7 @@ class container_base_2d : public voro_base_2d, public wall_list_2d {
 		container_base_2d(double ax_,double bx_,double ay_,double by_,
 				int nx_,int ny_,bool xperiodic_,bool yperiodic_,
 				int init_mem,int ps_);
+		container_base_2d(container_base_2d &&cb) noexcept;
 		~container_base_2d();
 		bool point_inside(double x,double y);
 		void region_count();
@@ -279,6 +281,7 @@ class container_2d : public container_base_2d, public radius_mono {
 	public:
 		container_2d(double ax_,double bx_,double ay_,double by_,
 			     int nx_,int ny_,bool xperiodic_,bool yperiodic_,int init_mem);
+		container_2d(container_2d &&c) noexcept;
 		void clear();
 		void put(int n,double x,double y);
 		void put(particle_order_2d &vo,int n,double x,double y);
@@ -480,6 +483,7 @@ class container_poly_2d : public container_base_2d, public radius_poly {
 	public:
 		container_poly_2d(double ax_,double bx_,double ay_,double by_,
 			       int nx_,int ny_,bool xperiodic_,bool yperiodic_,int init_mem);
+		container_poly_2d(container_poly_2d &&c) noexcept;
 		void clear();
 		void put(int n,double x,double y,double r);
 		void put(particle_order_2d &vo,int n,double x,double y,double r);
@@ -13,9 +13,15 @@ container_quad_2d::container_quad_2d(double ax_,double bx_,double ay_,double by_
 
 }
 
-quadtree::quadtree(double cx_,double cy_,double lx_,double ly_,container_quad_2d &parent_) :
-	parent(parent_), cx(cx_), cy(cy_), lx(lx_), ly(ly_), ps(2),
-	id(new int[qt_max]), p(new double[ps*qt_max]), co(0), mask(0), nco(0), nmax(0) {
+container_quad_2d::container_quad_2d(double ax_,double bx_,double ay_,double by_,int ps_) :
+	quadtree((ax_+bx_)*0.5,(ay_+by_)*0.5,(bx_-ax_)*0.5,(by_-ay_)*0.5,*this,ps_),
+	ax(ax_), bx(bx_), ay(ay_), by(by_), bmask(0) {
+
+}
+
+quadtree::quadtree(double cx_,double cy_,double lx_,double ly_,container_quad_2d &parent_,int ps_) :
+	parent(parent_), cx(cx_), cy(cy_), lx(lx_), ly(ly_), ps(ps_),
+	id(new int[qt_max]), p(new double[ps*qt_max]), co(0), max_r(0), mask(0), nco(0), nmax(0) {
 
 }
 
@@ -32,13 +38,16 @@ quadtree::~quadtree() {
 
 void quadtree::split() {
 	double hx=0.5*lx,hy=0.5*ly;
-	qsw=new quadtree(cx-hx,cy-hy,hx,hy,parent);
-	qse=new quadtree(cx+hx,cy-hy,hx,hy,parent);
-	qnw=new quadtree(cx-hx,cy+hy,hx,hy,parent);
-	qne=new quadtree(cx+hx,cy+hy,hx,hy,parent);
-	for(int i=0;i<co;i++)
-		(p[ps*i]<cx?(p[ps*i+1]<cy?qsw:qnw)
-			   :(p[ps*i+1]<cy?qse:qne))->quick_put(id[i],p[ps*i],p[ps*i+1]);
+	qsw=new quadtree(cx-hx,cy-hy,hx,hy,parent,ps);
+	qse=new quadtree(cx+hx,cy-hy,hx,hy,parent,ps);
+	qnw=new quadtree(cx-hx,cy+hy,hx,hy,parent,ps);
+	qne=new quadtree(cx+hx,cy+hy,hx,hy,parent,ps);
+	for(int i=0;i<co;i++) {
+		quadtree *q=p[ps*i]<cx?(p[ps*i+1]<cy?qsw:qnw)
+				      :(p[ps*i+1]<cy?qse:qne);
+		if(ps==3) q->quick_put(id[i],p[ps*i],p[ps*i+1],p[ps*i+2]);
+		else q->quick_put(id[i],p[ps*i],p[ps*i+1]);
+	}
 	delete [] id;id=NULL;
 	delete [] p;
 }
@@ -54,6 +63,18 @@ void quadtree::put(int i,double x,double y) {
 	(x<cx?(y<cy?qsw:qnw):(y<cy?qse:qne))->put(i,x,y);
 }
 
+void quadtree::put(int i,double x,double y,double r) {
+	if(id!=NULL) {
+		if(co==qt_max) split();
+		else {
+			quick_put(i,x,y,r);
+			return;
+		}
+	}
+	if(r>max_r) max_r=r;
+	(x<cx?(y<cy?qsw:qnw):(y<cy?qse:qne))->put(i,x,y,r);
+}
+
 void quadtree::draw_cross(FILE *fp) {
 	if(id==NULL) {
 		fprintf(fp,"%g %g\n%g %g\n\n\n%g %g\n%g %g\n\n\n",
@@ -97,7 +118,9 @@ void quadtree::draw_particles(FILE *fp) {
 		qse->draw_particles(fp);
 		qnw->draw_particles(fp);
 		qne->draw_particles(fp);
-	} else for(int i=0;i<co;i++)
+	} else if(ps==3) for(int i=0;i<co;i++)
+		fprintf(fp,"%d %g %g %g\n",id[i],p[ps*i],p[ps*i+1],p[ps*i+2]);
+	else for(int i=0;i<co;i++)
 		fprintf(fp,"%d %g %g\n",id[i],p[ps*i],p[ps*i+1]);
 }
 
@@ -198,21 +221,24 @@ void quadtree::add_neighbor_memory() {
 
 bool quadtree::compute_cell(voronoicell_2d &c,int j) {
 	int i;
-	double x=p[ps*j],y=p[ps*j+1],x1,y1,xlo,xhi,ylo,yhi;
+	double x=p[ps*j],y=p[ps*j+1],x1,y1,rs,xlo,xhi,ylo,yhi,rr=0,rm=0,rmg=0;
 	quadtree *q;
 
-	parent.initialize_voronoicell(c,x,p[ps*j+1]);
-	for(i=0;i<j;i++) {
-		x1=p[ps*i]-x;
-		y1=p[ps*i+1]-y;
-		if(!c.nplane(x1,y1,x1*x1+y1*y1,id[i])) return false;
+	// For the radical tessellation, compute the radius offsets used to
+	// scale the block tests. The offset for the whole container is
+	// used to decide whether the search should continue past a node.
+	if(ps==3) {
+		rr=p[ps*j+2]*p[ps*j+2];
+		rmg=rr-parent.max_r*parent.max_r;
 	}
-	i++;
-	while(i<co) {
+
+	parent.initialize_voronoicell(c,x,y);
+	for(i=0;i<co;i++) if(i!=j) {
 		x1=p[ps*i]-x;
 		y1=p[ps*i+1]-y;
-		if(!c.nplane(x1,y1,x1*x1+y1*y1,id[i])) return false;
-		i++;
+		rs=x1*x1+y1*y1;
+		if(ps==3) rs+=rr-p[ps*i+2]*p[ps*i+2];
+		if(!c.nplane(x1,y1,rs,id[i])) return false;
 	}
 
 	unsigned int &bm=parent.bmask;
@@ -236,59 +262,80 @@ bool quadtree::compute_cell(voronoicell_2d &c,int j) {
 		xlo-=x;xhi-=x;
 		ylo-=y;yhi-=y;
 
-		if(xlo>0) {
-			if(ylo>0) {
-				if(corner_test(c,xlo,ylo,xhi,yhi)) continue;
-			} else if(yhi<0) {
-				if(corner_test(c,xlo,yhi,xhi,ylo)) continue;
-			} else {
-				if(edge_x_test(c,xlo,ylo,yhi)) continue;
-			}
-		} else if(xhi<0) {
-			if(ylo>0) {
-				if(corner_test(c,xhi,ylo,xlo,yhi)) continue;
-			} else if(yhi<0) {
-				if(corner_test(c,xhi,yhi,xlo,ylo)) continue;
-			} else {
-				if(edge_x_test(c,xhi,ylo,yhi)) continue;
-			}
-		} else {
-			if(ylo>0) {
-				if(edge_y_test(c,xlo,ylo,xhi)) continue;
-			} else if(yhi<0) {
-				if(edge_y_test(c,xlo,yhi,xhi)) continue;
-			} else voro_fatal_error("Compute cell routine revisiting central block, which should never\nhappen.",VOROPP_INTERNAL_ERROR);
+		// Test whether the particles in this node could cut the cell,
+		// using the node's own maximum radius. If they can't, then
+		// check whether any particle in the container at this
+		// distance could, to decide whether to search further.
+		if(ps==3) {
+			rm=rr-q->max_r*q->max_r;
+			if(rm>0) rm=0;
 		}
-
-		for(i=0;i<q->co;i++) {
+		if(block_test(c,xlo,xhi,ylo,yhi,rm)) {
+			if(ps==2||block_test(c,xlo,xhi,ylo,yhi,rmg)) continue;
+		} else for(i=0;i<q->co;i++) {
 			x1=q->p[ps*i]-x;
 			y1=q->p[ps*i+1]-y;
-			if(!c.nplane(x1,y1,x1*x1+y1*y1,id[i])) return false;
+			rs=x1*x1+y1*y1;
+			if(ps==3) rs+=rr-q->p[ps*i+2]*q->p[ps*i+2];
+			if(!c.nplane(x1,y1,rs,q->id[i])) return false;
 		}
 
 		for(i=0;i<q->nco;i++) if(q->nei[i]->mask!=bm) {
 			dq.push_back(q->nei[i]);
 			q->nei[i]->mask=bm;
 		}
-	} 
+	}
 	return true;
 }
 
-inline bool quadtree::corner_test(voronoicell_2d &c,double xl,double yl,double xh,double yh) {
-	if(c.plane_intersects_guess(xl,yh,xl*xl+yl*yh)) return false;
-	if(c.plane_intersects(xh,yl,xl*xh+yl*yl)) return false;
+/** Tests whether any particle within a quadtree node could cut a Voronoi
+ * cell. For the radical tessellation, the plane displacements are scaled by a
+ * factor computed from the closest point of the node, which bounds the effect
+ * of the particle radii.
+ * \param[in] c the Voronoi cell to test.
+ * \param[in] (xlo,xhi,ylo,yhi) the bounds of the node, relative to the
+ *                               particle.
+ * \param[in] rm the radius squared of the particle minus the maximum radius
+ *               squared of the node, which must be zero or negative.
+ * \return True if no particle in the node could cut the cell, false
+ *         otherwise. */
+bool quadtree::block_test(voronoicell_2d &c,double xlo,double xhi,double ylo,double yhi,double rm) {
+	if(xlo>0) {
+		if(ylo>0) return corner_test(c,xlo,ylo,xhi,yhi,rm);
+		else if(yhi<0) return corner_test(c,xlo,yhi,xhi,ylo,rm);
+		return edge_x_test(c,xlo,ylo,yhi,rm);
+	} else if(xhi<0) {
+		if(ylo>0) return corner_test(c,xhi,ylo,xlo,yhi,rm);
+		else if(yhi<0) return corner_test(c,xhi,yhi,xlo,ylo,rm);
+		return edge_x_test(c,xhi,ylo,yhi,rm);
+	}
+	if(ylo>0) return edge_y_test(c,xlo,ylo,xhi,rm);
+	else if(yhi<0) return edge_y_test(c,xlo,yhi,xhi,rm);
+	voro_fatal_error("Compute cell routine revisiting central block, which should never\nhappen.",VOROPP_INTERNAL_ERROR);
+	return false;
+}
+
+inline bool quadtree::corner_test(voronoicell_2d &c,double xl,double yl,double xh,double yh,double rm) {
+	double rv=1+rm/(xl*xl+yl*yl);
+	if(rv<=0) return false;
+	if(c.plane_intersects_guess(xl,yh,rv*(xl*xl+yl*yh))) return false;
+	if(c.plane_intersects(xh,yl,rv*(xl*xh+yl*yl))) return false;
 	return true;
 }
 
-inline bool quadtree::edge_x_test(voronoicell_2d &c,double xl,double y0,double y1) {
-	if(c.plane_intersects_guess(xl,y0,xl*xl)) return false;
-	if(c.plane_intersects(xl,y1,xl*xl)) return false;
+inline bool quadtree::edge_x_test(voronoicell_2d &c,double xl,double y0,double y1,double rm) {
+	double rv=1+rm/(xl*xl);
+	if(rv<=0) return false;
+	if(c.plane_intersects_guess(xl,y0,rv*xl*xl)) return false;
+	if(c.plane_intersects(xl,y1,rv*xl*xl)) return false;
 	return true;
 }
 
-inline bool quadtree::edge_y_test(voronoicell_2d &c,double x0,double yl,double x1) {
-	if(c.plane_intersects_guess(x0,yl,yl*yl)) return false;
-	if(c.plane_intersects(x1,yl,yl*yl)) return false;
+inline bool quadtree::edge_y_test(voronoicell_2d &c,double x0,double yl,double x1,double rm) {
+	double rv=1+rm/(yl*yl);
+	if(rv<=0) return false;
+	if(c.plane_intersects_guess(x0,yl,rv*yl*yl)) return false;
+	if(c.plane_intersects(x1,yl,rv*yl*yl)) return false;
 	return true;
 }
 
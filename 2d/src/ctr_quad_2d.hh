@@ -22,6 +22,10 @@ class quadtree {
 		int *id;
 		double *p;
 		int co;
+		/** The maximum radius of any particle that has been placed in
+		 * this node or its children, used to bound the power
+		 * tessellation search. */
+		double max_r;
 		unsigned int mask;
 		quadtree *qsw;
 		quadtree *qse;
@@ -29,9 +33,10 @@ class quadtree {
 		quadtree *qne;
 		quadtree **nei;
 		int nco;
-		quadtree(double cx_,double cy_,double lx_,double ly_,container_quad_2d &parent_);
+		quadtree(double cx_,double cy_,double lx_,double ly_,container_quad_2d &parent_,int ps_=2);
 		~quadtree();
 		void put(int i,double x,double y);
+		void put(int i,double x,double y,double r);
 		void split();
 		void draw_particles(FILE *fp=stdout);
 		void draw_cross(FILE *fp=stdout);
@@ -43,6 +48,13 @@ class quadtree {
 			p[ps*co]=x;
 			p[1+ps*co++]=y;
 		}
+		inline void quick_put(int i,double x,double y,double r) {
+			id[co]=i;
+			p[ps*co]=x;
+			p[1+ps*co]=y;
+			p[2+ps*co++]=r;
+			if(r>max_r) max_r=r;
+		}
 		inline void add_neighbor(quadtree *qt) {
 			if(nco==nmax) add_neighbor_memory();
 			nei[nco++]=qt;
@@ -57,9 +69,10 @@ class quadtree {
 		void reset_mask();
 	protected:
 		int nmax;
-		inline bool corner_test(voronoicell_2d &c,double xl,double yl,double xh,double yh);
-		inline bool edge_x_test(voronoicell_2d &c,double xl,double y0,double y1);
-		inline bool edge_y_test(voronoicell_2d &c,double x0,double yl,double x1);
+		bool block_test(voronoicell_2d &c,double xlo,double xhi,double ylo,double yhi,double rm);
+		inline bool corner_test(voronoicell_2d &c,double xl,double yl,double xh,double yh,double rm);
+		inline bool edge_x_test(voronoicell_2d &c,double xl,double y0,double y1,double rm);
+		inline bool edge_y_test(voronoicell_2d &c,double x0,double yl,double x1,double rm);
 		void we_neighbors(quadtree *qw,quadtree *qe);
 		void ns_neighbors(quadtree *qs,quadtree *qn);
 		void add_neighbor_memory();
@@ -80,6 +93,13 @@ class container_quad_2d : public quadtree {
 		const double by;
 		unsigned int bmask;
 		container_quad_2d(double ax_,double bx_,double ay_,double by_);
+		/** Puts a particle into the container.
+		 * \param[in] i the ID of the particle.
+		 * \param[in] (x,y) the position of the particle. */
+		inline void put(int i,double x,double y) {
+			if(ps==3) voro_fatal_error("Particle radius required by polydisperse container",VOROPP_INTERNAL_ERROR);
+			quadtree::put(i,x,y);
+		}
 		inline void draw_particles(const char* filename) {
 			FILE *fp=safe_fopen_2d(filename,"w");
 			draw_particles(fp);
@@ -104,6 +124,35 @@ class container_quad_2d : public quadtree {
 		inline void initialize_voronoicell(voronoicell_2d &c,double x,double y) {
 			c.init(ax-x,bx-x,ay-y,by-y);
 		}
+	protected:
+		container_quad_2d(double ax_,double bx_,double ay_,double by_,int ps_);
+};
+
+/** \brief An adaptive quadtree container for the radical Voronoi
+ * tessellation.
+ *
+ * This class extends container_quad_2d to store a radius for each particle,
+ * and computes the radical (power) tessellation. Each quadtree node keeps the
+ * maximum radius of the particles within it, so that the block tests can
+ * reject nodes using a local radius bound rather than the global one. */
+class container_quad_poly_2d : public container_quad_2d {
+	public:
+		/** The class constructor sets up the geometry of the container.
+		 * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+		 * \param[in] (ay_,by_) the minimum and maximum y coordinates. */
+		container_quad_poly_2d(double ax_,double bx_,double ay_,double by_) :
+			container_quad_2d(ax_,bx_,ay_,by_,3) {}
+		/** Puts a particle into the container.
+		 * \param[in] i the ID of the particle.
+		 * \param[in] (x,y) the position of the particle.
+		 * \param[in] r the radius of the particle. */
+		inline void put(int i,double x,double y,double r) {
+			quadtree::put(i,x,y,r);
+		}
+		/** Returns the maximum radius of any particle in the
+		 * container.
+		 * \return The maximum radius. */
+		inline double max_radius() {return max_r;}
 };
 
 }
@@ -0,0 +1,267 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file lockstep_2d.cc
+ * \brief Function implementations for the voro_lockstep_2d class. */
+
+#include <algorithm>
+
+#include "lockstep_2d.hh"
+
+namespace voro {
+
+/** The class constructor binds the class to a container. The particles are
+ * read from the container each time that the cells are computed, so the
+ * container can be changed in between.
+ * \param[in] con_ the container to use. */
+voro_lockstep_2d::voro_lockstep_2d(container_2d &con_) : con(con_), fallbacks(0), mx(0), my(0), nb(0) {}
+
+/** Computes all of the Voronoi cells in the container, but does nothing with
+ * the output. It is useful for measuring the pure computation time, for
+ * comparison with the container_2d::compute_all_cells routine. */
+void voro_lockstep_2d::compute_all_cells() {
+	voronoicell_2d c;
+	int b,l;
+	setup();
+	for(b=0;b<nb;b++) {
+		compute_batch(b);
+		for(l=0;l<bn;l++) if(fb[l]) con.compute_cell(c,gij[bs[b]+l],gq[bs[b]+l]);
+	}
+}
+
+/** Calculates all of the Voronoi cells and sums their areas. In most cases
+ * without walls, the sum of the Voronoi cell areas should equal the area of
+ * the container to numerical precision.
+ * \return The sum of all of the computed Voronoi areas. */
+double voro_lockstep_2d::sum_cell_areas() {
+	double area=0;
+	compute_all_cells([&area](int,double,double,int m,const double *v) {
+		double a=0;
+		for(int q=m-1,k=0;k<m;q=k++) a+=v[2*q]*v[2*k+1]-v[2*k]*v[2*q+1];
+		area+=0.5*a;
+	});
+	return area;
+}
+
+/** Sorts the particles of the container into the grid, and divides them into
+ * groups. */
+void voro_lockstep_2d::setup() {
+	int i,j,k,ij,q,e,tp=con.total_particles();
+	double lx=con.bx-con.ax,ly=con.by-con.ay,
+	       ilscale=sqrt(tp/(lockstep_block_particles*lx*ly)),*pp;
+
+	// Set up a grid of blocks that are close to square
+	mx=int(lx*ilscale)+1;my=int(ly*ilscale)+1;
+	bw=lx/mx;bh=ly/my;
+	vector<int> gb(tp);
+	bo.assign(mx*my+1,0);
+	gx.resize(tp);gy.resize(tp);gid.resize(tp);gij.resize(tp);gq.resize(tp);
+
+	// Count the particles in each block, and then place them in block
+	// order
+	for(k=ij=0;ij<con.nxy;ij++) for(q=0;q<con.co[ij];q++,k++) {
+		pp=con.p[ij]+2*q;
+		i=int((*pp-con.ax)/bw);if(i<0) i=0;else if(i>=mx) i=mx-1;
+		j=int((pp[1]-con.ay)/bh);if(j<0) j=0;else if(j>=my) j=my-1;
+		bo[gb[k]=i+mx*j]++;
+	}
+	for(e=0,ij=0;ij<=mx*my;ij++) {q=bo[ij];bo[ij]=e;e+=q;}
+	for(k=ij=0;ij<con.nxy;ij++) for(q=0;q<con.co[ij];q++,k++) {
+		e=bo[gb[k]]++;
+		pp=con.p[ij]+2*q;
+		gx[e]=*pp;gy[e]=pp[1];
+		gid[e]=con.id[ij][q];gij[e]=ij;gq[e]=q;
+	}
+	for(ij=mx*my;ij>0;ij--) bo[ij]=bo[ij-1];
+	bo[0]=0;
+
+	// Divide each row of blocks into groups of consecutive particles
+	bs.clear();bi0.clear();bi1.clear();bj.clear();
+	for(j=0;j<my;j++) {
+		for(i=0,k=bo[mx*j];k<bo[mx*(j+1)];) {
+			bs.push_back(k);bj.push_back(j);
+			while(k>=bo[mx*j+i+1]) i++;
+			bi0.push_back(i);
+			k+=lockstep_width;
+			if(k>bo[mx*(j+1)]) k=bo[mx*(j+1)];
+			while(k>bo[mx*j+i+1]) i++;
+			bi1.push_back(i);
+		}
+	}
+	nb=bs.size();
+	bs.push_back(tp);
+	fallbacks=0;
+}
+
+/** Computes the cells of a group.
+ * \param[in] b the index of the group. */
+void voro_lockstep_2d::compute_batch(int b) {
+	const bool walls=con.wep!=con.walls;
+	const int i0=bi0[b],i1=bi1[b],j0=bj[b];
+	int c,cs,i,j,l,q,r;
+	double x1,x2,y1,y2,dx[lockstep_width],dy[lockstep_width],rs[lockstep_width],
+	       d[lockstep_width],bd,e;
+	bool done;
+	bn=bs[b+1]-bs[b];
+
+	// Set up each cell as a rectangle filling the container, or half of
+	// the domain in either direction for periodic coordinates
+	for(l=0;l<lockstep_width;l++) {
+		if(l>=bn) {reset_lane(l);fb[l]=false;continue;}
+		ux[l]=gx[bs[b]+l];uy[l]=gy[bs[b]+l];
+		if(walls) {reset_lane(l);fb[l]=true;fallbacks++;continue;}
+		if(con.xperiodic) {x1=-(x2=0.5*(con.bx-con.ax));} else {x1=con.ax-ux[l];x2=con.bx-ux[l];}
+		if(con.yperiodic) {y1=-(y2=0.5*(con.by-con.ay));} else {y1=con.ay-uy[l];y2=con.by-uy[l];}
+		px[l]=x1;py[l]=y1;
+		px[lockstep_width+l]=x2;py[lockstep_width+l]=y1;
+		px[2*lockstep_width+l]=x2;py[2*lockstep_width+l]=y2;
+		for(q=3;q<lockstep_max_vertices;q++) {px[q*lockstep_width+l]=x1;py[q*lockstep_width+l]=y2;}
+		n[l]=4;fb[l]=false;
+		r2[l]=max(x1*x1,x2*x2)+max(y1*y1,y2*y2);
+	}
+	if(walls) {nmax=0;return;}
+	nmax=4;
+	for(gcx=gcy=0,l=0;l<bn;l++) {gcx+=ux[l];gcy+=uy[l];}
+	gcx/=bn;gcy/=bn;
+
+	cand.clear();
+	for(r=0;;r++) {
+
+		// Fetch the particles in the next ring of blocks around the
+		// group, and sort them by their distance to its center
+		cs=cand.size();
+		if(r==0) for(i=i0;i<=i1;i++) add_block(i,j0);
+		else {
+			for(i=i0-r;i<=i1+r;i++) {add_block(i,j0-r);add_block(i,j0+r);}
+			for(j=j0-r+1;j<j0+r;j++) {add_block(i0-r,j);add_block(i1+r,j);}
+		}
+		sort(cand.begin()+cs,cand.end());
+
+		// Test each candidate against all of the cells at once. A
+		// candidate can only cut a cell if it is closer than twice the
+		// distance to the furthest vertex. For the cells that pass
+		// this test, find the furthest extent of the cell in the
+		// direction of the candidate, and cut the cell if this is
+		// further than the tolerance beyond the bisecting line.
+		for(c=cs;c<(int) cand.size();c++) {
+			int hit=0;
+			double x=cand[c].x,y=cand[c].y;
+			for(l=0;l<lockstep_width;l++) {
+				dx[l]=x-ux[l];dy[l]=y-uy[l];
+				rs[l]=dx[l]*dx[l]+dy[l]*dy[l];
+				hit|=rs[l]<4*r2[l];
+			}
+			if(!hit) continue;
+			for(l=0;l<lockstep_width;l++) d[l]=-large_number;
+			for(q=0;q<nmax;q++) for(l=0;l<lockstep_width;l++) {
+				e=dx[l]*px[q*lockstep_width+l]+dy[l]*py[q*lockstep_width+l];
+				d[l]=e>d[l]?e:d[l];
+			}
+			for(l=0;l<lockstep_width;l++) if(rs[l]<4*r2[l]) {
+				e=d[l]-0.5*rs[l];
+				if(e>0&&e*e>tolerance_sq*rs[l]) cut(l,dx[l],dy[l],0.5*rs[l]);
+			}
+		}
+
+		// Find the distance from each particle to the nearest block
+		// that has not been searched, and stop if this is more than
+		// twice the distance to the furthest vertex of every cell
+		done=true;
+		for(l=0;l<bn;l++) if(r2[l]>0) {
+			bd=large_number;
+			if(con.xperiodic||i0-r>0) bd=min(bd,ux[l]-con.ax-(i0-r)*bw);
+			if(con.xperiodic||i1+r<mx-1) bd=min(bd,con.ax+(i1+r+1)*bw-ux[l]);
+			if(con.yperiodic||j0-r>0) bd=min(bd,uy[l]-con.ay-(j0-r)*bh);
+			if(con.yperiodic||j0+r<my-1) bd=min(bd,con.ay+(j0+r+1)*bh-uy[l]);
+			if(4*r2[l]>bd*bd) {done=false;break;}
+		}
+		if(done) return;
+	}
+}
+
+/** Adds the particles in a block of the grid to the list of candidates, if
+ * the block is close enough to any cell of the current group for them to cut
+ * it. In periodic coordinates, the block is wrapped into the grid and the
+ * particle positions are shifted to match, while blocks outside the grid in
+ * non-periodic coordinates are skipped.
+ * \param[in] (i,j) the coordinates of the block, which may lie outside the
+ *                  grid. */
+void voro_lockstep_2d::add_block(int i,int j) {
+	double sx=0,sy=0,xl=con.ax+i*bw,xh=xl+bw,yl=con.ay+j*bh,yh=yl+bh,ex,ey;
+	int k,l,need=0;
+	if(i<0||i>=mx) {
+		if(!con.xperiodic) return;
+		k=i>=0?i/mx:-((mx-1-i)/mx);
+		i-=k*mx;sx=k*(con.bx-con.ax);
+	}
+	if(j<0||j>=my) {
+		if(!con.yperiodic) return;
+		k=j>=0?j/my:-((my-1-j)/my);
+		j-=k*my;sy=k*(con.by-con.ay);
+	}
+
+	// Skip the block if it is more than twice the distance to the
+	// furthest vertex away from every particle in the group
+	for(l=0;l<lockstep_width;l++) {
+		ex=xl-ux[l];if(ux[l]-xh>ex) ex=ux[l]-xh;if(ex<0) ex=0;
+		ey=yl-uy[l];if(uy[l]-yh>ey) ey=uy[l]-yh;if(ey<0) ey=0;
+		need|=ex*ex+ey*ey<4*r2[l];
+	}
+	if(!need) return;
+	int ij=i+mx*j;
+	lockstep_candidate_2d ca;
+	for(k=bo[ij];k<bo[ij+1];k++) {
+		ca.x=gx[k]+sx;ca.y=gy[k]+sy;
+		ca.d=(ca.x-gcx)*(ca.x-gcx)+(ca.y-gcy)*(ca.y-gcy);
+		cand.push_back(ca);
+	}
+}
+
+/** Cuts a cell of the current group by a line, keeping the part on the side
+ * of the particle. Vertices within the tolerance of the line are taken to lie
+ * on it, so that no new vertex is created next to them. If the cut cell has
+ * too many vertices, then it is marked to be computed by the container.
+ * \param[in] l the cell to cut.
+ * \param[in] (dx,dy) the position of the other particle, relative to this
+ *                    one.
+ * \param[in] h half of the squared distance between the particles, so that
+ *              the line is given by dx*x+dy*y=h. */
+void voro_lockstep_2d::cut(int l,double dx,double dy,double h) {
+	double qx[2*lockstep_max_vertices],qy[2*lockstep_max_vertices],
+	       *xp=px+l,*yp=py+l,fu,fw,t,ax,ay,rr,tl=tolerance*sqrt(dx*dx+dy*dy);
+	int k,m=0,nn=n[l],u=nn-1;
+	fu=dx*xp[u*lockstep_width]+dy*yp[u*lockstep_width]-h;
+	for(k=0;k<nn;u=k++,fu=fw) {
+		fw=dx*xp[k*lockstep_width]+dy*yp[k*lockstep_width]-h;
+		if((fu>tl&&fw<-tl)||(fu<-tl&&fw>tl)) {
+			t=fu/(fu-fw);
+			ax=xp[u*lockstep_width];ay=yp[u*lockstep_width];
+			qx[m]=ax+t*(xp[k*lockstep_width]-ax);
+			qy[m++]=ay+t*(yp[k*lockstep_width]-ay);
+		}
+		if(fw<=tl) {qx[m]=xp[k*lockstep_width];qy[m++]=yp[k*lockstep_width];}
+	}
+
+	// Store the cut cell, repeating the first vertex in the unused
+	// entries, and update the furthest vertex distance
+	if(m>lockstep_max_vertices) {reset_lane(l);fb[l]=true;fallbacks++;return;}
+	if(m<3) {reset_lane(l);return;}
+	rr=0;
+	for(k=0;k<m;k++) {
+		xp[k*lockstep_width]=qx[k];yp[k*lockstep_width]=qy[k];
+		t=qx[k]*qx[k]+qy[k]*qy[k];
+		if(t>rr) rr=t;
+	}
+	for(;k<lockstep_max_vertices;k++) {xp[k*lockstep_width]=*qx;yp[k*lockstep_width]=*qy;}
+	n[l]=m;r2[l]=rr;
+	if(m>nmax) nmax=m;
+}
+
+/** Removes a cell from the current group, so that no further candidates are
+ * tested against it.
+ * \param[in] l the cell to remove. */
+void voro_lockstep_2d::reset_lane(int l) {
+	for(int q=0;q<lockstep_max_vertices;q++) px[q*lockstep_width+l]=py[q*lockstep_width+l]=0;
+	n[l]=0;r2[l]=-1;
+}
+
+}
@@ -0,0 +1,174 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file lockstep_2d.hh
+ * \brief Header file for the voro_lockstep_2d class. */
+
+#ifndef VOROPP_LOCKSTEP_2D_HH
+#define VOROPP_LOCKSTEP_2D_HH
+
+#include <vector>
+using namespace std;
+
+#include "config_2d.hh"
+#include "cell_2d.hh"
+#include "container_2d.hh"
+
+namespace voro {
+
+/** \brief Structure for holding a candidate particle in the voro_lockstep_2d
+ * class. */
+struct lockstep_candidate_2d {
+	/** The squared distance to the center of the group. */
+	double d;
+	/** The x position of the particle. */
+	double x;
+	/** The y position of the particle. */
+	double y;
+	/** Orders the candidates by their distance to the center of the
+	 * group. */
+	inline bool operator<(const lockstep_candidate_2d &c) const {return d<c.d;}
+};
+
+/** \brief A class for computing the Voronoi cells of a container_2d in
+ * groups that advance in lockstep.
+ *
+ * Two-dimensional Voronoi cells are small and similar in complexity, so the
+ * scalar routine in the voro_compute_2d class spends most of its time on
+ * bookkeeping rather than arithmetic. This class computes lockstep_width
+ * neighboring cells at a time. Each cell is stored as a polygon with at most
+ * lockstep_max_vertices vertices, with the coordinates of the group laid out
+ * so that the same vertex of every cell is contiguous in memory. Each
+ * candidate particle is fetched once for the whole group, and is tested
+ * against all of the cells in short fixed-length loops that the compiler can
+ * vectorize. Only the cells that it actually cuts are then clipped one at a
+ * time.
+ *
+ * The particles are sorted into a finer grid than the container's, holding
+ * about lockstep_block_particles particles per block, and each group is made
+ * of consecutive particles along a row of this grid. The candidates are taken
+ * from rings of blocks of increasing size around the group, skipping blocks
+ * that are too far away to cut any of the cells, until every cell lies within
+ * half the distance to the nearest block that has not been searched. The
+ * candidates in each ring are tested in order of their distance to the center
+ * of the group, so that the cells shrink quickly. A cell that would have too
+ * many vertices is computed separately by the container, as are all of the
+ * cells if the container has walls. */
+class voro_lockstep_2d {
+	public:
+		/** A reference to the container whose cells are computed. */
+		container_2d &con;
+		/** The number of cells in the last computation that were
+		 * computed by the container instead. */
+		int fallbacks;
+		voro_lockstep_2d(container_2d &con_);
+		void compute_all_cells();
+		double sum_cell_areas();
+		/** Computes all of the Voronoi cells in the container, and
+		 * calls a function object for each one. The cells are visited
+		 * in the order of the internal grid, rather than the order of
+		 * the container.
+		 * \param[in] f the function object, which is called with the
+		 *              particle ID, the particle position, the number
+		 *              of vertices, and an array holding the vertex
+		 *              positions relative to the particle, in
+		 *              counter-clockwise order. */
+		template<class f_class>
+		void compute_all_cells(f_class f) {
+			voronoicell_2d c;
+			double v[2*lockstep_max_vertices];
+			int b,k,l,q;
+			setup();
+			for(b=0;b<nb;b++) {
+				compute_batch(b);
+				for(l=0;l<bn;l++) {
+					k=bs[b]+l;
+					if(fb[l]) {
+						if(con.compute_cell(c,gij[k],gq[k])) {
+							c.ordered_vertices(0,0,fv);
+							f(gid[k],gx[k],gy[k],c.p,&fv[0]);
+						}
+					} else if(n[l]>0) {
+						for(q=0;q<n[l];q++) {
+							v[2*q]=px[q*lockstep_width+l];
+							v[2*q+1]=py[q*lockstep_width+l];
+						}
+						f(gid[k],gx[k],gy[k],n[l],v);
+					}
+				}
+			}
+		}
+	private:
+		/** The number of blocks of the grid in the x direction. */
+		int mx;
+		/** The number of blocks of the grid in the y direction. */
+		int my;
+		/** The width of a block of the grid. */
+		double bw;
+		/** The height of a block of the grid. */
+		double bh;
+		/** The index of the first particle in each block of the grid,
+		 * with an extra entry holding the total number of particles.
+		 */
+		vector<int> bo;
+		/** The x positions of the particles, sorted by block. */
+		vector<double> gx;
+		/** The y positions of the particles, sorted by block. */
+		vector<double> gy;
+		/** The IDs of the particles. */
+		vector<int> gid;
+		/** The blocks of the particles in the container. */
+		vector<int> gij;
+		/** The indices of the particles within their blocks in the
+		 * container. */
+		vector<int> gq;
+		/** The total number of groups. */
+		int nb;
+		/** The index of the first particle in each group, with an
+		 * extra entry holding the total number of particles. */
+		vector<int> bs;
+		/** The first column of grid blocks spanned by each group. */
+		vector<int> bi0;
+		/** The last column of grid blocks spanned by each group. */
+		vector<int> bi1;
+		/** The row of grid blocks holding each group. */
+		vector<int> bj;
+		/** The candidate particles for the current group. */
+		vector<lockstep_candidate_2d> cand;
+		/** A buffer for the vertices of a cell computed by the
+		 * container. */
+		vector<double> fv;
+		/** The number of cells in the current group. */
+		int bn;
+		/** The largest number of vertices of a cell in the current
+		 * group. */
+		int nmax;
+		/** The center of the current group. */
+		double gcx,gcy;
+		/** The positions of the particles in the current group. */
+		double ux[lockstep_width],uy[lockstep_width];
+		/** The squared distances to the furthest vertices of the cells
+		 * in the current group, or -1 for a cell that is no longer
+		 * being computed. */
+		double r2[lockstep_width];
+		/** The x coordinates of the vertices of the cells, relative to
+		 * their particles. Entry q*lockstep_width+l holds vertex q of
+		 * cell l. Unused entries hold copies of one of the vertices, so
+		 * that they can be included in the tests. */
+		double px[lockstep_max_vertices*lockstep_width];
+		/** The y coordinates of the vertices of the cells. */
+		double py[lockstep_max_vertices*lockstep_width];
+		/** The numbers of vertices of the cells. */
+		int n[lockstep_width];
+		/** Flags for the cells that must be computed by the
+		 * container. */
+		bool fb[lockstep_width];
+		void setup();
+		void compute_batch(int b);
+		void add_block(int i,int j);
+		void cut(int l,double dx,double dy,double h);
+		void reset_lane(int l);
+};
+
+}
+
+#endif
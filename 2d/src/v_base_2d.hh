@@ -62,6 +62,11 @@ class voro_base_2d {
 		bool contains_neighbor(const char* format);
 //		bool contains_neighbor_global(const char* format);
 		voro_base_2d(int nx_,int ny_,double boxx_,double boxy_);
+		/** The move constructor copies the grid geometry and takes
+		 * over the worklist radius array of another class.
+		 * \param[in] vb the class to move from. */
+		voro_base_2d(voro_base_2d &&vb) noexcept : nx(vb.nx), ny(vb.ny), nxy(vb.nxy),
+			boxx(vb.boxx), boxy(vb.boxy), xsp(vb.xsp), ysp(vb.ysp), mrad(vb.mrad) {vb.mrad=0;}
 		~voro_base_2d() {delete [] mrad;}
 	protected:
 		/** A custom int function that returns consistent stepping
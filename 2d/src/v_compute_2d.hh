@@ -79,6 +79,23 @@ class voro_compute_2d {
 		 * computational box of the container. */
 		int *co;
 		voro_compute_2d(c_class_2d &con_,int hx_,int hy_);
+		/** The move constructor takes over the mask and queue of
+		 * another class, and binds to a given container. This is used
+		 * when a container is moved, since the computation class must
+		 * then refer to the new container.
+		 * \param[in] con_ the container to bind to.
+		 * \param[in] vc the class to move from. */
+		voro_compute_2d(c_class_2d &con_,voro_compute_2d &&vc) noexcept :
+			con(con_), boxx(vc.boxx), boxy(vc.boxy), xsp(vc.xsp), ysp(vc.ysp),
+			hx(vc.hx), hy(vc.hy), hxy(vc.hxy), ps(vc.ps), id(con_.id), p(con_.p),
+			co(con_.co), bxsq(vc.bxsq), mv(vc.mv), qu_size(vc.qu_size), wl(vc.wl),
+			mrad(con_.mrad), mask(vc.mask), qu(vc.qu), qu_l(vc.qu_l) {
+			vc.mask=0;vc.qu=vc.qu_l=0;
+		}
+		/** The move constructor takes over the mask and queue of
+		 * another class, remaining bound to the same container.
+		 * \param[in] vc the class to move from. */
+		voro_compute_2d(voro_compute_2d &&vc) noexcept : voro_compute_2d(vc.con,std::move(vc)) {}
 		/** The class destructor frees the dynamically allocated memory
 		 * for the mask and queue. */
 		~voro_compute_2d() {
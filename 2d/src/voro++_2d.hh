@@ -13,5 +13,6 @@
 #include "cell_nc_2d.hh"
 #include "ctr_boundary_2d.hh"
 #include "ctr_quad_2d.hh"
+#include "lockstep_2d.hh"
 
 #endif
@@ -10,8 +10,9 @@
 # C++ compiler
 CXX?=g++
 
-# Flags for the C++ compiler
-CFLAGS+=-Wall -ansi -pedantic -O3
+# Flags for the C++ compiler. The OpenMP flag enables the parallel routines,
+# and can be removed to build the library without thread support.
+CFLAGS+=-Wall -std=c++11 -pedantic -O3 -fopenmp
 
 # Relative include and library paths for compilation of the examples
 E_INC=-I../../src
@@ -0,0 +1,135 @@
+// In-situ analysis example code
+
+#include <cstring>
+#include <sys/types.h>
+
+#include "voro++.hh"
+using namespace voro;
+
+#ifdef VOROPP_SHM_SEGMENT
+#include <sys/wait.h>
+#include <csignal>
+
+// Set up constants for the periodic domain
+const double x_min=0,x_max=10;
+const double y_min=0,y_max=10;
+const double z_min=0,z_max=10;
+
+// Set the number of particles, the number of steps, and how often the
+// particles are analyzed
+const int particles=20000;
+const int steps=20;
+const int analysis_interval=5;
+
+// Set the maximum time in seconds that the producer waits for a reply
+const double reply_timeout=60;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// Wraps a coordinate back into a periodic interval
+double wrap(double x,double a,double b) {
+	double l=b-a;
+	return x-l*floor((x-a)/l);
+}
+
+// Runs the service, which attaches to the segment and carries out requests
+// until the producer sends the quit command
+int service(const char *name) {
+	shm_segment seg(name);
+	shm_service sv(seg);
+	sv.run();
+	printf("Service: %ld requests served, container built %d time(s)\n",sv.served,sv.built);
+	return 0;
+}
+
+// Runs a stand-in for a simulation code, which moves the particles with a
+// random walk and asks the service to analyze them every few steps. This only
+// uses the shm_segment class, so a real simulation code would just include
+// shm_segment.hh and would not need to link to the library. If a request
+// fails, the service is still told to stop, and 2 is returned if it does not
+// respond.
+int producer(shm_segment &seg) {
+	shm_header *h=seg.h;
+	int i,j,st;
+	double *pp;
+
+	// Set up the request and the initial particle positions
+	h->n=particles;
+	h->bounds[0]=x_min;h->bounds[1]=x_max;
+	h->bounds[2]=y_min;h->bounds[3]=y_max;
+	h->bounds[4]=z_min;h->bounds[5]=z_max;
+	h->periodic[0]=h->periodic[1]=h->periodic[2]=1;
+	h->fields=shm_volume|shm_faces|shm_centroid;
+	for(i=0;i<particles;i++) {
+		seg.id[i]=i;pp=seg.pos+3*i;
+		*pp=x_min+rnd()*(x_max-x_min);
+		pp[1]=y_min+rnd()*(y_max-y_min);
+		pp[2]=z_min+rnd()*(z_max-z_min);
+	}
+
+	for(j=1;j<=steps;j++) {
+
+		// Move the particles
+		for(i=0;i<particles;i++) {
+			pp=seg.pos+3*i;
+			*pp=wrap(*pp+0.05*(rnd()-0.5),x_min,x_max);
+			pp[1]=wrap(pp[1]+0.05*(rnd()-0.5),y_min,y_max);
+			pp[2]=wrap(pp[2]+0.05*(rnd()-0.5),z_min,z_max);
+		}
+		if(j%analysis_interval!=0) continue;
+
+		// Ask the service to analyze the particles, and summarize the
+		// results, which have five columns per particle
+		h->step=j;
+		if((st=seg.request(shm_compute,reply_timeout))!=shm_ok) {
+			fprintf(stderr,"Request failed with status %d\n",st);
+			return seg.request(shm_quit,reply_timeout)==shm_ok?1:2;
+		}
+		double faces=0,shift=0,*op=seg.out;
+		for(i=0;i<particles;i++,op+=h->columns) {
+			pp=seg.pos+3*i;
+			faces+=op[1];
+			shift+=sqrt((op[2]-*pp)*(op[2]-*pp)+(op[3]-pp[1])*(op[3]-pp[1])+(op[4]-pp[2])*(op[4]-pp[2]));
+		}
+		printf("Step %ld: %d cells, total volume %g, mean faces %g, mean centroid offset %g\n",
+		       h->reply_step,h->computed,h->volume,faces/particles,shift/particles);
+	}
+
+	// Tell the service to stop
+	seg.request(shm_quit,reply_timeout);
+	return 0;
+}
+
+int main(int argc,char **argv) {
+	const char *name=argc>2?argv[2]:"/voro_insitu";
+
+	// With the "service" argument, attach to an existing segment and serve
+	// requests. With the "producer" argument, create the segment and send
+	// requests to a service that is started separately.
+	if(argc>1&&strcmp(argv[1],"service")==0) return service(name);
+	shm_segment seg(name,particles);
+	if(argc>1&&strcmp(argv[1],"producer")==0) return producer(seg);
+
+	// Otherwise, run the service in a child process
+	pid_t pid=fork();
+	if(pid<0) voro_fatal_error("Unable to start the service",VOROPP_INTERNAL_ERROR);
+	if(pid==0) {
+		int r=service(name);
+		fflush(stdout);
+		_exit(r);
+	}
+	int r=producer(seg),ws;
+	if(r==2) kill(pid,SIGTERM);
+	waitpid(pid,&ws,0);
+	return r;
+}
+
+#else
+
+int main() {
+	fputs("Shared memory analysis is not available on this platform\n",stderr);
+	return 1;
+}
+
+#endif
@@ -0,0 +1,53 @@
+// Cell profiling example code
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=-1,x_max=1;
+const double y_min=-1,y_max=1;
+const double z_min=-1,z_max=1;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=6,n_y=6,n_z=6;
+
+// Set the number of particles that are going to be randomly introduced
+const int particles=20;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i,id;
+	double x,y,z,r;
+
+	// Create a container and add a mix of densely and sparsely packed
+	// particles, so that the cell costs vary widely
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	for(i=0;i<particles*1000;i++) {
+		x=x_min+rnd()*(x_max-x_min);
+		y=y_min+rnd()*(y_max-y_min);
+		z=z_min+rnd()*(z_max-z_min);
+		if(x<0||rnd()<0.02) con.put(i,x,y,z);
+	}
+
+	// Compute all of the cells while recording their costs, print the
+	// histograms, and save the five slowest cells to a replay file
+	cell_profiler cp(5);
+	con.compute_all_cells(cp);
+	cp.print_histograms();
+	cp.dump_slowest(con,"profile_slow.txt");
+
+	// Reconstruct the slowest cells from the replay file using a
+	// standalone Voronoi cell, and save them in gnuplot format
+	voronoicell c;
+	FILE *fp=safe_fopen("profile_slow.txt","r"),
+	     *fp2=safe_fopen("profile_slow.gnu","w");
+	while(cell_profiler::replay(fp,c,id,x,y,z,r)) {
+		printf("Replayed cell %d with volume %g\n",id,c.volume());
+		c.draw_gnuplot(x,y,z,fp2);
+	}
+	fclose(fp2);
+	fclose(fp);
+}
@@ -0,0 +1,51 @@
+// Region of interest example code
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set up constants for the domain and the region of interest
+const double x_min=0,x_max=10;
+const double y_min=0,y_max=10;
+const double z_min=0,z_max=10;
+const double rx_min=4,rx_max=5;
+const double ry_min=4,ry_max=5;
+const double rz_min=0,rz_max=1;
+
+// Set the number of particles in the snapshot
+const int particles=200000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i;
+	double x,y,z;
+
+	// Write a snapshot of random particles to a binary file, with each
+	// record holding an integer ID and three coordinates
+	FILE *fp=safe_fopen("roi_pack.bin","wb");
+	for(i=0;i<particles;i++) {
+		x=x_min+rnd()*(x_max-x_min);
+		y=y_min+rnd()*(y_max-y_min);
+		z=z_min+rnd()*(z_max-z_min);
+		fwrite(&i,sizeof(int),1,fp);
+		fwrite(&x,sizeof(double),1,fp);
+		fwrite(&y,sizeof(double),1,fp);
+		fwrite(&z,sizeof(double),1,fp);
+	}
+	fclose(fp);
+
+	// Import the region of interest and an adaptively grown halo from
+	// the snapshot, and sum the volumes of the cells in the region
+	container_roi rcon(x_min,x_max,y_min,y_max,z_min,z_max,
+			   rx_min,rx_max,ry_min,ry_max,rz_min,rz_max);
+	rcon.import_binary("roi_pack.bin");
+	printf("Passes           : %d\n"
+	       "Halo width       : %g\n"
+	       "Loaded particles : %d of %d\n",rcon.passes,rcon.halo,
+	       rcon.loaded_particles(),rcon.total);
+	printf("ROI cell volume  : %g\n",rcon.sum_cell_volumes());
+
+	// Save information about the cells in the region of interest
+	rcon.print_custom("%i %q %v %s","roi.vol");
+}
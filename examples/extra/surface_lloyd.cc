@@ -0,0 +1,99 @@
+// Restricted Voronoi diagram example code
+
+#include <map>
+#include <vector>
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set the number of subdivisions of the sphere mesh, the number of sample
+// points, and the number of Lloyd iterations
+const int subdivisions=5;
+const int particles=1000;
+const int iterations=20;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// Projects a point onto the unit sphere
+void project(double &x,double &y,double &z) {
+	double r=1/sqrt(x*x+y*y+z*z);
+	x*=r;y*=r;z*=r;
+}
+
+// Returns the index of the midpoint of an edge of the mesh, creating a new
+// vertex on the sphere if this edge has not been split before
+int midpoint(int a,int b,std::vector<double> &v,std::map<std::pair<int,int>,int> &mid) {
+	std::pair<int,int> e(a<b?a:b,a<b?b:a);
+	std::map<std::pair<int,int>,int>::iterator it=mid.find(e);
+	if(it!=mid.end()) return it->second;
+	double x=v[3*a]+v[3*b],y=v[3*a+1]+v[3*b+1],z=v[3*a+2]+v[3*b+2];
+	project(x,y,z);
+	v.push_back(x);v.push_back(y);v.push_back(z);
+	return mid[e]=v.size()/3-1;
+}
+
+// Makes a triangle mesh of the unit sphere, by splitting each triangle of an
+// octahedron into four a number of times
+void sphere_mesh(int lev,std::vector<double> &v,std::vector<int> &tri) {
+	const double ov[18]={1,0,0,-1,0,0,0,1,0,0,-1,0,0,0,1,0,0,-1};
+	const int ot[24]={0,2,4,2,1,4,1,3,4,3,0,4,2,0,5,1,2,5,3,1,5,0,3,5};
+	v.assign(ov,ov+18);tri.assign(ot,ot+24);
+	for(int l=0;l<lev;l++) {
+		std::vector<int> nt;
+		std::map<std::pair<int,int>,int> mid;
+		for(unsigned int i=0;i<tri.size();i+=3) {
+			int a=tri[i],b=tri[i+1],c=tri[i+2],
+			    ab=midpoint(a,b,v,mid),bc=midpoint(b,c,v,mid),ca=midpoint(c,a,v,mid),
+			    q[12]={a,ab,ca,ab,b,bc,ca,bc,c,ab,bc,ca};
+			nt.insert(nt.end(),q,q+12);
+		}
+		tri.swap(nt);
+	}
+}
+
+int main() {
+	std::vector<double> v,p(3*particles);
+	std::vector<int> tri;
+	restricted_voronoi rv;
+	int i,j,l;
+	double x,y,z,r;
+
+	// Make the mesh, and choose random points on the sphere
+	sphere_mesh(subdivisions,v,tri);
+	for(i=0;i<particles;i++) {
+		do {
+			x=2*rnd()-1;y=2*rnd()-1;z=2*rnd()-1;
+			r=x*x+y*y+z*z;
+		} while(r>1||r<1e-6);
+		project(x,y,z);
+		p[3*i]=x;p[3*i+1]=y;p[3*i+2]=z;
+	}
+
+	for(j=0;j<=iterations;j++) {
+
+		// Put the points into a container, and compute the restricted
+		// Voronoi diagram on the mesh
+		container con(-1.1,1.1,-1.1,1.1,-1.1,1.1,10,10,10,false,false,false,8);
+		for(i=0;i<particles;i++) con.put(i,p[3*i],p[3*i+1],p[3*i+2]);
+		rv.compute(con,v.size()/3,&v[0],tri.size()/3,&tri[0]);
+		if(j==0) rv.draw_gnuplot("surface_lloyd_i.gnu");
+
+		// Move each point to the centroid of its restricted cell,
+		// projected back onto the sphere, and measure the spread of
+		// the cell areas
+		double ma=0,sa=0,sb=0;
+		for(l=0;l<rv.nc;l++) {
+			i=rv.id[l];
+			x=rv.cen[3*l];y=rv.cen[3*l+1];z=rv.cen[3*l+2];
+			project(x,y,z);
+			p[3*i]=x;p[3*i+1]=y;p[3*i+2]=z;
+			sa+=rv.area[l];sb+=rv.area[l]*rv.area[l];
+			if(rv.area[l]>ma) ma=rv.area[l];
+		}
+		sa/=rv.nc;
+		printf("Iteration %d: %d polygons, total area %g, mean cell area %g, "
+		       "deviation %g, maximum %g\n",j,rv.np,rv.total_area(),sa,sqrt(sb/rv.nc-sa*sa),ma);
+	}
+	rv.draw_gnuplot("surface_lloyd_f.gnu");
+}
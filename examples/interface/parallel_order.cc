@@ -0,0 +1,51 @@
+// Parallel ordered subset example code
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=0,x_max=1;
+const double y_min=0,y_max=1;
+const double z_min=0,z_max=1;
+
+// Set up the number of blocks that the container is divided into
+const int n_x=30,n_y=30,n_z=30;
+
+// Set the number of particles that are going to be randomly introduced
+const int particles=100000;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+int main() {
+	int i,j;
+	double x,y,z;
+
+	// Create a container, and tag the particles in a thin slab as they are
+	// inserted, remembering them in a particle_order class
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n_x,n_y,n_z,
+			false,false,false,8);
+	particle_order po;
+	for(i=0;i<particles;i++) {
+		x=x_min+rnd()*(x_max-x_min);
+		y=y_min+rnd()*(y_max-y_min);
+		z=z_min+rnd()*(z_max-z_min);
+		if(z>0.45&&z<0.55) con.put(po,i,x,y,z);
+		else con.put(i,x,y,z);
+	}
+
+	// Compute the cells of the tagged particles in parallel. The output
+	// appears in the order that the particles were inserted.
+	printf("Threads         : %d\n"
+	       "Tagged particles: %d\n",voro_max_threads(),po.total());
+	print_custom_order_parallel(con,po,"%i %q %v %s","parallel_order.vol");
+
+	// Build a second ordering after the fact from a list of IDs, and sum
+	// the volumes of their cells
+	std::vector<int> ids;
+	for(j=0;j<particles;j+=10) ids.push_back(j);
+	particle_order po2;
+	c_loop_all vl(con);
+	printf("Listed IDs found: %d\n",po2.add_ids(vl,&ids[0],ids.size()));
+	printf("Listed volume   : %g\n",sum_cell_volumes_order_parallel(con,po2));
+}
@@ -43,15 +43,10 @@ int main() {
 	printf("Read %d particles, max ID is %d\n"
 	       "Container grid is %d by %d by %d\n",n,max_id,nx,ny,nz);
 
-	// Import the particles, and create ID lookup tables
-	double *xi=new double[max_id+1],*yi=new double[max_id+1],*zi=new double[max_id+1];
-	for(j=0;j<n;j++) {
-		id=vid[j];x=vx[j];y=vy[j];z=vz[j];
-		con.put(id,x,y,z);
-		xi[id]=x;
-		yi[id]=y;
-		zi[id]=z;
-	}
+	// Import the particles, using the container's ID index so that the
+	// neighbor positions can be looked up
+	con.enable_id_index();
+	for(j=0;j<n;j++) con.put(vid[j],vx[j],vy[j],vz[j]);
 
 	// Open three output files for statistics and gnuplot cells
 	fp=safe_fopen("liq-900K.out","w");
@@ -59,6 +54,7 @@ int main() {
 	fp3=safe_fopen("liq-900K-orig.gnu","w");
 
 	// Loop over all particles and compute their Voronoi cells
+	double qx,qy,qz;
 	voronoicell_neighbor c,c2;
 	c_loop_all cl(con);
 	if(cl.start()) do if(con.compute_cell(c,cl)) {
@@ -81,7 +77,8 @@ int main() {
 		for(i=0;i<(signed int) vd.size();i++)
 			if(vd[i]>0.01*c.surface_area()&&neigh[i]>=0) {
 			j=neigh[i];
-			c2.nplane(xi[j]-x,yi[j]-y,zi[j]-z,j);
+			con.particle_position(j,qx,qy,qz);
+			c2.nplane(qx-x,qy-y,qz-z,j);
 		}
 
 		// Get information of c2 cell
@@ -100,9 +97,4 @@ int main() {
 	// Close files
 	fclose(fp);
 	fclose(fp2);
-	
-	// Delete dynamically allocated arrays
-	delete [] xi;
-	delete [] yi;
-	delete [] zi;
 }
@@ -0,0 +1,103 @@
+// Parallel timing test example code
+
+#include <chrono>
+#include <vector>
+using namespace std;
+
+#include "voro++.hh"
+using namespace voro;
+
+// Set up constants for the container geometry
+const double x_min=-1,x_max=1;
+const double y_min=-1,y_max=1;
+const double z_min=-1,z_max=1;
+
+// The number of passes made over the particle memory when measuring the
+// bandwidth
+const int passes=20;
+
+// This function returns a random double between 0 and 1
+double rnd() {return double(rand())/RAND_MAX;}
+
+// This function returns the time in seconds since the given time point
+double since(chrono::steady_clock::time_point st) {
+	return chrono::duration<double>(chrono::steady_clock::now()-st).count();
+}
+
+// Reads through the particle memory of the container, with the blocks divided
+// between the threads in the same way as in the compute_all_parallel routine,
+// and prints the read bandwidth achieved on each memory node
+void bandwidth(container &con,int nt) {
+	vector<double> bytes(nt,0),secs(nt,0);
+	vector<int> node(nt,0);
+	double sum=0;
+#pragma omp parallel num_threads(nt) reduction(+:sum)
+	{
+		int t=voro_thread_num();
+		long b=0;
+		chrono::steady_clock::time_point st=chrono::steady_clock::now();
+		for(int k=0;k<passes;k++) {
+#pragma omp for schedule(static) nowait
+			for(int ijk=0;ijk<con.nxyz;ijk++) {
+				double *pp=con.p[ijk],*pe=pp+3*con.co[ijk];
+				for(;pp<pe;pp++) sum+=*pp;
+				b+=3*sizeof(double)*con.co[ijk];
+			}
+		}
+		secs[t]=since(st);bytes[t]=b;
+		node[t]=voro_cpu_node(voro_current_cpu());
+	}
+
+	// Group the threads by node, taking the slowest thread on each node
+	// as the time for that node
+	int nn=0;
+	for(int t=0;t<nt;t++) if(node[t]>=nn) nn=node[t]+1;
+	for(int n=0;n<nn;n++) {
+		double b=0,s=0;int c=0;
+		for(int t=0;t<nt;t++) if(node[t]==n) {
+			b+=bytes[t];c++;
+			if(secs[t]>s) s=secs[t];
+		}
+		if(c>0) printf("  Node %d: %d threads, %.3g GB/s\n",n,c,s>0?b/s*1e-9:0);
+	}
+	if(sum==0) puts("  (empty container)");
+}
+
+// Computes all the cells in parallel, and prints the time and total volume
+void tessellate(container &con,int nt) {
+	chrono::steady_clock::time_point st=chrono::steady_clock::now();
+	double vvol=sum_cell_volumes_parallel(con,nt);
+	printf("  Tessellation: %g s, volume %g\n",since(st),vvol);
+}
+
+int main(int argc,char **argv) {
+	int i,nt=argc>1?atoi(argv[1]):voro_max_threads(),
+	    particles=argc>2?atoi(argv[2]):400000;
+	double x,y,z;
+
+	// Pin the threads across all of the allowed CPUs, so that the threads
+	// that place the particle memory are the ones that later read it
+	printf("Pinned %d of %d threads\n",voro_pin_threads(nt),nt);
+
+	// Create a periodic container with about five particles per block,
+	// and add particles from the main thread, so that all of the particle
+	// memory is placed on its memory node
+	int n=int(pow(particles/5.0,1/3.0))+1;
+	container con(x_min,x_max,y_min,y_max,z_min,z_max,n,n,n,true,true,true,8);
+	for(i=0;i<particles;i++) {
+		x=x_min+rnd()*(x_max-x_min);
+		y=y_min+rnd()*(y_max-y_min);
+		z=z_min+rnd()*(z_max-z_min);
+		con.put(i,x,y,z);
+	}
+	puts("Particle memory placed by the loading thread:");
+	bandwidth(con,nt);
+	tessellate(con,nt);
+
+	// Redistribute the particle memory so that each block is placed on the
+	// node of the thread that computes it, and repeat the measurements
+	con.first_touch(nt);
+	puts("Particle memory placed by first touch:");
+	bandwidth(con,nt);
+	tessellate(con,nt);
+}
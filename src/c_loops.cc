@@ -62,10 +62,10 @@ void c_loop_subset::setup_common() {
 		if(ak<0) {ak=0;if(bk<0) bk=0;}
 		if(bk>=nz) {bk=nz-1;if(ak>=nz) ak=nz-1;}
 	}
-	ci=ai;cj=aj;ck=ak;
-	di=i=step_mod(ci,nx);apx=px=step_div(ci,nx)*sx;
-	dj=j=step_mod(cj,ny);apy=py=step_div(cj,ny)*sy;
-	dk=k=step_mod(ck,nz);apz=pz=step_div(ck,nz)*sz;
+	i=ai;j=aj;k=ak;
+	di=ci=step_mod(i,nx);apx=px=step_div(i,nx)*sx;
+	dj=cj=step_mod(j,ny);apy=py=step_div(j,ny)*sy;
+	dk=ck=step_mod(k,nz);apz=pz=step_div(k,nz)*sz;
 	inc1=di-step_mod(bi,nx);
 	inc2=nx*(ny+dj-step_mod(bj,ny))+inc1;
 	inc1+=nx;
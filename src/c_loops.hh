@@ -10,6 +10,10 @@
 #ifndef VOROPP_C_LOOPS_HH
 #define VOROPP_C_LOOPS_HH
 
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
 #include "config.hh"
 
 namespace voro {
@@ -64,6 +68,60 @@ class particle_order {
 			if(op==o+size) add_ordering_memory();
 			*(op++)=ijk;*(op++)=q;
 		}
+		/** Returns the number of records in the order.
+		 * \return The number of records. */
+		inline int total() {return int(op-o)>>1;}
+		/** Removes all of the records from the order. */
+		inline void clear() {op=o;}
+		/** Adds records to the order for a list of particle IDs, after
+		 * the particles have been placed into a container. A loop
+		 * class is used to scan the container once to locate the
+		 * particles, so that the records appear in the same order as
+		 * the list. If the IDs in the container are non-negative and
+		 * compact then a direct lookup table is used, and otherwise a
+		 * hash table is used. IDs that are not found are skipped, and
+		 * if an ID occurs several times in the container then the
+		 * first occurrence is used.
+		 * \param[in] vl a loop class that covers the particles to
+		 *               search, such as c_loop_all.
+		 * \param[in] ids the list of IDs.
+		 * \param[in] n the number of IDs in the list.
+		 * \return The number of IDs that were found. */
+		template<class c_loop>
+		int add_ids(c_loop &vl,const int *ids,int n) {
+			int i,l,m=0,lo=0,hi=-1,tot=0;
+			if(vl.start()) {
+				lo=hi=vl.pid();
+				do {
+					l=vl.pid();tot++;
+					if(l<lo) lo=l;
+					if(l>hi) hi=l;
+				} while(vl.inc());
+			}
+			if(tot==0) return 0;
+			if(lo>=0&&hi<(tot<<2)+order_id_slack) {
+				std::vector<int> loc(2*(hi+1),-1);
+				vl.start();
+				do {
+					l=vl.pid()<<1;
+					if(loc[l]==-1) {loc[l]=vl.ijk;loc[l+1]=vl.q;}
+				} while(vl.inc());
+				for(i=0;i<n;i++) if(ids[i]>=0&&ids[i]<=hi&&loc[ids[i]<<1]!=-1) {
+					add(loc[ids[i]<<1],loc[(ids[i]<<1)+1]);m++;
+				}
+			} else {
+				std::unordered_map<int,std::pair<int,int> > loc;
+				loc.reserve(tot);
+				vl.start();
+				do loc.insert(std::make_pair(vl.pid(),std::make_pair(vl.ijk,vl.q)));
+				while(vl.inc());
+				for(i=0;i<n;i++) {
+					std::unordered_map<int,std::pair<int,int> >::iterator it=loc.find(ids[i]);
+					if(it!=loc.end()) {add(it->second.first,it->second.second);m++;}
+				}
+			}
+			return m;
+		}
 	private:
 		void add_ordering_memory();
 };
@@ -242,6 +300,15 @@ class c_loop_subset : public c_loop_base {
 			} while(mode!=no_check&&out_of_bounds());
 			return true;
 		}
+		/** Returns the position vector of the periodic image of the
+		 * particle currently being considered by the loop. In
+		 * periodic directions, this may differ from the stored
+		 * position by a multiple of the container length.
+		 * \param[out] (x,y,z) the position vector of the image. */
+		inline void image_pos(double &x,double &y,double &z) {
+			double *pp=p[ijk]+ps*q;
+			x=*pp+px;y=pp[1]+py;z=pp[2]+pz;
+		}
 	private:
 		const double ax,ay,az,sx,sy,sz,xsp,ysp,zsp;
 		const bool xperiodic,yperiodic,zperiodic;
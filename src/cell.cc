@@ -9,6 +9,8 @@
 
 #include <cmath>
 #include <cstring>
+#include <utility>
+#include <algorithm>
 
 #include "config.hh"
 #include "common.hh"
@@ -18,19 +20,28 @@ namespace voro {
 
 /** Constructs a Voronoi cell and sets up the initial memory. */
 voronoicell_base::voronoicell_base(double max_len_sq) :
-	current_vertices(init_vertices), current_vertex_order(init_vertex_order),
-	current_delete_size(init_delete_size), current_delete2_size(init_delete2_size),
-	current_xsearch_size(init_xsearch_size),
-	ed(new int*[current_vertices]), nu(new int[current_vertices]),
-	mask(new unsigned int[current_vertices]),
-	pts(new double[current_vertices<<2]), tol(tolerance*max_len_sq),
-	tol_cu(tol*sqrt(tol)), big_tol(big_tolerance_fac*tol), mem(new int[current_vertex_order]),
-	mec(new int[current_vertex_order]),
-	mep(new int*[current_vertex_order]), ds(new int[current_delete_size]),
-	stacke(ds+current_delete_size), ds2(new int[current_delete2_size]),
-	stacke2(ds2+current_delete2_size), xse(new int[current_xsearch_size]),
-	stacke3(xse+current_xsearch_size), maskc(0) {
+	tol(tolerance*max_len_sq), tol_cu(tol*sqrt(tol)), big_tol(big_tolerance_fac*tol),
+	plane_count(0), peak_vertices(0), radius_queries(0), max_rsq(-1), max_rv(0) {
+	allocate_memory();
+}
+
+/** Allocates the vertex, edge, and stack memory with the default sizes. This
+ * is called by the constructor, and by the initialization routines of a cell
+ * that has been moved from. */
+void voronoicell_base::allocate_memory() {
 	int i;
+	current_vertices=init_vertices;current_vertex_order=init_vertex_order;
+	current_delete_size=init_delete_size;current_delete2_size=init_delete2_size;
+	current_xsearch_size=init_xsearch_size;
+	ed=new int*[current_vertices];nu=new int[current_vertices];
+	mask=new unsigned int[current_vertices];
+	pts=new double[current_vertices<<2];
+	mem=new int[current_vertex_order];mec=new int[current_vertex_order];
+	mep=new int*[current_vertex_order];
+	ds=new int[current_delete_size];stacke=ds+current_delete_size;
+	ds2=new int[current_delete2_size];stacke2=ds2+current_delete2_size;
+	xse=new int[current_xsearch_size];stacke3=xse+current_xsearch_size;
+	maskc=0;
 	for(i=0;i<current_vertices;i++) mask[i]=0;
 	for(i=0;i<3;i++) {
 		mem[i]=init_n_vertices;mec[i]=0;
@@ -55,11 +66,61 @@ voronoicell_base::~voronoicell_base() {
 	delete [] nu;delete [] ed;
 }
 
+/** The move constructor takes over the dynamically allocated memory of
+ * another cell, and does not allocate any memory. The other cell is left
+ * empty. It may be destroyed or have another cell moved into it, and its
+ * memory is allocated again when it is next initialized.
+ * \param[in] vb the cell to move from. */
+voronoicell_base::voronoicell_base(voronoicell_base &&vb) noexcept :
+	current_vertices(vb.current_vertices), current_vertex_order(vb.current_vertex_order),
+	current_delete_size(vb.current_delete_size), current_delete2_size(vb.current_delete2_size),
+	current_xsearch_size(vb.current_xsearch_size), p(vb.p), up(vb.up),
+	ed(vb.ed), nu(vb.nu), mask(vb.mask), pts(vb.pts), tol(vb.tol),
+	tol_cu(vb.tol_cu), big_tol(vb.big_tol), plane_count(vb.plane_count),
+	peak_vertices(vb.peak_vertices), radius_queries(vb.radius_queries), mem(vb.mem), mec(vb.mec),
+	mep(vb.mep), ds(vb.ds), stackp(vb.stackp), stacke(vb.stacke), ds2(vb.ds2),
+	stackp2(vb.stackp2), stacke2(vb.stacke2), xse(vb.xse), stackp3(vb.stackp3),
+	stacke3(vb.stacke3), maskc(vb.maskc), px(vb.px), py(vb.py), pz(vb.pz),
+	prsq(vb.prsq), max_rsq(vb.max_rsq), max_rv(vb.max_rv) {
+	vb.current_vertices=vb.current_vertex_order=vb.p=vb.up=0;
+	vb.current_delete_size=vb.current_delete2_size=vb.current_xsearch_size=0;
+	vb.ed=vb.mep=0;vb.nu=vb.mem=vb.mec=0;vb.mask=0;vb.pts=0;
+	vb.ds=vb.stackp=vb.stacke=0;
+	vb.ds2=vb.stackp2=vb.stacke2=0;
+	vb.xse=vb.stackp3=vb.stacke3=0;
+}
+
+/** Exchanges the vertex, edge, and memory information with another cell.
+ * This is used to implement move assignment, and does not allocate any
+ * memory.
+ * \param[in] vb the cell to exchange with. */
+void voronoicell_base::swap(voronoicell_base &vb) noexcept {
+	std::swap(current_vertices,vb.current_vertices);
+	std::swap(current_vertex_order,vb.current_vertex_order);
+	std::swap(current_delete_size,vb.current_delete_size);
+	std::swap(current_delete2_size,vb.current_delete2_size);
+	std::swap(current_xsearch_size,vb.current_xsearch_size);
+	std::swap(p,vb.p);std::swap(up,vb.up);
+	std::swap(ed,vb.ed);std::swap(nu,vb.nu);
+	std::swap(mask,vb.mask);std::swap(pts,vb.pts);
+	std::swap(tol,vb.tol);std::swap(tol_cu,vb.tol_cu);std::swap(big_tol,vb.big_tol);
+	std::swap(mem,vb.mem);std::swap(mec,vb.mec);std::swap(mep,vb.mep);
+	std::swap(ds,vb.ds);std::swap(stackp,vb.stackp);std::swap(stacke,vb.stacke);
+	std::swap(ds2,vb.ds2);std::swap(stackp2,vb.stackp2);std::swap(stacke2,vb.stacke2);
+	std::swap(xse,vb.xse);std::swap(stackp3,vb.stackp3);std::swap(stacke3,vb.stacke3);
+	std::swap(maskc,vb.maskc);
+	std::swap(plane_count,vb.plane_count);std::swap(peak_vertices,vb.peak_vertices);
+	std::swap(radius_queries,vb.radius_queries);
+	std::swap(px,vb.px);std::swap(py,vb.py);std::swap(pz,vb.pz);std::swap(prsq,vb.prsq);
+	std::swap(max_rsq,vb.max_rsq);std::swap(max_rv,vb.max_rv);
+}
+
 /** Ensures that enough memory is allocated prior to carrying out a copy.
  * \param[in] vc a reference to the specialized version of the calling class.
  * \param[in] vb a pointered to the class to be copied. */
 template<class vc_class>
 void voronoicell_base::check_memory_for_copy(vc_class &vc,voronoicell_base* vb) {
+	check_allocation(vc);
 	while(current_vertex_order<vb->current_vertex_order) add_memory_vorder(vc);
 	for(int i=0;i<current_vertex_order;i++) while(mem[i]<vb->mec[i]) add_memory(vc,i);
 	while(current_vertices<vb->p) add_memory_vertices(vc);
@@ -70,7 +131,7 @@ void voronoicell_base::check_memory_for_copy(vc_class &vc,voronoicell_base* vb)
  * \param[in] vb a pointer to the class to copy. */
 void voronoicell_base::copy(voronoicell_base* vb) {
 	int i,j;
-	p=vb->p;up=0;
+	p=vb->p;up=0;max_rsq=-1;
 	for(i=0;i<current_vertex_order;i++) {
 		mec[i]=vb->mec[i];
 		for(j=0;j<mec[i]*(2*i+1);j++) mep[i][j]=vb->mep[i][j];
@@ -109,7 +170,7 @@ void voronoicell_neighbor::operator=(voronoicell_neighbor &c) {
 /** Translates the vertices of the Voronoi cell by a given vector.
  * \param[in] (x,y,z) the coordinates of the vector. */
 void voronoicell_base::translate(double x,double y,double z) {
-	x*=2;y*=2;z*=2;
+	x*=2;y*=2;z*=2;max_rsq=-1;
 	double *ptsp=pts;
 	while(ptsp<pts+(p<<2)) {
 		*(ptsp++)+=x;*(ptsp++)+=y;*ptsp+=z;ptsp+=2;
@@ -292,8 +353,9 @@ void voronoicell_base::add_memory_xse() {
  * \param[in] (ymin,ymax) the minimum and maximum y coordinates.
  * \param[in] (zmin,zmax) the minimum and maximum z coordinates. */
 void voronoicell_base::init_base(double xmin,double xmax,double ymin,double ymax,double zmin,double zmax) {
+	if(current_vertices==0) allocate_memory();
 	for(int i=0;i<current_vertex_order;i++) mec[i]=0;
-	up=0;
+	up=0;max_rsq=-1;
 	mec[3]=p=8;xmin*=2;xmax*=2;ymin*=2;ymax*=2;zmin*=2;zmax*=2;
 	*pts=xmin;pts[1]=ymin;pts[2]=zmin;
 	pts[4]=xmax;pts[5]=ymin;pts[6]=zmin;
@@ -317,11 +379,101 @@ void voronoicell_base::init_base(double xmin,double xmax,double ymin,double ymax
 	*nu=nu[1]=nu[2]=nu[3]=nu[4]=nu[5]=nu[6]=nu[7]=3;
 }
 
+/** Initializes the cell from a list of vertices and a list of faces. The edge
+ * table is reconstructed from the faces: a face walk that arrives at a vertex
+ * along one edge leaves it along the next edge in the vertex's cyclic order,
+ * so the edges around each vertex can be ordered by following the faces that
+ * meet there.
+ * \param[in] vc a reference to the specialized version of the calling class.
+ * \param[in] np the number of vertices.
+ * \param[in] v an array of 3*np vertex coordinates, relative to the cell
+ *              center.
+ * \param[in] nf the number of faces.
+ * \param[in] fv the face vertex list, in the format produced by the
+ *               face_vertices() routine.
+ * \param[in] fid an array of nf face IDs to use as the neighbor information,
+ *                or a null pointer to set them all to zero. */
+template<class vc_class>
+void voronoicell_base::init_faces_base(vc_class &vc,int np,const double *v,int nf,const int *fv,const int *fid) {
+	int i,j,k,l,n,f,tot=0,*st,*sp,*oc,*op;
+	const int *fp;
+
+	check_allocation(vc);
+
+	// Set the vertex positions, and count the number of faces that meet
+	// at each vertex
+	while(current_vertices<np) add_memory_vertices(vc);
+	p=np;up=0;max_rsq=-1;
+	for(i=0;i<p;i++) {
+		pts[i<<2]=2*v[3*i];
+		pts[(i<<2)+1]=2*v[3*i+1];
+		pts[(i<<2)+2]=2*v[3*i+2];
+		nu[i]=0;
+	}
+	for(fp=fv,f=0;f<nf;f++) {
+		n=*(fp++);tot+=n;
+		for(j=0;j<n;j++) nu[fp[j]]++;
+		fp+=n;
+	}
+
+	// For each vertex, record the previous vertex, the next vertex, and
+	// the face, for every face that it is part of
+	st=new int[p<<1];sp=st+p;
+	for(k=i=0;i<p;i++) {st[i]=sp[i]=k;k+=nu[i];}
+	oc=new int[3*tot];
+	for(fp=fv,f=0;f<nf;f++) {
+		n=*(fp++);
+		for(j=0;j<n;j++) {
+			op=oc+3*(sp[fp[j]]++);
+			*op=fp[j==0?n-1:j-1];
+			op[1]=fp[j==n-1?0:j+1];
+			op[2]=f;
+		}
+		fp+=n;
+	}
+
+	// Allocate space for each vertex in the edge table
+	for(i=0;i<current_vertex_order;i++) mec[i]=0;
+	for(i=0;i<p;i++) {
+		n=nu[i];
+		while(n>=current_vertex_order) add_memory_vorder(vc);
+		if(mec[n]==mem[n]) add_memory(vc,n);
+		ed[i]=mep[n]+((n<<1)+1)*mec[n];
+		vc.n_set_pointer(i,n);
+		mec[n]++;
+		ed[i][n<<1]=i;
+	}
+
+	// Order the edges around each vertex. Leaving a vertex along the
+	// face that arrived from vertex k is the edge following the one that
+	// points back to k.
+	for(i=0;i<p;i++) {
+		n=nu[i];op=oc+3*st[i];l=0;
+		for(j=0;j<n;j++) {
+			k=op[3*l+1];
+			ed[i][j]=k;
+			vc.n_set(i,j,fid==0?0:fid[op[3*l+2]]);
+			for(l=0;l<n&&op[3*l]!=k;l++);
+			if(l==n) voro_fatal_error("Inconsistent face information",VOROPP_INTERNAL_ERROR);
+		}
+	}
+	delete [] oc;
+	delete [] st;
+
+	// Fill in the relation table
+	for(i=0;i<p;i++) for(j=0;j<nu[i];j++) {
+		k=ed[i][j];
+		for(l=0;l<nu[k]&&ed[k][l]!=i;l++);
+		ed[i][nu[i]+j]=l;
+	}
+}
+
 /** Initializes an L-shaped Voronoi cell of a fixed size for testing the
  * convexity robustness. */
 void voronoicell::init_l_shape() {
+	if(current_vertices==0) allocate_memory();
 	for(int i=0;i<current_vertex_order;i++) mec[i]=0;
-	up=0;
+	up=0;max_rsq=-1;
 	mec[3]=p=12;
 	const double j=0;
 	*pts=-2;pts[1]=-2;pts[2]=-2;
@@ -360,8 +512,9 @@ void voronoicell::init_l_shape() {
  *              vertices are initialized at (-l,0,0), (l,0,0), (0,-l,0),
  *              (0,l,0), (0,0,-l), and (0,0,l). */
 void voronoicell_base::init_octahedron_base(double l) {
+	if(current_vertices==0) allocate_memory();
 	for(int i=0;i<current_vertex_order;i++) mec[i]=0;
-	up=0;
+	up=0;max_rsq=-1;
 	mec[4]=p=6;l*=2;
 	*pts=-l;pts[1]=0;pts[2]=0;
 	pts[4]=l;pts[5]=0;pts[6]=0;
@@ -387,8 +540,9 @@ void voronoicell_base::init_octahedron_base(double l) {
  * \param (x2,y2,z2) a position vector for the third vertex.
  * \param (x3,y3,z3) a position vector for the fourth vertex. */
 void voronoicell_base::init_tetrahedron_base(double x0,double y0,double z0,double x1,double y1,double z1,double x2,double y2,double z2,double x3,double y3,double z3) {
+	if(current_vertices==0) allocate_memory();
 	for(int i=0;i<current_vertex_order;i++) mec[i]=0;
-	up=0;
+	up=0;max_rsq=-1;
 	mec[3]=p=4;
 	*pts=x0*2;pts[1]=y0*2;pts[2]=z0*2;
 	pts[4]=x1*2;pts[5]=y1*2;pts[6]=z1*2;
@@ -722,6 +876,7 @@ bool voronoicell_base::nplane(vc_class &vc,double x,double y,double z,double rsq
 	unsigned int uw,lw;
 	int *edp,*edd;stackp=ds;
 	double u,l=0;up=0;
+	plane_count++;
 
 	// Initialize the safe testing routine
 	px=x;py=y;pz=z;prsq=rsq;
@@ -824,6 +979,18 @@ bool voronoicell_base::nplane(vc_class &vc,double x,double y,double z,double rsq
 		}
 	}
 	up=0;
+	if(p>peak_vertices) peak_vertices=p;
+
+	// Update the cached maximum vertex radius. If the furthest vertex is
+	// being deleted then the cache is discarded. Otherwise, since the new
+	// vertices lie on edges of the old cell, only they need to be checked.
+	if(max_rsq>=0) {
+		if(ed[max_rv][nu[max_rv]]==-1) max_rsq=-1;
+		else for(double r,*pp=pts+(op<<2);pp<pts+(p<<2);pp+=4) {
+			r=*pp*(*pp)+pp[1]*pp[1]+pp[2]*pp[2];
+			if(r>max_rsq) {max_rsq=r;max_rv=int(pp-pts)>>2;}
+		}
+	}
 
 	// Delete them from the array structure
 	while(stackp>ds) {
@@ -841,6 +1008,7 @@ bool voronoicell_base::nplane(vc_class &vc,double x,double y,double z,double rsq
 		if(up<p) {
 
 			// Vertex management
+			if(max_rv==p) max_rv=up;
 			pts[(up<<2)]=pts[(p<<2)];
 			pts[(up<<2)+1]=pts[(p<<2)+1];
 			pts[(up<<2)+2]=pts[(p<<2)+2];
@@ -869,6 +1037,49 @@ bool voronoicell_base::nplane(vc_class &vc,double x,double y,double z,double rsq
 	return collapse_order2(vc);
 }
 
+/** Cuts the cell by a batch of planes. A key that is monotonic in the distance
+ * of each plane from the cell center is first computed for all of the planes
+ * in a single pass with no branches. Since the vertex positions are stored at
+ * twice their actual value, a plane can only intersect the cell if its key is
+ * less than the maximum vertex radius squared, and the other planes are
+ * discarded. The remaining planes are sorted by their keys and applied from
+ * the nearest to the furthest, so that the cell shrinks as quickly as
+ * possible. Once a plane is reached that lies beyond the current maximum
+ * vertex radius, all of the subsequent ones do too, and the routine stops.
+ * \param[in] vc a reference to the specialized version of the calling class.
+ * \param[in] n the number of planes.
+ * \param[in] pl an array of the planes, each stored as four consecutive
+ *               entries giving the vector and its modulus squared, as in the
+ *               nplane() routine.
+ * \param[in] pid an array of the plane IDs. If this is zero, then the index
+ *                of each plane in the batch is used as its ID.
+ * \return False if the plane cuts deleted the cell entirely, true otherwise. */
+template<class vc_class>
+bool voronoicell_base::nplanes(vc_class &vc,int n,const double *pl,const int *pid) {
+	int i;
+	double mrs=max_radius_squared();
+	const double *qp;
+	std::vector<double> kb(n);
+	std::vector<std::pair<double,int> > ko;
+
+	// Compute the keys for all of the planes, and discard those that
+	// cannot intersect the cell
+	for(i=0,qp=pl;i<n;i++,qp+=4)
+		kb[i]=qp[3]*fabs(qp[3])/(*qp**qp+qp[1]*qp[1]+qp[2]*qp[2]);
+	ko.reserve(n);
+	for(i=0;i<n;i++) if(kb[i]<mrs) ko.push_back(std::make_pair(kb[i],i));
+
+	// Apply the remaining planes in order of increasing distance
+	std::sort(ko.begin(),ko.end());
+	for(std::vector<std::pair<double,int> >::iterator kp=ko.begin();kp<ko.end();kp++) {
+		if(kp->first>=mrs) break;
+		qp=pl+(kp->second<<2);
+		if(!nplane(vc,*qp,qp[1],qp[2],qp[3],pid==0?kp->second:pid[kp->second])) return false;
+		mrs=max_radius_squared();
+	}
+	return true;
+}
+
 /** Creates a new facet.
  * \return True if cell deleted, false otherwise. */
 template<class vc_class>
@@ -1411,8 +1622,10 @@ inline bool voronoicell_base::collapse_order2(vc_class &vc) {
 		// Compact the memory
 		--p;
 		if(up==i) up=0;
+		if(max_rv==i) max_rsq=-1;
 		if(p!=i) {
 			if(up==p) up=i;
+			if(max_rv==p) max_rv=i;
 			pts[i<<2]=pts[p<<2];
 			pts[(i<<2)+1]=pts[(p<<2)+1];
 			pts[(i<<2)+2]=pts[(p<<2)+2];
@@ -1448,8 +1661,10 @@ bool voronoicell_base::collapse_order1(vc_class &vc) {
 		if(!delete_connection(vc,j,k,false)) return false;
 		--p;
 		if(up==i) up=0;
+		if(max_rv==i) max_rsq=-1;
 		if(p!=i) {
 			if(up==p) up=i;
+			if(max_rv==p) max_rv=i;
 			pts[i<<2]=pts[p<<2];
 			pts[(i<<2)+1]=pts[(p<<2)+1];
 			pts[(i<<2)+2]=pts[(p<<2)+2];
@@ -1721,6 +1936,157 @@ void voronoicell_base::minkowski_formula(double x0,double y0,double z0,double r,
 	ar+=arc*si;
 }
 
+/** Calculates the contributions to the Minkowski functionals for this Voronoi
+ * cell for several radii, making a single traversal of the faces. The volume
+ * functional is the volume of the intersection of the cell with a ball of the
+ * given radius centered on the particle, and the area functional is the area
+ * of the part of the sphere that lies inside the cell.
+ * \param[in] n the number of radii.
+ * \param[in] r an array of the radii to consider.
+ * \param[out] ar an array in which to store the area functionals.
+ * \param[out] vo an array in which to store the volume functionals. */
+void voronoicell_base::minkowski(int n,const double *r,double *ar,double *vo) {
+	ball_intersection(n,r,vo,ar,NULL);
+}
+
+/** Calculates the intersection of this Voronoi cell with balls centered on the
+ * particle, for several radii. The cell is decomposed into the same
+ * orthoschemes as used by the minkowski routine, each formed by the particle,
+ * the foot of the perpendicular to a face, the foot of the perpendicular to an
+ * edge of that face, and a vertex. The geometry of each orthoscheme is
+ * computed once, and the analytic formulae are then evaluated for all of the
+ * radii.
+ * \param[in] n the number of radii.
+ * \param[in] r an array of the radii to consider.
+ * \param[out] vo an array in which to store the volumes of the intersections
+ *                of the cell with the balls.
+ * \param[out] sa an array in which to store the areas of the parts of the
+ *                spheres that lie inside the cell.
+ * \param[out] fa an array in which to store the areas of the parts of the
+ *                cell faces that lie inside the balls. If this is a null
+ *                pointer, then these areas are not computed. */
+void voronoicell_base::ball_intersection(int n,const double *r,double *vo,double *sa,double *fa) {
+	int i,j,k,l,m,q;
+	double *rr=new double[n];
+	for(q=0;q<n;q++) {rr[q]=2*r[q];vo[q]=sa[q]=0;}
+	if(fa!=NULL) for(q=0;q<n;q++) fa[q]=0;
+	for(i=1;i<p;i++) for(j=0;j<nu[i];j++) {
+		k=ed[i][j];
+		if(k>=0) {
+			ed[i][j]=-1-k;
+			l=cycle_up(ed[i][nu[i]+j],k);
+			m=ed[k][l];ed[k][l]=-1-m;
+			while(m!=i) {
+				q=cycle_up(ed[k][nu[k]+l],m);
+				ball_contrib(i,k,m,n,rr,vo,sa,fa);
+				k=m;l=q;
+				m=ed[k][l];ed[k][l]=-1-m;
+			}
+		}
+	}
+	for(q=0;q<n;q++) {vo[q]*=0.125;sa[q]*=0.25;}
+	if(fa!=NULL) for(q=0;q<n;q++) fa[q]*=0.25;
+	delete [] rr;
+	reset_edges();
+}
+
+/** Computes the contributions of a triangle of a face to the ball
+ * intersection measures, for several radii. This follows the
+ * minkowski_contrib routine, but evaluates the orthonormal frame and the
+ * projected coordinates of the triangle only once.
+ * \param[in] (i,k,m) the vertices of the triangle.
+ * \param[in] n the number of radii.
+ * \param[in] r an array of the radii, scaled by two.
+ * \param[in,out] (vo,sa,fa) the arrays to add the contributions to. */
+inline void voronoicell_base::ball_contrib(int i,int k,int m,int n,const double *r,double *vo,double *sa,double *fa) {
+	double ix=pts[4*i],iy=pts[4*i+1],iz=pts[4*i+2],
+	       kx=pts[4*k],ky=pts[4*k+1],kz=pts[4*k+2],
+	       mx=pts[4*m],my=pts[4*m+1],mz=pts[4*m+2],
+	       ux=kx-ix,uy=ky-iy,uz=kz-iz,vx=mx-kx,vy=my-ky,vz=mz-kz,
+	       e1x=uz*vy-uy*vz,e1y=ux*vz-uz*vx,e1z=uy*vx-ux*vy,e2x,e2y,e2z,
+	       wmag=e1x*e1x+e1y*e1y+e1z*e1z;
+	if(wmag<tol*tol) return;
+	wmag=1/sqrt(wmag);
+	e1x*=wmag;e1y*=wmag;e1z*=wmag;
+
+	// Compute second orthonormal vector
+	if(fabs(e1x)>0.5) {
+		e2x=-e1y;e2y=e1x;e2z=0;
+	} else if(fabs(e1y)>0.5) {
+		e2x=0;e2y=-e1z;e2z=e1y;
+	} else {
+		e2x=e1z;e2y=0;e2z=-e1x;
+	}
+	wmag=1/sqrt(e2x*e2x+e2y*e2y+e2z*e2z);
+	e2x*=wmag;e2y*=wmag;e2z*=wmag;
+
+	// Compute third orthonormal vector. Faces passing through the
+	// particle make no contribution to the volume or sphere area, but may
+	// still contribute to the face area.
+	double e3x=e1z*e2y-e1y*e2z,
+	       e3y=e1x*e2z-e1z*e2x,
+	       e3z=e1y*e2x-e1x*e2y,
+	       x0=e1x*ix+e1y*iy+e1z*iz;
+	if(x0<tol&&fa==NULL) return;
+
+	double ir=e2x*ix+e2y*iy+e2z*iz,is=e3x*ix+e3y*iy+e3z*iz,
+	       kr=e2x*kx+e2y*ky+e2z*kz,ks=e3x*kx+e3y*ky+e3z*kz,
+	       mr=e2x*mx+e2y*my+e2z*mz,ms=e3x*mx+e3y*my+e3z*mz;
+
+	ball_edge(x0,ir,is,kr,ks,n,r,vo,sa,fa);
+	ball_edge(x0,kr,ks,mr,ms,n,r,vo,sa,fa);
+	ball_edge(x0,mr,ms,ir,is,n,r,vo,sa,fa);
+}
+
+/** Computes the contributions of the two orthoschemes associated with an edge
+ * of a triangle to the ball intersection measures, for several radii.
+ * \param[in] x0 the distance from the particle to the plane of the face.
+ * \param[in] (r1,s1) the projected coordinates of the first vertex.
+ * \param[in] (r2,s2) the projected coordinates of the second vertex.
+ * \param[in] n the number of radii.
+ * \param[in] r an array of the radii, scaled by two.
+ * \param[in,out] (vo,sa,fa) the arrays to add the contributions to. */
+void voronoicell_base::ball_edge(double x0,double r1,double s1,double r2,double s2,int n,const double *r,double *vo,double *sa,double *fa) {
+	double r12=r2-r1,s12=s2-s1,l12=r12*r12+s12*s12;
+	if(l12<tol*tol) return;
+	l12=1/sqrt(l12);r12*=l12;s12*=l12;
+	double y0=s12*r1-r12*s1,z1=-r12*r1-s12*s1,z2=r12*r2+s12*s2;
+	if(fabs(y0)<tol) return;
+	for(int q=0;q<n;q++) {
+		if(x0>=tol) {
+			minkowski_formula(x0,y0,z1,r[q],sa[q],vo[q]);
+			minkowski_formula(x0,y0,z2,r[q],sa[q],vo[q]);
+		}
+		if(fa!=NULL&&r[q]>x0) {
+			double rs=r[q]*r[q]-x0*x0;
+			face_formula(y0,z1,rs,fa[q]);
+			face_formula(y0,z2,rs,fa[q]);
+		}
+	}
+}
+
+/** Computes the area of the intersection of a right triangle in the plane of
+ * a face with a disk centered on the foot of the perpendicular from the
+ * particle. The triangle has its right angle at the foot of the perpendicular
+ * to an edge, and the signs of the legs determine the sign of the
+ * contribution, in the same way as in the minkowski_formula routine.
+ * \param[in] y0 the distance from the center of the disk to the edge.
+ * \param[in] z0 the distance along the edge to the vertex.
+ * \param[in] rs the square of the disk radius.
+ * \param[in,out] fa the area to add the contribution to. */
+void voronoicell_base::face_formula(double y0,double z0,double rs,double &fa) {
+	if(fabs(z0)<tol) return;
+	double si,ys,theta,t;
+	if(z0<0) {z0=-z0;si=-1;} else si=1;
+	if(y0<0) {y0=-y0;si=-si;}
+	ys=y0*y0;theta=atan(z0/y0);
+	if(rs<=ys) fa+=si*0.5*rs*theta;
+	else if(rs<ys+z0*z0) {
+		t=sqrt(rs-ys);
+		fa+=si*0.5*(y0*t+rs*(theta-atan(t/y0)));
+	} else fa+=si*0.5*y0*z0;
+}
+
 static double dot_product(double *a, double *b) {
 	return a[0]*b[0]+a[1]*b[1]+a[2]*b[2];
 }
@@ -1821,6 +2187,292 @@ void voronoicell_base::face_areas(std::vector<double> &v) {
 	reset_edges();
 }
 
+/** Calculates the geometry of each face of the Voronoi cell in a single
+ * traversal, for use in finite-volume discretizations. For each face, seven
+ * entries are stored: the area, the outward unit normal, and the centroid of
+ * the face relative to the particle. The faces are in the same order as those
+ * returned by the face_areas() and neighbors() routines.
+ * \param[out] v the vector to store the results in.
+ * \param[out] cv if this is not a null pointer, an array in which to store
+ *                the volume of the cell, followed by its centroid relative to
+ *                the particle, computed during the same traversal. */
+void voronoicell_base::face_geometry(std::vector<double> &v,double *cv) {
+	int i,j,k;
+	double ct[4]={0,0,0,0};
+	v.clear();
+	for(i=1;i<p;i++) for(j=0;j<nu[i];j++) {
+		k=ed[i][j];
+		if(k>=0) face_geometry_search(v,ct,i,j,k);
+	}
+	reset_edges();
+	if(cv!=NULL) face_geometry_finish(ct,cv);
+}
+
+/** This inline routine is called by face_geometry(). It traces around a single
+ * face, splitting it into a fan of triangles about its initial vertex, and
+ * accumulates the area, normal, and centroid of the face. It also accumulates
+ * the volume and first moments of the tetrahedra formed by each triangle and
+ * the particle.
+ * \param[in] v the vector to store the face results in.
+ * \param[in] ct an array accumulating six times the volume of the cell, and
+ *                24 times its first moments, in the scaled coordinates.
+ * \param[in] i the initial vertex of the face.
+ * \param[in] j the index of an edge of the vertex.
+ * \param[in] k the neighboring vertex of i, set to ed[i][j]. */
+inline void voronoicell_base::face_geometry_search(std::vector<double> &v,double *ct,int i,int j,int k) {
+	int l,m,n;
+	double *pi=pts+4*i,*pk,*pm,ux,uy,uz,vx,vy,vz,wx,wy,wz,a,
+	       sa=0,nx=0,ny=0,nz=0,fx=0,fy=0,fz=0,dt;
+	ed[i][j]=-1-k;
+	l=cycle_up(ed[i][nu[i]+j],k);
+	m=ed[k][l];ed[k][l]=-1-m;
+	while(m!=i) {
+		n=cycle_up(ed[k][nu[k]+l],m);
+		pk=pts+4*k;pm=pts+4*m;
+		ux=*pk-*pi;uy=pk[1]-pi[1];uz=pk[2]-pi[2];
+		vx=*pm-*pi;vy=pm[1]-pi[1];vz=pm[2]-pi[2];
+
+		// The vector product of the triangle edges points out of the
+		// cell, and its length is twice the triangle area
+		wx=uz*vy-uy*vz;wy=ux*vz-uz*vx;wz=uy*vx-ux*vy;
+		a=sqrt(wx*wx+wy*wy+wz*wz);
+		sa+=a;nx+=wx;ny+=wy;nz+=wz;
+		fx+=a*(*pi+*pk+*pm);fy+=a*(pi[1]+pk[1]+pm[1]);fz+=a*(pi[2]+pk[2]+pm[2]);
+
+		// Add the signed volume of the tetrahedron formed with the
+		// particle
+		dt=*pi*(pk[1]*pm[2]-pk[2]*pm[1])+pi[1]*(pk[2]*(*pm)-*pk*pm[2])+pi[2]*(*pk*pm[1]-pk[1]*(*pm));
+		*ct+=dt;ct[1]+=dt*(*pi+*pk+*pm);ct[2]+=dt*(pi[1]+pk[1]+pm[1]);ct[3]+=dt*(pi[2]+pk[2]+pm[2]);
+		k=m;l=n;
+		m=ed[k][l];ed[k][l]=-1-m;
+	}
+
+	// Store the area, normal, and centroid, scaling to take into account
+	// that the vertex positions are stored at twice their actual value. If
+	// the face is too small to have a well-defined normal, then a zero
+	// vector is stored, as in the normals() routine.
+	v.push_back(0.125*sa);
+	a=nx*nx+ny*ny+nz*nz;
+	if(a>tol*tol) {
+		a=1/sqrt(a);
+		v.push_back(nx*a);v.push_back(ny*a);v.push_back(nz*a);
+	} else {
+		v.push_back(0);v.push_back(0);v.push_back(0);
+	}
+	if(sa>0) {
+		a=1/(6*sa);
+		v.push_back(fx*a);v.push_back(fy*a);v.push_back(fz*a);
+	} else {
+		v.push_back(0.5*(*pi));v.push_back(0.5*pi[1]);v.push_back(0.5*pi[2]);
+	}
+}
+
+/** Converts the accumulated tetrahedron sums from the face_geometry_search()
+ * routine into the volume and centroid of the cell.
+ * \param[in] ct the accumulated sums.
+ * \param[out] cv an array in which to store the volume and centroid. */
+void voronoicell_base::face_geometry_finish(double *ct,double *cv) {
+	*cv=-ct[0]/48;
+	if(ct[0]!=0) {
+		double fac=1/(8*ct[0]);
+		cv[1]=ct[1]*fac;cv[2]=ct[2]*fac;cv[3]=ct[3]*fac;
+	} else cv[1]=cv[2]=cv[3]=0;
+}
+
+/** Calculates the Minkowski tensors of the Voronoi cell, together with its
+ * inertia tensor and a set of anisotropy indices, for use in morphometry. The
+ * volume and surface integrals are accumulated during a single traversal of
+ * the faces, which splits each face into a fan of triangles and forms a
+ * tetrahedron from each triangle and the particle. The integrals of the mean
+ * curvature are concentrated on the edges of the cell, and are found in a
+ * second pass over the edges, using the angle between the normals of the two
+ * faces that meet at each edge.
+ *
+ * Each rank two tensor is stored as six values in the order xx, yy, zz, xy,
+ * xz, and yz. The tensors that depend on position are computed about their own
+ * centers, so that they are independent of the position of the cell. The
+ * values stored are:
+ *  - 0 to 2: the scalar Minkowski functionals W0, W1, and W2, which are the
+ *    volume, one third of the surface area, and one third of the integrated
+ *    mean curvature.
+ *  - 3 to 8: the tensor W0^{2,0}, the second moment of the volume about the
+ *    centroid.
+ *  - 9 to 14: the tensor W1^{2,0}, one third of the second moment of the
+ *    surface about its center.
+ *  - 15 to 20: the tensor W2^{2,0}, the corresponding moment of the edges
+ *    weighted by their mean curvature.
+ *  - 21 to 26: the tensor W1^{0,2}, one third of the integral of the outer
+ *    product of the normal over the surface.
+ *  - 27 to 32: the tensor W2^{0,2}, the corresponding integral weighted by the
+ *    mean curvature.
+ *  - 33 to 38: the inertia tensor about the centroid, for a unit density.
+ *  - 39 to 44: the anisotropy indices of the six tensors above, computed
+ *    using the anisotropy() routine.
+ * \param[out] w an array of length minkowski_tensor_size in which to store
+ *               the results. */
+void voronoicell_base::minkowski_tensors(double *w) {
+	int i,j,k,l,m,n,f,ne_tot;
+	double a[3],b[3],c[3],s[3],ux,uy,uz,vx,vy,vz,wx,wy,wz,ar,dv,
+	       nx,ny,nz,sa,cs,sn,al,len,*n1,*n2,t[3],ca,cb,cc;
+	double mv[10]={0,0,0,0,0,0,0,0,0,0},ms[10]={0,0,0,0,0,0,0,0,0,0},
+	       me[10]={0,0,0,0,0,0,0,0,0,0},*ta=w+21,*tb=w+27;
+	for(i=0;i<12;i++) ta[i]=0;
+
+	// Trace around each face, labeling its directed edges with the face
+	// index, and accumulate the volume and surface moments and the
+	// normal tensor
+	std::vector<int> eo(p+1);
+	for(ne_tot=i=0;i<p;i++) {eo[i]=ne_tot;ne_tot+=nu[i];}
+	std::vector<int> el(ne_tot);
+	std::vector<double> fn;
+	for(f=0,i=1;i<p;i++) for(j=0;j<nu[i];j++) {
+		k=ed[i][j];
+		if(k<0) continue;
+		*a=0.5*pts[4*i];a[1]=0.5*pts[4*i+1];a[2]=0.5*pts[4*i+2];
+		el[eo[i]+j]=f;ed[i][j]=-1-k;
+		l=cycle_up(ed[i][nu[i]+j],k);
+		m=ed[k][l];el[eo[k]+l]=f;ed[k][l]=-1-m;
+		sa=nx=ny=nz=0;
+		while(m!=i) {
+			n=cycle_up(ed[k][nu[k]+l],m);
+			*b=0.5*pts[4*k];b[1]=0.5*pts[4*k+1];b[2]=0.5*pts[4*k+2];
+			*c=0.5*pts[4*m];c[1]=0.5*pts[4*m+1];c[2]=0.5*pts[4*m+2];
+			ux=*b-*a;uy=b[1]-a[1];uz=b[2]-a[2];
+			vx=*c-*a;vy=c[1]-a[1];vz=c[2]-a[2];
+
+			// The vector product points out of the cell, and its
+			// length is twice the triangle area
+			wx=uz*vy-uy*vz;wy=ux*vz-uz*vx;wz=uy*vx-ux*vy;
+			ar=0.5*sqrt(wx*wx+wy*wy+wz*wz);
+			dv=(*a*wx+a[1]*wy+a[2]*wz)*(1/6.0);
+			sa+=ar;nx+=wx;ny+=wy;nz+=wz;
+			*s=*a+*b+*c;s[1]=a[1]+b[1]+c[1];s[2]=a[2]+b[2]+c[2];
+
+			// Add the moments of the triangle and of the
+			// tetrahedron that it forms with the particle
+			*ms+=ar;*mv+=dv;
+			for(int q=0;q<3;q++) {ms[q+1]+=ar*s[q]*(1/3.0);mv[q+1]+=dv*s[q]*0.25;}
+			ca=ar*(1/12.0);cb=dv*(1/20.0);
+			tensor_moment(ms+4,ca,a);tensor_moment(ms+4,ca,b);
+			tensor_moment(ms+4,ca,c);tensor_moment(ms+4,ca,s);
+			tensor_moment(mv+4,cb,a);tensor_moment(mv+4,cb,b);
+			tensor_moment(mv+4,cb,c);tensor_moment(mv+4,cb,s);
+			k=m;l=n;
+			m=ed[k][l];el[eo[k]+l]=f;ed[k][l]=-1-m;
+		}
+
+		// Store the unit normal of the face, or a zero vector if the
+		// face is too small for it to be well-defined
+		ar=nx*nx+ny*ny+nz*nz;
+		ar=ar>tol*tol?1/sqrt(ar):0;
+		t[0]=nx*ar;t[1]=ny*ar;t[2]=nz*ar;
+		fn.insert(fn.end(),t,t+3);
+		tensor_moment(ta,sa*(1/3.0),t);
+		f++;
+	}
+	reset_edges();
+
+	// Loop over the edges, adding the contributions from the mean
+	// curvature that is concentrated on each one
+	for(k=0;k<p;k++) for(l=0;l<nu[k];l++) {
+		m=ed[k][l];
+		if(m<k) continue;
+		n1=fn.data()+3*el[eo[k]+l];
+		n2=fn.data()+3*el[eo[m]+ed[k][nu[k]+l]];
+		cs=*n1*(*n2)+n1[1]*n2[1]+n1[2]*n2[2];
+		ux=n1[1]*n2[2]-n1[2]*n2[1];uy=n1[2]*(*n2)-*n1*n2[2];uz=*n1*n2[1]-n1[1]*(*n2);
+		sn=sqrt(ux*ux+uy*uy+uz*uz);
+		if(sn<tol) continue;
+		al=atan2(sn,cs);
+		*a=0.5*pts[4*k];a[1]=0.5*pts[4*k+1];a[2]=0.5*pts[4*k+2];
+		*b=0.5*pts[4*m];b[1]=0.5*pts[4*m+1];b[2]=0.5*pts[4*m+2];
+		ux=*b-*a;uy=b[1]-a[1];uz=b[2]-a[2];
+		len=sqrt(ux*ux+uy*uy+uz*uz);
+		*s=*a+*b;s[1]=a[1]+b[1];s[2]=a[2]+b[2];
+
+		// Add the moments of the edge, weighted by its angle
+		ca=al*len;*me+=ca;
+		for(int q=0;q<3;q++) me[q+1]+=0.5*ca*s[q];
+		ca*=1/6.0;
+		tensor_moment(me+4,ca,a);tensor_moment(me+4,ca,b);tensor_moment(me+4,ca,s);
+
+		// Integrate the outer product of the normal as it rotates
+		// from the first face to the second, in terms of the first
+		// normal and the unit vector perpendicular to it in the plane
+		// of the two normals
+		for(int q=0;q<3;q++) t[q]=(n2[q]-cs*n1[q])/sn;
+		ca=len*(1/6.0);
+		cb=ca*(0.5*al+0.5*sn*cs);cc=ca*(0.5*al-0.5*sn*cs);ca*=0.5*sn*sn;
+		tensor_moment(tb,cb,n1);tensor_moment(tb,cc,t);
+		*tb+=2*ca**n1*(*t);tb[1]+=2*ca*n1[1]*t[1];tb[2]+=2*ca*n1[2]*t[2];
+		tb[3]+=ca*(*n1*t[1]+n1[1]*(*t));
+		tb[4]+=ca*(*n1*t[2]+n1[2]*(*t));
+		tb[5]+=ca*(n1[1]*t[2]+n1[2]*t[1]);
+	}
+
+	// Compute the scalar functionals and the tensors about their centers
+	*w=*mv;w[1]=*ms*(1/3.0);w[2]=*me*(1/6.0);
+	tensor_center(w+3,1,mv);
+	tensor_center(w+9,1/3.0,ms);
+	tensor_center(w+15,1/6.0,me);
+
+	// Compute the inertia tensor from the second moment of the volume
+	ca=w[3]+w[4]+w[5];
+	w[33]=ca-w[3];w[34]=ca-w[4];w[35]=ca-w[5];
+	w[36]=-w[6];w[37]=-w[7];w[38]=-w[8];
+	for(i=0;i<6;i++) w[39+i]=anisotropy(w+3+6*i);
+}
+
+/** Adds a multiple of the outer product of a vector with itself to a
+ * symmetric tensor.
+ * \param[in] mo the tensor, stored as six values.
+ * \param[in] f the multiple.
+ * \param[in] a the vector. */
+inline void voronoicell_base::tensor_moment(double *mo,double f,const double *a) {
+	*mo+=f**a*(*a);mo[1]+=f*a[1]*a[1];mo[2]+=f*a[2]*a[2];
+	mo[3]+=f**a*a[1];mo[4]+=f**a*a[2];mo[5]+=f*a[1]*a[2];
+}
+
+/** Converts a set of accumulated moments into a second moment tensor about
+ * their center, and multiplies it by a constant factor.
+ * \param[out] t the tensor to store, as six values.
+ * \param[in] f the factor.
+ * \param[in] mo the moments, consisting of the total, the three first
+ *               moments, and the six second moments. */
+inline void voronoicell_base::tensor_center(double *t,double f,const double *mo) {
+	double c[3],g=*mo!=0?1/(*mo):0;
+	c[0]=mo[1]*g;c[1]=mo[2]*g;c[2]=mo[3]*g;
+	for(int i=0;i<6;i++) t[i]=mo[4+i];
+	tensor_moment(t,-*mo,c);
+	for(int i=0;i<6;i++) t[i]*=f;
+}
+
+/** Calculates an anisotropy index of a symmetric tensor, given by the ratio of
+ * the smallest to the largest absolute value of its eigenvalues. The index is
+ * one for an isotropic tensor, and tends to zero as the tensor becomes more
+ * anisotropic. The eigenvalues are found using the closed-form solution of
+ * the characteristic cubic.
+ * \param[in] t the tensor, stored as six values in the order xx, yy, zz, xy,
+ *              xz, and yz.
+ * \return The anisotropy index, or zero if the tensor is zero. */
+double voronoicell_base::anisotropy(const double *t) {
+	double q=(*t+t[1]+t[2])*(1/3.0),o=t[3]*t[3]+t[4]*t[4]+t[5]*t[5],
+	       ax=*t-q,ay=t[1]-q,az=t[2]-q,pp=sqrt((ax*ax+ay*ay+az*az+2*o)*(1/6.0)),r,ph,e1,e2,e3;
+	if(pp<=tolerance*fabs(q)) return q!=0?1:0;
+
+	// Compute half the determinant of the scaled deviatoric tensor, which
+	// gives the angle of the eigenvalues in the trigonometric solution
+	ax/=pp;ay/=pp;az/=pp;
+	r=0.5*(ax*ay*az+2*t[3]*t[4]*t[5]/(pp*pp*pp)-(ax*t[5]*t[5]+ay*t[4]*t[4]+az*t[3]*t[3])/(pp*pp));
+	ph=r<=-1?M_PI/3:(r>=1?0:acos(r)/3);
+	e1=fabs(q+2*pp*cos(ph));
+	e3=fabs(q+2*pp*cos(ph+2*M_PI/3));
+	e2=fabs(3*q-(q+2*pp*cos(ph))-(q+2*pp*cos(ph+2*M_PI/3)));
+	ph=e1<e2?e1:e2;if(e3<ph) ph=e3;
+	r=e1>e2?e1:e2;if(e3>r) r=e3;
+	return r>0?ph/r:0;
+}
+
 /** Calculates the total surface area of the Voronoi cell.
  * \return The computed area. */
 double voronoicell_base::surface_area() {
@@ -1953,18 +2605,24 @@ void voronoicell_base::centroid(double buffer[4]) {
 
 /** Computes the maximum radius squared of a vertex from the center of the
  * cell. It can be used to determine when enough particles have been testing an
- * all planes that could cut the cell have been considered.
+ * all planes that could cut the cell have been considered. The value is
+ * cached, and is kept up to date by the plane cutting routine, so that the
+ * vertices only need to be scanned after the cell is initialized or its
+ * furthest vertex is cut off.
  * \return The maximum radius squared of a vertex.*/
 double voronoicell_base::max_radius_squared() {
-	double r,s,*ptsp=pts+4,*ptse=pts+(p<<2);
-	r=*pts*(*pts)+pts[1]*pts[1]+pts[2]*pts[2];
-	while(ptsp<ptse) {
-		s=*ptsp*(*ptsp);ptsp++;
-		s+=*ptsp*(*ptsp);ptsp++;
-		s+=*ptsp*(*ptsp);ptsp+=2;
-		if(s>r) r=s;
+	radius_queries++;
+	if(max_rsq<0) {
+		double s,*ptsp=pts+4,*ptse=pts+(p<<2);
+		max_rsq=*pts*(*pts)+pts[1]*pts[1]+pts[2]*pts[2];max_rv=0;
+		while(ptsp<ptse) {
+			s=*ptsp*(*ptsp);ptsp++;
+			s+=*ptsp*(*ptsp);ptsp++;
+			s+=*ptsp*(*ptsp);ptsp+=2;
+			if(s>max_rsq) {max_rsq=s;max_rv=(int(ptsp-pts)>>2)-1;}
+		}
 	}
-	return r;
+	return max_rsq;
 }
 
 /** Calculates the total edge distance of the Voronoi cell.
@@ -2446,6 +3104,54 @@ bool voronoicell_base::plane_intersects_guess(double x,double y,double z,double
 	return true;
 }
 
+/** Computes the support values of the cell along the positive and negative
+ * coordinate directions, which give the bounding box of its vertices. Since
+ * the vertex positions are stored at twice their actual value, the support
+ * values are scaled by the same factor, matching the convention used in the
+ * plane intersection routines.
+ * \param[out] sb an array of six values, into which the minimum and maximum
+ *                x, y, and z coordinates are stored. */
+void voronoicell_base::support_box(double *sb) {
+	double *pp=pts,*pe=pts+(p<<2);
+	sb[0]=sb[1]=*pp;sb[2]=sb[3]=pp[1];sb[4]=sb[5]=pp[2];
+	for(pp+=4;pp<pe;pp+=4) {
+		if(*pp<sb[0]) sb[0]=*pp;
+		if(*pp>sb[1]) sb[1]=*pp;
+		if(pp[1]<sb[2]) sb[2]=pp[1];
+		if(pp[1]>sb[3]) sb[3]=pp[1];
+		if(pp[2]<sb[4]) sb[4]=pp[2];
+		if(pp[2]>sb[5]) sb[5]=pp[2];
+	}
+}
+
+/** This routine tests to see if a cell intersects any of a group of planes, by
+ * evaluating all of them in a single pass over the vertices. The vertices are
+ * processed in short runs, and for each plane the test over a run has no early
+ * exit, so that the compiler can vectorize it using the padded four-entry
+ * layout of the vertex array. The routine is used to test all of the
+ * rejection planes of a block at once, which is cheaper than making separate
+ * passes for each plane.
+ * \param[in] n the number of planes.
+ * \param[in] pl an array of the planes, each stored as four consecutive
+ *               entries giving the normal vector and the distance along
+ *               it, as in the plane_intersects() routine.
+ * \return True if any of the planes intersect the cell, false otherwise. */
+bool voronoicell_base::planes_intersect(int n,const double *pl) {
+	const double *qp,*ql=pl+(n<<2);
+	double *pp,*pe,*pr=pts+(p<<2);
+	bool f;
+	for(pp=pts;pp<pr;pp=pe) {
+		pe=pp+(plane_test_run<<2);
+		if(pe>pr) pe=pr;
+		for(qp=pl;qp<ql;qp+=4) {
+			f=false;
+			for(double *tp=pp;tp<pe;tp+=4) f|=*qp**tp+qp[1]*tp[1]+qp[2]*tp[2]>qp[3];
+			if(f) return true;
+		}
+	}
+	return false;
+}
+
 /* This routine tests to see if a cell intersects a plane, by tracing over the
  * cell from vertex to vertex, starting at up. It is meant to be called either
  * by plane_intersects() or plane_intersects_track(), when those routines
@@ -2616,6 +3322,7 @@ void voronoicell_base::output_custom(const char *format,int i,double x,double y,
  * \param[in] (ymin,ymax) the minimum and maximum y coordinates.
  * \param[in] (zmin,zmax) the minimum and maximum z coordinates. */
 void voronoicell_neighbor::init(double xmin,double xmax,double ymin,double ymax,double zmin,double zmax) {
+	check_allocation(*this);
 	init_base(xmin,xmax,ymin,ymax,zmin,zmax);
 	int *q=mne[3];
 	*q=-5;q[1]=-3;q[2]=-1;
@@ -2638,6 +3345,7 @@ void voronoicell_neighbor::init(double xmin,double xmax,double ymin,double ymax,
  *              vertices are initialized at (-l,0,0), (l,0,0), (0,-l,0),
  *              (0,l,0), (0,0,-l), and (0,0,l). */
 void voronoicell_neighbor::init_octahedron(double l) {
+	check_allocation(*this);
 	init_octahedron_base(l);
 	int *q=mne[4];
 	*q=-5;q[1]=-6;q[2]=-7;q[3]=-8;
@@ -2658,6 +3366,7 @@ void voronoicell_neighbor::init_octahedron(double l) {
  * \param (x2,y2,z2) a position vector for the third vertex.
  * \param (x3,y3,z3) a position vector for the fourth vertex. */
 void voronoicell_neighbor::init_tetrahedron(double x0,double y0,double z0,double x1,double y1,double z1,double x2,double y2,double z2,double x3,double y3,double z3) {
+	check_allocation(*this);
 	init_tetrahedron_base(x0,y0,z0,x1,y1,z1,x2,y2,z2,x3,y3,z3);
 	int *q=mne[3];
 	*q=-4;q[1]=-3;q[2]=-2;
@@ -2699,6 +3408,27 @@ void voronoicell_neighbor::memory_setup() {
 	for(i=4;i<current_vertex_order;i++) mne[i]=new int[init_n_vertices*i];
 }
 
+/** The move constructor takes over the dynamically allocated memory of
+ * another cell, including its neighbor information, and does not allocate
+ * any memory. The other cell is left empty, and its memory is allocated again
+ * when it is next initialized.
+ * \param[in] c the cell to move from. */
+voronoicell_neighbor::voronoicell_neighbor(voronoicell_neighbor &&c) noexcept :
+	voronoicell_base(std::move(c)), mne(c.mne), ne(c.ne) {
+	c.mne=c.ne=0;
+}
+
+/** Exchanges all of the information with another cell, without allocating
+ * any memory.
+ * \param[in] c the cell to move from.
+ * \return A reference to this cell. */
+voronoicell_neighbor& voronoicell_neighbor::operator=(voronoicell_neighbor &&c) noexcept {
+	swap(c);
+	std::swap(mne,c.mne);
+	std::swap(ne,c.ne);
+	return *this;
+}
+
 /** The class destructor frees the dynamically allocated memory for storing
  * neighbor information. */
 voronoicell_neighbor::~voronoicell_neighbor() {
@@ -2707,6 +3437,166 @@ voronoicell_neighbor::~voronoicell_neighbor() {
 	delete [] ne;
 }
 
+/** Cuts the cell by a batch of planes, and reports which of them produced
+ * faces of the resulting cell.
+ * \param[in] n the number of planes.
+ * \param[in] pl an array of the planes, each stored as four consecutive
+ *               entries giving the vector and its modulus squared, as in the
+ *               nplane() routine.
+ * \param[in] pid an array of the plane IDs. If this is zero, then the index
+ *                of each plane in the batch is used as its ID.
+ * \param[out] fid a vector into which the IDs of the planes in the batch that
+ *                 correspond to faces of the cell are stored, in the order of
+ *                 the faces. If a plane cut before the batch shares an ID
+ *                 with one of the planes in the batch, then its face will
+ *                 also be included.
+ * \return False if the plane cuts deleted the cell entirely, true otherwise. */
+bool voronoicell_neighbor::nplanes(int n,const double *pl,const int *pid,std::vector<int> &fid) {
+	fid.clear();
+	if(!nplanes(*this,n,pl,pid)) return false;
+	std::vector<int> bi,v;
+	if(pid==0) {
+		for(int i=0;i<n;i++) bi.push_back(i);
+	} else {
+		bi.assign(pid,pid+n);
+		std::sort(bi.begin(),bi.end());
+	}
+	neighbors(v);
+	for(std::vector<int>::iterator vp=v.begin();vp<v.end();vp++)
+		if(std::binary_search(bi.begin(),bi.end(),*vp)) fid.push_back(*vp);
+	return true;
+}
+
+/** Calculates the geometry of each face of the Voronoi cell in a single
+ * traversal, along with the ID of the neighboring particle or wall that
+ * created each face. The face results are stored in the same format as in the
+ * voronoicell_base::face_geometry() routine.
+ * \param[out] nb the vector to store the neighbor IDs in.
+ * \param[out] v the vector to store the face results in.
+ * \param[out] cv if this is not a null pointer, an array in which to store
+ *                the volume of the cell, followed by its centroid relative to
+ *                the particle. */
+void voronoicell_neighbor::face_geometry(std::vector<int> &nb,std::vector<double> &v,double *cv) {
+	int i,j,k;
+	double ct[4]={0,0,0,0};
+	nb.clear();v.clear();
+	for(i=1;i<p;i++) for(j=0;j<nu[i];j++) {
+		k=ed[i][j];
+		if(k>=0) {
+			nb.push_back(ne[i][j]);
+			face_geometry_search(v,ct,i,j,k);
+		}
+	}
+	reset_edges();
+	if(cv!=NULL) face_geometry_finish(ct,cv);
+}
+
+/** Computes the derivatives of the volume and surface area of the Voronoi cell
+ * with respect to the position of its particle and the positions of the
+ * neighboring particles. Moving a neighbor displaces the plane of the face
+ * that it creates by an amount that varies linearly over the face, and
+ * integrating this displacement over the face gives the volume derivative in
+ * terms of the face area and centroid. The area derivative is found by summing
+ * over the edges of the cell, since an edge between faces whose normals are
+ * separated by an angle phi moves within each face by an amount proportional
+ * to the displacements of the two planes, giving a contribution of
+ * L*tan(phi/2) times the sum of the plane displacements at the midpoint of an
+ * edge of length L. Faces created by walls or container boundaries, which have
+ * negative neighbor IDs, are taken to be fixed.
+ * \param[out] nb a vector in which to store the neighbor IDs of the faces.
+ * \param[out] g a vector in which to store the derivatives. For each face,
+ *               six entries are stored, giving the gradients of the volume
+ *               and the surface area with respect to the position of the
+ *               neighbor. These are followed by six entries for the gradients
+ *               with respect to the position of the particle itself.
+ * \param[in] dx an optional array of displacements from the particle to the
+ *               neighbor of each face, three per face. If this is a null
+ *               pointer, then each neighbor is taken to be the reflection of
+ *               the particle in the plane of the face, which holds for the
+ *               regular Voronoi tessellation but not the radical one. */
+void voronoicell_neighbor::gradients(std::vector<int> &nb,std::vector<double> &g,const double *dx) {
+	int i,j,k,l,m,f,h,nf,ne_tot;
+	double *fp,*dp,*gp,*gi,c,s,t,w,len,mx,my,mz,ux,uy,uz;
+	std::vector<double> fg;
+	face_geometry(nb,fg);
+	nf=nb.size();
+	g.assign(6*(nf+1),0);
+	gi=g.data()+6*nf;
+
+	// Find the displacement to the neighbor of each face, and the
+	// reciprocal of its length, which is zero for fixed faces
+	std::vector<double> dd(4*nf,0);
+	for(f=0;f<nf;f++) if(nb[f]>=0) {
+		fp=fg.data()+7*f;dp=dd.data()+4*f;
+		if(dx!=NULL) {
+			*dp=dx[3*f];dp[1]=dx[3*f+1];dp[2]=dx[3*f+2];
+		} else {
+			t=2*(fp[1]*fp[4]+fp[2]*fp[5]+fp[3]*fp[6]);
+			*dp=fp[1]*t;dp[1]=fp[2]*t;dp[2]=fp[3]*t;
+		}
+		t=*dp*(*dp)+dp[1]*dp[1]+dp[2]*dp[2];
+		dp[3]=t>0?1/sqrt(t):0;
+	}
+
+	// Add the volume derivatives, which are given by integrating the plane
+	// displacements over the faces
+	for(f=0;f<nf;f++) {
+		fp=fg.data()+7*f;dp=dd.data()+4*f;gp=g.data()+6*f;
+		t=*fp*dp[3];
+		*gp=t*(*dp-fp[4]);gp[1]=t*(dp[1]-fp[5]);gp[2]=t*(dp[2]-fp[6]);
+		*gi+=t*fp[4];gi[1]+=t*fp[5];gi[2]+=t*fp[6];
+	}
+
+	// Label each directed edge with the face that it belongs to, tracing
+	// around the faces in the same order as the neighbors() routine
+	std::vector<int> eo(p+1);
+	for(ne_tot=i=0;i<p;i++) {eo[i]=ne_tot;ne_tot+=nu[i];}
+	std::vector<int> el(ne_tot);
+	for(f=0,i=1;i<p;i++) for(j=0;j<nu[i];j++) {
+		k=ed[i][j];
+		if(k>=0) {
+			el[eo[i]+j]=f;
+			ed[i][j]=-1-k;
+			l=cycle_up(ed[i][nu[i]+j],k);
+			do {
+				m=ed[k][l];
+				el[eo[k]+l]=f;
+				ed[k][l]=-1-m;
+				l=cycle_up(ed[k][nu[k]+l],m);
+				k=m;
+			} while(k!=i);
+			f++;
+		}
+	}
+	reset_edges();
+
+	// Add the area derivatives by looping over each edge once
+	for(k=0;k<p;k++) for(l=0;l<nu[k];l++) {
+		m=ed[k][l];
+		if(m<k) continue;
+		f=el[eo[k]+l];h=el[eo[m]+ed[k][nu[k]+l]];
+		double *nf1=fg.data()+7*f+1,*nf2=fg.data()+7*h+1;
+		c=*nf1*(*nf2)+nf1[1]*nf2[1]+nf1[2]*nf2[2];
+		ux=nf1[1]*nf2[2]-nf1[2]*nf2[1];
+		uy=nf1[2]*(*nf2)-*nf1*nf2[2];
+		uz=*nf1*nf2[1]-nf1[1]*(*nf2);
+		s=sqrt(ux*ux+uy*uy+uz*uz);
+		if(1+c<tol) continue;
+		ux=pts[4*m]-pts[4*k];uy=pts[4*m+1]-pts[4*k+1];uz=pts[4*m+2]-pts[4*k+2];
+		len=0.5*sqrt(ux*ux+uy*uy+uz*uz);
+		t=len*s/(1+c);
+		mx=0.25*(pts[4*k]+pts[4*m]);
+		my=0.25*(pts[4*k+1]+pts[4*m+1]);
+		mz=0.25*(pts[4*k+2]+pts[4*m+2]);
+		for(j=0;j<2;j++,f=h) {
+			dp=dd.data()+4*f;gp=g.data()+6*f+3;
+			w=t*dp[3];
+			*gp+=w*(*dp-mx);gp[1]+=w*(dp[1]-my);gp[2]+=w*(dp[2]-mz);
+			gi[3]+=w*mx;gi[4]+=w*my;gi[5]+=w*mz;
+		}
+	}
+}
+
 /** Computes a vector list of neighbors. */
 void voronoicell_neighbor::neighbors(std::vector<int> &v) {
 	v.clear();
@@ -2759,7 +3649,11 @@ void voronoicell_neighbor::print_edges_neighbors(int i) {
 // Explicit instantiation
 template bool voronoicell_base::nplane(voronoicell&,double,double,double,double,int);
 template bool voronoicell_base::nplane(voronoicell_neighbor&,double,double,double,double,int);
+template bool voronoicell_base::nplanes(voronoicell&,int,const double*,const int*);
+template bool voronoicell_base::nplanes(voronoicell_neighbor&,int,const double*,const int*);
 template void voronoicell_base::check_memory_for_copy(voronoicell&,voronoicell_base*);
 template void voronoicell_base::check_memory_for_copy(voronoicell_neighbor&,voronoicell_base*);
+template void voronoicell_base::init_faces_base(voronoicell&,int,const double*,int,const int*,const int*);
+template void voronoicell_base::init_faces_base(voronoicell_neighbor&,int,const double*,int,const int*,const int*);
 
 }
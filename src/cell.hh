@@ -11,6 +11,7 @@
 #define VOROPP_CELL_HH
 
 #include <vector>
+#include <utility>
 
 #include "config.hh"
 #include "common.hh"
@@ -89,11 +90,28 @@ class voronoicell_base {
 		double tol;
 		double tol_cu;
 		double big_tol;
+		/** The number of plane cuts that have been attempted since
+		 * the profiling counters were last reset. */
+		int plane_count;
+		/** The largest number of vertices that the cell has held
+		 * during a plane cut since the profiling counters were last
+		 * reset. */
+		int peak_vertices;
+		/** The number of times that the maximum vertex radius has
+		 * been queried since the profiling counters were last reset.
+		 */
+		int radius_queries;
+		/** Resets the profiling counters. */
+		inline void reset_counters() {plane_count=peak_vertices=radius_queries=0;}
 		voronoicell_base(double max_len_sq);
+		voronoicell_base(voronoicell_base &&vb) noexcept;
 		~voronoicell_base();
+		void swap(voronoicell_base &vb) noexcept;
 		void init_base(double xmin,double xmax,double ymin,double ymax,double zmin,double zmax);
 		void init_octahedron_base(double l);
 		void init_tetrahedron_base(double x0,double y0,double z0,double x1,double y1,double z1,double x2,double y2,double z2,double x3,double y3,double z3);
+		template<class vc_class>
+		void init_faces_base(vc_class &vc,int np,const double *v,int nf,const int *fv,const int *fid);
 		void translate(double x,double y,double z);
 		void draw_pov(double x,double y,double z,FILE *fp=stdout);
 		/** Outputs the cell in POV-Ray format, using cylinders for edges
@@ -129,6 +147,13 @@ class voronoicell_base {
 		}
 		double volume();
 		double max_radius_squared();
+		/** Returns the index of the vertex furthest from the center of
+		 * the cell.
+		 * \return The index of the vertex. */
+		inline int furthest_vertex() {
+			max_radius_squared();
+			return max_rv;
+		}
 		double total_edge_distance();
 		double surface_area();
 		void centroid(double &cx,double &cy,double &cz,double &vol);
@@ -144,6 +169,8 @@ class voronoicell_base {
 		void solid_angles(std::vector<double> &v);
 		void face_areas(std::vector<double> &v);
 		void minkowski(double r,double &ar,double &vo);
+		void minkowski(int n,const double *r,double *ar,double *vo);
+		void ball_intersection(int n,const double *r,double *vo,double *sa,double *fa=NULL);
 		/** Outputs the solid angles of the faces.
 		 * \param[in] fp the file handle to write to. */
 		inline void output_solid_angles(FILE *fp=stdout) {
@@ -183,6 +210,9 @@ class voronoicell_base {
 			voro_print_vector(v,fp);
 		}
 		void normals(std::vector<double> &v);
+		void face_geometry(std::vector<double> &v,double *cv=NULL);
+		void minkowski_tensors(double *w);
+		static double anisotropy(const double *t);
 		/** Outputs a list of the perimeters of each face.
 		 * \param[in] fp the file handle to write to. */
 		inline void output_normals(FILE *fp=stdout) {
@@ -198,8 +228,12 @@ class voronoicell_base {
 		void output_custom(const char *format,int i,double x,double y,double z,double r,FILE *fp=stdout);
 		template<class vc_class>
 		bool nplane(vc_class &vc,double x,double y,double z,double rsq,int p_id);
+		template<class vc_class>
+		bool nplanes(vc_class &vc,int n,const double *pl,const int *pid);
 		bool plane_intersects(double x,double y,double z,double rsq);
 		bool plane_intersects_guess(double x,double y,double z,double rsq);
+		bool planes_intersect(int n,const double *pl);
+		void support_box(double *sb);
 		void construct_relations();
 		void check_relations();
 		void check_duplicates();
@@ -251,6 +285,15 @@ class voronoicell_base {
 		 * code allocates more using the add_memory() routine. */
 		int **mep;
 		inline void reset_edges();
+		void allocate_memory();
+		/** Allocates the memory of a cell that has been moved from, so
+		 * that it can be initialized again.
+		 * \param[in] vc a reference to the specialized version of the
+		 *               calling class. */
+		template<class vc_class>
+		inline void check_allocation(vc_class &vc) {
+			if(current_vertices==0) {allocate_memory();vc.n_memory_setup();}
+		}
 		template<class vc_class>
 		void check_memory_for_copy(vc_class &vc,voronoicell_base* vb);
 		void copy(voronoicell_base* vb);
@@ -273,6 +316,12 @@ class voronoicell_base {
 		double pz;
 		/** The magnitude of the normal vector to the test plane. */
 		double prsq;
+		/** The cached maximum radius squared of a vertex, or a
+		 * negative value if it must be recomputed. */
+		double max_rsq;
+		/** The index of the vertex furthest from the center of the
+		 * cell, if the cached maximum radius is valid. */
+		int max_rv;
 		template<class vc_class>
 		void add_memory(vc_class &vc,int i);
 		template<class vc_class>
@@ -304,8 +353,15 @@ class voronoicell_base {
 		inline void minkowski_contrib(int i,int k,int m,double r,double &ar,double &vo);
 		void minkowski_edge(double x0,double r1,double s1,double r2,double s2,double r,double &ar,double &vo);
 		void minkowski_formula(double x0,double y0,double z0,double r,double &ar,double &vo);
+		inline void ball_contrib(int i,int k,int m,int n,const double *r,double *vo,double *sa,double *fa);
+		void ball_edge(double x0,double r1,double s1,double r2,double s2,int n,const double *r,double *vo,double *sa,double *fa);
+		void face_formula(double y0,double z0,double rs,double &fa);
 		inline bool plane_intersects_track(double x,double y,double z,double rs,double g);
 		inline void normals_search(std::vector<double> &v,int i,int j,int k);
+		inline void face_geometry_search(std::vector<double> &v,double *ct,int i,int j,int k);
+		void face_geometry_finish(double *ct,double *cv);
+		inline void tensor_moment(double *mo,double f,const double *a);
+		inline void tensor_center(double *t,double f,const double *mo);
 		inline bool search_edge(int l,int &m,int &k);
 		inline unsigned int m_test(int n,double &ans);
 		inline unsigned int m_testx(int n,double &ans);
@@ -325,6 +381,7 @@ class voronoicell_base {
 class voronoicell : public voronoicell_base {
 	public:
 		using voronoicell_base::nplane;
+		using voronoicell_base::nplanes;
 		voronoicell() : voronoicell_base(default_length*default_length) {}
 		voronoicell(double max_len_sq_) : voronoicell_base(max_len_sq_) {}
 		template<class c_class>
@@ -336,6 +393,19 @@ class voronoicell : public voronoicell_base {
 			voronoicell_base* vb((voronoicell_base*) &c);
 			check_memory_for_copy(*this,vb);copy(vb);
 		}
+		/** Moves another voronoicell class into this class, taking
+		 * over its memory. The other cell is left empty, and its
+		 * memory is allocated again when it is next initialized.
+		 * \param[in] c the class to move from. */
+		voronoicell(voronoicell &&c) noexcept : voronoicell_base(std::move(c)) {}
+		/** Moves another voronoicell class into this class by
+		 * exchanging their memory, so that no allocation takes place.
+		 * \param[in] c the class to move from.
+		 * \return A reference to this class. */
+		inline voronoicell& operator=(voronoicell &&c) noexcept {
+			swap(c);
+			return *this;
+		}
 		/** Cuts a Voronoi cell using by the plane corresponding to the
 		 * perpendicular bisector of a particle.
 		 * \param[in] (x,y,z) the position of the particle.
@@ -376,6 +446,18 @@ class voronoicell : public voronoicell_base {
 			double rsq=x*x+y*y+z*z;
 			return nplane(*this,x,y,z,rsq,0);
 		}
+		/** Cuts a Voronoi cell by a batch of planes. The planes that
+		 * can intersect the cell are applied in order of increasing
+		 * distance, and the rest are skipped.
+		 * \param[in] n the number of planes.
+		 * \param[in] pl an array of the planes, each stored as four
+		 *               consecutive entries giving the vector and its
+		 *               modulus squared, as in the nplane() routine.
+		 * \return False if the plane cuts deleted the cell entirely,
+		 *         true otherwise. */
+		inline bool nplanes(int n,const double *pl) {
+			return nplanes(*this,n,pl,0);
+		}
 		/** Initializes the Voronoi cell to be rectangular box with the
 		 * given dimensions.
 		 * \param[in] (xmin,xmax) the minimum and maximum x coordinates.
@@ -400,8 +482,20 @@ class voronoicell : public voronoicell_base {
 		inline void init_tetrahedron(double x0,double y0,double z0,double x1,double y1,double z1,double x2,double y2,double z2,double x3,double y3,double z3) {
 			init_tetrahedron_base(x0,y0,z0,x1,y1,z1,x2,y2,z2,x3,y3,z3);
 		}
+		/** Initializes the cell from a list of vertices and a list of
+		 * faces, in the formats produced by the vertices() and
+		 * face_vertices() routines.
+		 * \param[in] np the number of vertices.
+		 * \param[in] v an array of 3*np vertex coordinates, relative
+		 *              to the cell center.
+		 * \param[in] nf the number of faces.
+		 * \param[in] fv the face vertex list. */
+		inline void init_faces(int np,const double *v,int nf,const int *fv) {
+			init_faces_base(*this,np,v,nf,fv,0);
+		}
 		void init_l_shape();
 	private:
+		inline void n_memory_setup() {};
 		inline void n_allocate(int ,int ) {};
 		inline void n_add_memory_vertices(int ) {};
 		inline void n_add_memory_vorder(int ) {};
@@ -433,6 +527,7 @@ class voronoicell : public voronoicell_base {
 class voronoicell_neighbor : public voronoicell_base {
 	public:
 		using voronoicell_base::nplane;
+		using voronoicell_base::nplanes;
 		/** This two dimensional array holds the neighbor information
 		 * associated with each vertex. mne[p] is a one dimensional
 		 * array which holds all of the neighbor information for
@@ -455,9 +550,11 @@ class voronoicell_neighbor : public voronoicell_base {
 		voronoicell_neighbor(c_class &con) : voronoicell_base(con.max_len_sq) {
 			memory_setup();
 		}
+		voronoicell_neighbor(voronoicell_neighbor &&c) noexcept;
 		~voronoicell_neighbor();
 		void operator=(voronoicell &c);
 		void operator=(voronoicell_neighbor &c);
+		voronoicell_neighbor& operator=(voronoicell_neighbor &&c) noexcept;
 		/** Cuts the Voronoi cell by a particle whose center is at a
 		 * separation of (x,y,z) from the cell center. The value of rsq
 		 * should be initially set to \f$x^2+y^2+z^2\f$.
@@ -502,11 +599,43 @@ class voronoicell_neighbor : public voronoicell_base {
 			double rsq=x*x+y*y+z*z;
 			return nplane(*this,x,y,z,rsq,0);
 		}
+		/** Cuts a Voronoi cell by a batch of planes. The planes that
+		 * can intersect the cell are applied in order of increasing
+		 * distance, and the rest are skipped.
+		 * \param[in] n the number of planes.
+		 * \param[in] pl an array of the planes, each stored as four
+		 *               consecutive entries giving the vector and its
+		 *               modulus squared, as in the nplane() routine.
+		 * \param[in] pid an array of the plane IDs. If this is zero,
+		 *                then the index of each plane in the batch is
+		 *                used as its ID.
+		 * \return False if the plane cuts deleted the cell entirely,
+		 *         true otherwise. */
+		inline bool nplanes(int n,const double *pl,const int *pid=0) {
+			return nplanes(*this,n,pl,pid);
+		}
+		bool nplanes(int n,const double *pl,const int *pid,std::vector<int> &fid);
 		void init(double xmin,double xmax,double ymin,double ymax,double zmin,double zmax);
 		void init_octahedron(double l);
 		void init_tetrahedron(double x0,double y0,double z0,double x1,double y1,double z1,double x2,double y2,double z2,double x3,double y3,double z3);
+		/** Initializes the cell from a list of vertices and a list of
+		 * faces, in the formats produced by the vertices() and
+		 * face_vertices() routines, together with the neighbor IDs of
+		 * the faces, in the order produced by the neighbors() routine.
+		 * \param[in] np the number of vertices.
+		 * \param[in] v an array of 3*np vertex coordinates, relative
+		 *              to the cell center.
+		 * \param[in] nf the number of faces.
+		 * \param[in] fv the face vertex list.
+		 * \param[in] fid an array of nf neighbor IDs. */
+		inline void init_faces(int np,const double *v,int nf,const int *fv,const int *fid) {
+			init_faces_base(*this,np,v,nf,fv,fid);
+		}
 		void check_facets();
 		virtual void neighbors(std::vector<int> &v);
+		using voronoicell_base::face_geometry;
+		void face_geometry(std::vector<int> &nb,std::vector<double> &v,double *cv=NULL);
+		void gradients(std::vector<int> &nb,std::vector<double> &g,const double *dx=NULL);
 		virtual void print_edges_neighbors(int i);
 		virtual void output_neighbors(FILE *fp=stdout) {
 			std::vector<int> v;neighbors(v);
@@ -516,6 +645,7 @@ class voronoicell_neighbor : public voronoicell_base {
 		int *paux1;
 		int *paux2;
 		void memory_setup();
+		inline void n_memory_setup() {memory_setup();}
 		inline void n_allocate(int i,int m) {mne[i]=new int[m*i];}
 		inline void n_add_memory_vertices(int i) {
 			int **pp=new int*[i];
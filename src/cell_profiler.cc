@@ -0,0 +1,97 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file cell_profiler.cc
+ * \brief Function implementations for the cell_profiler class. */
+
+#include "cell_profiler.hh"
+
+namespace voro {
+
+/** The class constructor sets up the profiler with empty histograms.
+ * \param[in] n_slow_ the number of slowest cells to keep a record of. */
+cell_profiler::cell_profiler(int n_slow_) : n_slow(n_slow_) {
+	reset();
+}
+
+/** Clears the histograms and the records of the slowest cells. */
+void cell_profiler::reset() {
+	cells=0;total_time=0;total_planes=0;total_radius_queries=0;
+	for(int i=0;i<bins;i++) t_hist[i]=p_hist[i]=v_hist[i]=0;
+	sl.clear();heap=true;
+}
+
+/** Computes the histogram bin for a given value.
+ * \param[in] v the value to consider.
+ * \return The bin index. */
+static inline int prof_bin(double v) {
+	if(v<1) return 0;
+	int b=ilogb(v)+1;
+	return b<cell_profiler::bins?b:cell_profiler::bins-1;
+}
+
+/** Adds the cost of a cell computation to the histograms, and stores it if it
+ * is one of the slowest cells.
+ * \param[in] t the computation time, in seconds.
+ * \param[in] planes the number of plane cuts attempted.
+ * \param[in] rq the number of maximum radius queries.
+ * \param[in] peak the peak number of vertices.
+ * \param[in] (ijk,q) the block and index of the particle.
+ * \param[in] id the ID of the particle.
+ * \param[in] (x,y,z) the position of the particle.
+ * \param[in] r the radius of the particle. */
+void cell_profiler::record(double t,int planes,int rq,int peak,int ijk,int q,int id,double x,double y,double z,double r) {
+	cells++;total_time+=t;total_planes+=planes;total_radius_queries+=rq;
+	t_hist[prof_bin(t*1e9)]++;
+	p_hist[prof_bin(planes)]++;
+	v_hist[prof_bin(peak)]++;
+	if(n_slow<=0) return;
+
+	// Restore the heap ordering if the records were sorted for output
+	if(!heap) {std::make_heap(sl.begin(),sl.end());heap=true;}
+	if(int(sl.size())==n_slow) {
+		if(t<=sl.front().t) return;
+		std::pop_heap(sl.begin(),sl.end());
+		sl.pop_back();
+	}
+	prof_record pr;
+	pr.t=t;pr.ijk=ijk;pr.q=q;pr.id=id;pr.planes=planes;pr.peak=peak;
+	pr.x=x;pr.y=y;pr.z=z;pr.r=r;
+	sl.push_back(pr);
+	std::push_heap(sl.begin(),sl.end());
+}
+
+/** Sorts the records of the slowest cells so that the slowest comes first. */
+void cell_profiler::sort_slowest() {
+	if(heap) {std::sort(sl.begin(),sl.end());heap=false;}
+}
+
+/** Prints a summary of the profiled cells, followed by the histograms of
+ * computation time, plane cuts, and peak vertex count. Each histogram line
+ * gives the lower and upper limits of a bin and the number of cells within
+ * it. Empty bins are skipped.
+ * \param[in] fp a file handle to write to. */
+void cell_profiler::print_histograms(FILE *fp) {
+	int i;
+	const char *name[3]={"time (ns)","plane cuts","peak vertices"};
+	long *h[3]={t_hist,p_hist,v_hist};
+	fprintf(fp,"# Cells profiled : %ld\n"
+		   "# Total time     : %g s\n"
+		   "# Mean time      : %g ns\n"
+		   "# Mean plane cuts: %g\n"
+		   "# Mean radius queries: %g\n",cells,total_time,
+		   cells==0?0:1e9*total_time/cells,cells==0?0:double(total_planes)/cells,
+		   cells==0?0:double(total_radius_queries)/cells);
+	for(int j=0;j<3;j++) {
+		fprintf(fp,"\n# Histogram of %s\n",name[j]);
+		for(i=0;i<bins;i++) if(h[j][i]>0)
+			fprintf(fp,"%g %g %ld\n",i==0?0:ldexp(1,i-1),ldexp(1,i),h[j][i]);
+	}
+	if(!sl.empty()) {
+		sort_slowest();
+		fprintf(fp,"\n# Slowest cells: id x y z time(ns) plane_cuts peak_vertices\n");
+		for(std::vector<prof_record>::iterator rp=sl.begin();rp<sl.end();rp++)
+			fprintf(fp,"%d %g %g %g %g %d %d\n",rp->id,rp->x,rp->y,rp->z,rp->t*1e9,rp->planes,rp->peak);
+	}
+}
+
+}
@@ -0,0 +1,248 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file cell_profiler.hh
+ * \brief Header file for the cell_profiler class. */
+
+#ifndef VOROPP_CELL_PROFILER_HH
+#define VOROPP_CELL_PROFILER_HH
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "config.hh"
+#include "common.hh"
+#include "cell.hh"
+#include "c_loops.hh"
+#include "rad_option.hh"
+
+namespace voro {
+
+/** \brief A structure holding the cost of computing a single Voronoi cell. */
+struct prof_record {
+	/** The time taken to compute the cell, in seconds. */
+	double t;
+	/** The block that the particle is within. */
+	int ijk;
+	/** The index of the particle within the block. */
+	int q;
+	/** The ID of the particle. */
+	int id;
+	/** The number of plane cuts that were attempted. */
+	int planes;
+	/** The largest number of vertices held during the computation. */
+	int peak;
+	/** The position of the particle. */
+	double x,y,z;
+	/** The radius of the particle. */
+	double r;
+	/** Compares two records by their computation time. The order is
+	 * reversed, so that the standard heap routines keep the quickest
+	 * record at the top, and sorting places the slowest record first. */
+	inline bool operator<(const prof_record &pr) const {return t>pr.t;}
+};
+
+/** \brief A structure holding a neighboring particle in a replay file. */
+struct prof_neighbor {
+	/** The ID of the particle. */
+	int id;
+	/** The displacement of the particle from the cell's particle. */
+	double x,y,z;
+	/** The modulus squared of the displacement, scaled in the radical
+	 * case to take into account the particle radii. */
+	double rsq;
+	/** Compares two neighbors by their scaled distance. */
+	inline bool operator<(const prof_neighbor &pn) const {return rsq<pn.rsq;}
+};
+
+/** \brief A class for measuring the cost of individual Voronoi cell
+ * computations.
+ *
+ * Some cells, such as those near highly degenerate particle arrangements or in
+ * sparse regions, take much longer to compute than typical cells. This class
+ * can be passed to the profiled variants of the container compute_all_cells
+ * and print_custom routines. For each cell, it records the computation time,
+ * the number of plane cuts attempted, and the peak number of vertices, and
+ * accumulates them into logarithmic histograms. It also keeps a record of the
+ * slowest cells.
+ *
+ * The slowest cells can be written to a replay file, holding the particle
+ * position, the initial box, and the displacements of all particles that
+ * could influence the cell. The replay routine reads this file back and
+ * reconstructs each cell using a standalone voronoicell, so that a difficult
+ * case can be studied without the original particle set. Walls other than
+ * the container boundaries are not recorded in the replay file. */
+class cell_profiler {
+	public:
+		/** The number of bins in each histogram. Bin zero holds values
+		 * less than one, and bin b holds values in the range from
+		 * 2^(b-1) to 2^b. */
+		static const int bins=40;
+		/** The number of slowest cells to keep a record of. */
+		const int n_slow;
+		/** The total number of cells that have been profiled. */
+		long cells;
+		/** The total computation time of the profiled cells, in
+		 * seconds. */
+		double total_time;
+		/** The total number of plane cuts attempted. */
+		long total_planes;
+		/** The total number of queries of the maximum vertex radius.
+		 */
+		long total_radius_queries;
+		/** A histogram of the cell computation times, in
+		 * nanoseconds. */
+		long t_hist[bins];
+		/** A histogram of the number of plane cuts per cell. */
+		long p_hist[bins];
+		/** A histogram of the peak number of vertices per cell. */
+		long v_hist[bins];
+		cell_profiler(int n_slow_=10);
+		void reset();
+		/** Computes a Voronoi cell for the particle currently being
+		 * referenced by a loop class, measuring its cost.
+		 * \param[in] con the container class to use.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 *               computed cell.
+		 * \param[in] vl the loop class to use.
+		 * \return True if the cell was computed, false otherwise. */
+		template<class c_class,class v_cell,class c_loop>
+		inline bool compute_cell(c_class &con,v_cell &c,c_loop &vl) {
+			c.reset_counters();
+			std::chrono::steady_clock::time_point st=std::chrono::steady_clock::now();
+			bool q=con.compute_cell(c,vl);
+			double t=std::chrono::duration<double>(std::chrono::steady_clock::now()-st).count();
+			double *pp=con.p[vl.ijk]+con.ps*vl.q;
+			record(t,c.plane_count,c.radius_queries,c.peak_vertices>c.p?c.peak_vertices:c.p,vl.ijk,vl.q,
+			       con.id[vl.ijk][vl.q],*pp,pp[1],pp[2],con.ps==4?pp[3]:default_radius);
+			return q;
+		}
+		void print_histograms(FILE *fp=stdout);
+		/** Returns the number of slowest cells currently recorded.
+		 * \return The number of cells. */
+		inline int slowest_cells() {return sl.size();}
+		/** Returns a record of one of the slowest cells, ordered from
+		 * the slowest to the quickest.
+		 * \param[in] i the index of the record.
+		 * \return A reference to the record. */
+		inline prof_record& slowest(int i) {
+			sort_slowest();
+			return sl[i];
+		}
+		/** Writes the slowest cells to a replay file. For each cell,
+		 * the Voronoi cell is recomputed to find the sphere of
+		 * influence, and all particles within it are written as
+		 * displacements from the cell's particle. The container must
+		 * not have been modified since the cells were profiled.
+		 * \param[in] con the container class that was profiled.
+		 * \param[in] fp a file handle to write to. */
+		template<class c_class>
+		void dump_slowest(c_class &con,FILE *fp) {
+			int ijk,q;
+			double r,rm,*pp;
+			prof_neighbor pn;
+			std::vector<prof_neighbor> vn;
+			voronoicell c(con);
+			c_loop_subset vl(con);
+			sort_slowest();
+			for(std::vector<prof_record>::iterator rp=sl.begin();rp<sl.end();rp++) {
+				vn.clear();
+				if(con.compute_cell(c,rp->ijk,rp->q)) {
+
+					// Since the vertex positions are stored at
+					// twice their actual value, the square root
+					// of the maximum radius squared is twice the
+					// largest vertex distance. For the radical
+					// tessellation, the search is extended to
+					// account for the largest particle radius.
+					r=0.5*sqrt(c.max_radius_squared());
+					rm=max_particle_radius(con);
+					vl.setup_sphere(rp->x,rp->y,rp->z,r+sqrt(r*r+rm*rm),true);
+					if(vl.start()) do {
+						ijk=vl.ijk;q=vl.q;
+						vl.image_pos(pn.x,pn.y,pn.z);
+						pn.x-=rp->x;pn.y-=rp->y;pn.z-=rp->z;
+						pn.rsq=pn.x*pn.x+pn.y*pn.y+pn.z*pn.z;
+						if(ijk==rp->ijk&&q==rp->q&&pn.rsq==0) continue;
+						if(con.ps==4) {
+							pp=con.p[ijk]+4*q;
+							pn.rsq+=rp->r*rp->r-pp[3]*pp[3];
+						}
+						pn.id=con.id[ijk][q];
+						vn.push_back(pn);
+					} while(vl.inc());
+					std::sort(vn.begin(),vn.end());
+				}
+				fprintf(fp,"cell %d %.17g %.17g %.17g %.17g %g %d %d %d\n",rp->id,
+					rp->x,rp->y,rp->z,rp->r,rp->t,rp->planes,rp->peak,int(vn.size()));
+				fprintf(fp,"box %.17g %.17g %.17g %.17g %.17g %.17g\n",
+					con.xperiodic?-0.5*(con.bx-con.ax):con.ax-rp->x,
+					con.xperiodic?0.5*(con.bx-con.ax):con.bx-rp->x,
+					con.yperiodic?-0.5*(con.by-con.ay):con.ay-rp->y,
+					con.yperiodic?0.5*(con.by-con.ay):con.by-rp->y,
+					con.zperiodic?-0.5*(con.bz-con.az):con.az-rp->z,
+					con.zperiodic?0.5*(con.bz-con.az):con.bz-rp->z);
+				for(std::vector<prof_neighbor>::iterator np=vn.begin();np<vn.end();np++)
+					fprintf(fp,"%d %.17g %.17g %.17g %.17g\n",np->id,np->x,np->y,np->z,np->rsq);
+			}
+		}
+		/** Writes the slowest cells to a replay file.
+		 * \param[in] con the container class that was profiled.
+		 * \param[in] filename the name of the file to write to. */
+		template<class c_class>
+		inline void dump_slowest(c_class &con,const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			dump_slowest(con,fp);
+			fclose(fp);
+		}
+		/** Reads a single cell from a replay file, and reconstructs it
+		 * by initializing the box and cutting it by the recorded
+		 * planes.
+		 * \param[in] fp a file handle to read from.
+		 * \param[out] c the Voronoi cell class to compute into.
+		 * \param[out] id the ID of the particle.
+		 * \param[out] (x,y,z) the position of the particle.
+		 * \param[out] r the radius of the particle.
+		 * \return True if a cell was read, false if the end of the
+		 *         file was reached. */
+		template<class v_cell>
+		static bool replay(FILE *fp,v_cell &c,int &id,double &x,double &y,double &z,double &r) {
+			int i,nn,pid,pl,pk;
+			double t,x1,x2,y1,y2,z1,z2,dx,dy,dz,rsq;
+			i=fscanf(fp," cell %d %lg %lg %lg %lg %lg %d %d %d",&id,&x,&y,&z,&r,&t,&pl,&pk,&nn);
+			if(i==EOF) return false;
+			if(i!=9||fscanf(fp," box %lg %lg %lg %lg %lg %lg",&x1,&x2,&y1,&y2,&z1,&z2)!=6)
+				voro_fatal_error("Replay file import error",VOROPP_FILE_ERROR);
+			c.init(x1,x2,y1,y2,z1,z2);
+			for(i=0;i<nn;i++) {
+				if(fscanf(fp,"%d %lg %lg %lg %lg",&pid,&dx,&dy,&dz,&rsq)!=5)
+					voro_fatal_error("Replay file import error",VOROPP_FILE_ERROR);
+				c.nplane(dx,dy,dz,rsq,pid);
+			}
+			return true;
+		}
+	private:
+		/** The records of the slowest cells, arranged as a heap with
+		 * the quickest record at the top. */
+		std::vector<prof_record> sl;
+		/** Whether the records are currently arranged as a heap,
+		 * rather than sorted. */
+		bool heap;
+		void record(double t,int planes,int rq,int peak,int ijk,int q,int id,double x,double y,double z,double r);
+		void sort_slowest();
+		/** Returns the largest particle radius for the regular
+		 * Voronoi tessellation, which is zero.
+		 * \return Zero. */
+		static inline double max_particle_radius(radius_mono &) {return 0;}
+		/** Returns the largest particle radius for the radical Voronoi
+		 * tessellation.
+		 * \param[in] rp the radius class of the container.
+		 * \return The maximum radius. */
+		static inline double max_particle_radius(radius_poly &rp) {return rp.max_radius;}
+};
+
+}
+
+#endif
@@ -0,0 +1,214 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file cell_store.cc
+ * \brief Function implementations for the cell_store class. */
+
+#include <cmath>
+
+#include "cell_store.hh"
+#include "v_base.hh"
+
+namespace voro {
+
+/** The class constructor allocates the initial index and arena. */
+cell_store::cell_store() : n(0), index_sz(init_store_cells), off(new long[index_sz]),
+	ar(new char[init_store_bytes]), asz(0), arena_sz(init_store_bytes) {}
+
+/** The class destructor frees the dynamically allocated memory. */
+cell_store::~cell_store() {
+	delete [] ar;
+	delete [] off;
+}
+
+/** Removes all of the stored cells, keeping the allocated memory for reuse. */
+void cell_store::clear() {
+	n=0;asz=0;
+}
+
+/** Stores a Voronoi cell without neighbor information.
+ * \param[in] c the cell to store.
+ * \param[in] id the ID of the particle associated with the cell.
+ * \param[in] (x,y,z) the position of the particle.
+ * \param[in] r the radius of the particle. */
+void cell_store::store(voronoicell &c,int id,double x,double y,double z,double r) {
+	add(c,false,id,x,y,z,r);
+}
+
+/** Stores a Voronoi cell, including the neighbor IDs of its faces.
+ * \param[in] c the cell to store.
+ * \param[in] id the ID of the particle associated with the cell.
+ * \param[in] (x,y,z) the position of the particle.
+ * \param[in] r the radius of the particle. */
+void cell_store::store(voronoicell_neighbor &c,int id,double x,double y,double z,double r) {
+	c.neighbors(vn);
+	add(c,true,id,x,y,z,r);
+}
+
+/** Makes space for a new cell at the end of the arena, extending the index
+ * and the arena if necessary.
+ * \param[in] b the number of bytes required.
+ * \return A pointer to the space for the cell. */
+char* cell_store::reserve(long b) {
+	if(n==index_sz) {
+		index_sz<<=1;
+		if(index_sz>max_store_cells)
+			voro_fatal_error("Cell store index allocation exceeded absolute maximum",VOROPP_MEMORY_ERROR);
+#if VOROPP_VERBOSE >=2
+		fprintf(stderr,"Cell store index scaled up to %d\n",index_sz);
+#endif
+		long *noff=new long[index_sz];
+		for(int i=0;i<n;i++) noff[i]=off[i];
+		delete [] off;off=noff;
+	}
+	if(asz+b>arena_sz) {
+		while(asz+b>arena_sz) arena_sz<<=1;
+#if VOROPP_VERBOSE >=2
+		fprintf(stderr,"Cell store arena scaled up to %ld\n",arena_sz);
+#endif
+		char *nar=new char[arena_sz];
+		memcpy(nar,ar,asz);
+		delete [] ar;ar=nar;
+	}
+	off[n++]=asz;
+	char *cp=ar+asz;
+	asz+=b;
+	return cp;
+}
+
+/** Encodes a Voronoi cell and adds it to the arena. If neighbor information
+ * is included, it must already be held in the vn scratch vector.
+ * \param[in] c the cell to store.
+ * \param[in] neighbors whether to store the neighbor information.
+ * \param[in] id the ID of the particle associated with the cell.
+ * \param[in] (x,y,z) the position of the particle.
+ * \param[in] r the radius of the particle. */
+void cell_store::add(voronoicell_base &c,bool neighbors,int id,double x,double y,double z,double r) {
+	int i,np=c.p,nf=0,l;
+	bool wide=np>255;
+	double s=0,t,*dp;
+	unsigned char fl=(wide?1:0)|(neighbors?2:0);
+	if(np>65535) voro_fatal_error("Cell has too many vertices to store",VOROPP_MEMORY_ERROR);
+
+	// Compute the vertices and faces, and find the scale factor for the
+	// vertex quantization
+	c.vertices(vd);
+	c.face_vertices(vi);
+	for(dp=&vd[0];dp<&vd[0]+3*np;dp++) {t=fabs(*dp);if(t>s) s=t;}
+	if(s==0) s=1;
+	l=vi.size();
+	for(i=0;i<l;i+=vi[i]+1) nf++;
+
+	// Write the header, followed by the quantized vertices, the face
+	// vertex list, and the neighbor information
+	char *cp=reserve(sizeof(int)*(2+(neighbors?nf:0))+5*sizeof(double)
+		+(2+3*np)*sizeof(short)+1+l*(wide?2:1));
+	put(cp,id);
+	put(cp,x);put(cp,y);put(cp,z);put(cp,r);put(cp,s);
+	put(cp,(unsigned short) np);put(cp,(unsigned short) nf);
+	put(cp,l);put(cp,fl);
+	t=32767/s;
+	for(dp=&vd[0];dp<&vd[0]+3*np;dp++) put(cp,(short) floor(*dp*t+0.5));
+	if(wide) for(i=0;i<l;i++) put(cp,(unsigned short) vi[i]);
+	else for(i=0;i<l;i++) put(cp,(unsigned char) vi[i]);
+	if(neighbors) for(i=0;i<nf;i++) put(cp,vn[i]);
+}
+
+/** Decodes a stored cell into the scratch vectors.
+ * \param[in] i the index of the cell.
+ * \return The number of vertices in the cell. The number of faces is given by
+ *         the size of the vn scratch vector. */
+int cell_store::unpack(int i) {
+	const char *cp=ar+off[i]+sizeof(int)+4*sizeof(double);
+	int j,l;
+	double s;
+	unsigned short np,nf,us;
+	unsigned char fl,uc;
+	short q;
+	get(cp,s);get(cp,np);get(cp,nf);get(cp,l);get(cp,fl);
+	vd.resize(3*np);vi.resize(l);vn.resize(nf);
+	s*=1/32767.;
+	for(j=0;j<3*np;j++) {get(cp,q);vd[j]=q*s;}
+	if(fl&1) for(j=0;j<l;j++) {get(cp,us);vi[j]=us;}
+	else for(j=0;j<l;j++) {get(cp,uc);vi[j]=uc;}
+	if(fl&2) for(j=0;j<nf;j++) get(cp,vn[j]);
+	else for(j=0;j<nf;j++) vn[j]=0;
+	return np;
+}
+
+/** Returns the position and radius of the particle associated with a stored
+ * cell.
+ * \param[in] i the index of the cell.
+ * \param[out] (x,y,z) the position of the particle.
+ * \param[out] r the radius of the particle. */
+void cell_store::position(int i,double &x,double &y,double &z,double &r) {
+	const char *cp=ar+off[i]+sizeof(int);
+	get(cp,x);get(cp,y);get(cp,z);get(cp,r);
+}
+
+/** Determines whether a stored cell includes neighbor information.
+ * \param[in] i the index of the cell.
+ * \return True if the neighbor IDs were stored, false otherwise. */
+bool cell_store::has_neighbors(int i) {
+	return (ar[off[i]+sizeof(int)*2+5*sizeof(double)+2*sizeof(short)]&2)!=0;
+}
+
+/** Restores a stored cell into a voronoicell class.
+ * \param[in] i the index of the cell.
+ * \param[out] c the class to restore into. */
+void cell_store::cell(int i,voronoicell &c) {
+	int np=unpack(i);
+	c.init_faces(np,&vd[0],vn.size(),&vi[0]);
+}
+
+/** Restores a stored cell into a voronoicell_neighbor class. If the cell was
+ * stored without neighbor information, then the neighbor IDs are set to zero.
+ * \param[in] i the index of the cell.
+ * \param[out] c the class to restore into. */
+void cell_store::cell(int i,voronoicell_neighbor &c) {
+	int np=unpack(i);
+	c.init_faces(np,&vd[0],vn.size(),&vi[0],&vn[0]);
+}
+
+/** Sums the volumes of all the stored cells.
+ * \return The computed volume. */
+double cell_store::sum_cell_volumes() {
+	double vol=0;
+	voronoicell c;
+	for(int i=0;i<n;i++) {
+		cell(i,c);
+		vol+=c.volume();
+	}
+	return vol;
+}
+
+/** Saves customized information about all of the stored cells, using the
+ * same format as the container::print_custom routine.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to. */
+void cell_store::print_custom(const char *format,FILE *fp) {
+	double x,y,z,r;
+	if(voro_base::contains_neighbor(format)) {
+		voronoicell_neighbor c;
+		for(int i=0;i<n;i++) {
+			cell(i,c);position(i,x,y,z,r);
+			c.output_custom(format,id(i),x,y,z,r,fp);
+		}
+	} else {
+		voronoicell c;
+		for(int i=0;i<n;i++) {
+			cell(i,c);position(i,x,y,z,r);
+			c.output_custom(format,id(i),x,y,z,r,fp);
+		}
+	}
+}
+
+/** Saves customized information about all of the stored cells.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to. */
+void cell_store::print_custom(const char *format,const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_custom(format,fp);
+	fclose(fp);
+}
+
+}
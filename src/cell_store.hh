@@ -0,0 +1,127 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file cell_store.hh
+ * \brief Header file for the cell_store class. */
+
+#ifndef VOROPP_CELL_STORE_HH
+#define VOROPP_CELL_STORE_HH
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "config.hh"
+#include "common.hh"
+#include "cell.hh"
+
+namespace voro {
+
+/** \brief A class for storing computed Voronoi cells in a compact form.
+ *
+ * When the same tessellation is queried several times, recomputing the cells
+ * each time through the compute_cell routine is wasteful. This class stores
+ * computed cells in a single memory arena, using a representation that is
+ * much smaller than the working memory of the voronoicell classes. For each
+ * cell, the vertex positions are quantized to 16-bit integers relative to the
+ * particle position, scaled by the largest vertex coordinate so that the
+ * error in each coordinate is at most 1/65534 of the cell size. The faces are
+ * stored as a vertex list, using one byte per entry when the cell has fewer
+ * than 256 vertices, followed by the neighbor IDs of the faces if they are
+ * available.
+ *
+ * A stored cell can be restored into a voronoicell or voronoicell_neighbor
+ * class, so that all of the usual statistics and output routines can be
+ * applied to it. */
+class cell_store {
+	public:
+		cell_store();
+		~cell_store();
+		void clear();
+		void store(voronoicell &c,int id,double x,double y,double z,double r=default_radius);
+		void store(voronoicell_neighbor &c,int id,double x,double y,double z,double r=default_radius);
+		/** Computes and stores the Voronoi cells of the particles
+		 * within a loop class.
+		 * \param[in] con the container class to use.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] neighbors whether to store the neighbor IDs of
+		 *                      the faces. */
+		template<class c_class,class c_loop>
+		void store(c_class &con,c_loop &vl,bool neighbors=true) {
+			double *pp;
+			if(neighbors) {
+				voronoicell_neighbor c(con);
+				if(vl.start()) do if(con.compute_cell(c,vl)) {
+					pp=con.p[vl.ijk]+con.ps*vl.q;
+					store(c,con.id[vl.ijk][vl.q],*pp,pp[1],pp[2],con.ps==4?pp[3]:default_radius);
+				} while(vl.inc());
+			} else {
+				voronoicell c(con);
+				if(vl.start()) do if(con.compute_cell(c,vl)) {
+					pp=con.p[vl.ijk]+con.ps*vl.q;
+					store(c,con.id[vl.ijk][vl.q],*pp,pp[1],pp[2],con.ps==4?pp[3]:default_radius);
+				} while(vl.inc());
+			}
+		}
+		/** Returns the number of stored cells.
+		 * \return The number of cells. */
+		inline int total_cells() {return n;}
+		/** Returns the number of bytes used to store the cells,
+		 * including the index.
+		 * \return The number of bytes. */
+		inline long memory_used() {return asz+n*long(sizeof(long));}
+		/** Returns the particle ID of a stored cell.
+		 * \param[in] i the index of the cell.
+		 * \return The particle ID. */
+		inline int id(int i) {
+			int pid;memcpy(&pid,ar+off[i],sizeof(int));
+			return pid;
+		}
+		void position(int i,double &x,double &y,double &z,double &r);
+		bool has_neighbors(int i);
+		void cell(int i,voronoicell &c);
+		void cell(int i,voronoicell_neighbor &c);
+		double sum_cell_volumes();
+		void print_custom(const char *format,FILE *fp=stdout);
+		void print_custom(const char *format,const char *filename);
+	private:
+		/** The number of stored cells. */
+		int n;
+		/** The current size of the index. */
+		int index_sz;
+		/** The index, holding the offset of each cell in the arena.
+		 */
+		long *off;
+		/** The memory arena holding the cells. */
+		char *ar;
+		/** The number of bytes used in the arena. */
+		long asz;
+		/** The current size of the arena in bytes. */
+		long arena_sz;
+		/** A scratch vector for the vertex positions. */
+		std::vector<double> vd;
+		/** A scratch vector for the face vertex list. */
+		std::vector<int> vi;
+		/** A scratch vector for the neighbor IDs. */
+		std::vector<int> vn;
+		void add(voronoicell_base &c,bool neighbors,int id,double x,double y,double z,double r);
+		int unpack(int i);
+		char* reserve(long b);
+		/** Writes a value to the arena, advancing a pointer.
+		 * \param[in,out] cp the pointer to write to.
+		 * \param[in] a the value to write. */
+		template<class T>
+		inline void put(char *&cp,T a) {
+			memcpy(cp,&a,sizeof(T));cp+=sizeof(T);
+		}
+		/** Reads a value from the arena, advancing a pointer.
+		 * \param[in,out] cp the pointer to read from.
+		 * \param[out] a the value that was read. */
+		template<class T>
+		inline void get(const char *&cp,T &a) {
+			memcpy(&a,cp,sizeof(T));cp+=sizeof(T);
+		}
+};
+
+}
+
+#endif
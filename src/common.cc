@@ -9,6 +9,12 @@
 
 #include "common.hh"
 
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#include <cstring>
+#endif
+
 namespace voro {
 
 void check_duplicate(int n,double x,double y,double z,int id,double *qp) {
@@ -135,4 +141,76 @@ void voro_print_face_vertices(std::vector<int> &v,FILE *fp) {
 	}
 }
 
+/** Finds the NUMA node that a CPU belongs to, by looking for a node entry in
+ * the CPU's directory in the Linux sysfs tree.
+ * \param[in] cpu the index of the CPU.
+ * \return The index of the node, or zero if it cannot be determined. */
+int voro_cpu_node(int cpu) {
+	int node=0;
+#ifdef __linux__
+	char buf[64];
+	sprintf(buf,"/sys/devices/system/cpu/cpu%d",cpu);
+	DIR *dp=opendir(buf);
+	if(dp==NULL) return 0;
+	struct dirent *ep;
+	while((ep=readdir(dp))!=NULL)
+		if(strncmp(ep->d_name,"node",4)==0&&sscanf(ep->d_name+4,"%d",&node)==1) break;
+	closedir(dp);
+#else
+	(void) cpu;
+#endif
+	return node;
+}
+
+/** Returns the CPU that the calling thread is currently running on.
+ * \return The index of the CPU, or zero if it cannot be determined. */
+int voro_current_cpu() {
+#ifdef __linux__
+	int cpu=sched_getcpu();
+	return cpu<0?0:cpu;
+#else
+	return 0;
+#endif
+}
+
+/** Pins each thread of the parallel routines to a single CPU, chosen from the
+ * CPUs that the process is allowed to run on. With OpenMP, the threads of a
+ * parallel region are kept for later regions with the same number of threads,
+ * so the pinning applies to all of the parallel routines that follow. The
+ * threads can either be spread evenly across the allowed CPUs, which places
+ * them on all of the sockets of a multi-socket machine, or packed onto
+ * consecutive CPUs. Pinning the threads is only supported on Linux, and the
+ * routine does nothing on other systems. Placement can also be controlled
+ * without code changes through the OMP_PROC_BIND and OMP_PLACES environment
+ * variables.
+ * \param[in] nt the number of threads, or zero to use the default.
+ * \param[in] spread whether to spread the threads evenly across the allowed
+ *                   CPUs, rather than packing them.
+ * \return The number of threads that were successfully pinned. */
+int voro_pin_threads(int nt,bool spread) {
+	int pinned=0;
+#ifdef __linux__
+	cpu_set_t cs;
+	std::vector<int> cpus;
+	if(nt<=0) nt=voro_max_threads();
+	if(sched_getaffinity(0,sizeof(cs),&cs)!=0) return 0;
+	for(int i=0;i<CPU_SETSIZE;i++) if(CPU_ISSET(i,&cs)) cpus.push_back(i);
+	int nc=cpus.size();
+	if(nc==0) return 0;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt) reduction(+:pinned)
+#endif
+	{
+		int t=voro_thread_num();
+		cpu_set_t ts;
+		CPU_ZERO(&ts);
+		CPU_SET(cpus[spread?(long(t)*nc/nt)%nc:t%nc],&ts);
+		if(sched_setaffinity(0,sizeof(ts),&ts)==0) pinned++;
+	}
+#else
+	(void) nt;(void) spread;
+#endif
+	return pinned;
+}
+
 }
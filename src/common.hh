@@ -14,6 +14,10 @@
 #include <cstdlib>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "config.hh"
 
 namespace voro {
@@ -26,6 +30,31 @@ FILE* safe_fopen(const char *filename,const char *mode);
 void voro_print_vector(std::vector<int> &v,FILE *fp=stdout);
 void voro_print_vector(std::vector<double> &v,FILE *fp=stdout);
 void voro_print_face_vertices(std::vector<int> &v,FILE *fp=stdout);
+int voro_cpu_node(int cpu);
+int voro_current_cpu();
+int voro_pin_threads(int nt=0,bool spread=true);
+
+/** Returns the number of threads that the parallel routines use by default.
+ * If the code is compiled without OpenMP, this is always one.
+ * \return The number of threads. */
+inline int voro_max_threads() {
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+/** Returns the index of the calling thread within a parallel region.
+ * \return The thread index, or zero if the code is compiled without OpenMP.
+ */
+inline int voro_thread_num() {
+#ifdef _OPENMP
+	return omp_get_thread_num();
+#else
+	return 0;
+#endif
+}
 
 }
 
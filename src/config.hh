@@ -37,6 +37,37 @@ const int init_wall_size=32;
 const int init_ordering_size=4096;
 /** The initial size of the pre_container chunk index. */
 const int init_chunk_size=256;
+/** The initial number of cells in the cell_store index. */
+const int init_store_cells=1024;
+/** The initial size in bytes of the cell_store arena. */
+const int init_store_bytes=262144;
+/** The initial half-width, in blocks, of the window used by the voro_compute
+ * search mask. This must be at least three, so that the window covers all of
+ * the blocks on the worklists and their neighbors. */
+const int init_mask_window=4;
+/** The number of vertices that are tested at a time when a cell is checked
+ * against a group of planes. Each run is tested against all of the planes
+ * before moving on to the next, so that an intersection found near the start
+ * of the vertex list ends the test early. */
+const int plane_test_run=16;
+/** When particle records are added to an ordering from a list of IDs, a
+ * direct lookup table is used if the largest ID is less than four times the
+ * number of particles plus this value, and a hash table is used otherwise. */
+const int order_id_slack=1024;
+/** The number of particles in each batch when the cells in an ordering are
+ * computed in parallel. The output for a batch is buffered in memory, and is
+ * written once the whole batch has been computed. */
+const int order_batch_size=16384;
+/** The number of consecutive particles that a thread takes at a time when the
+ * cells in an ordering are computed in parallel. */
+const int order_chunk_size=16;
+/** When particles are added to an ID index, a direct lookup table is used if
+ * all of the IDs are non-negative and less than four times the number of
+ * particles plus this value, and a hash table is used otherwise. */
+const int index_id_slack=1024;
+/** The approximate size in bytes of the chunks that a text file is split into
+ * when it is parsed in parallel by the text_parser class. */
+const int parse_chunk_size=1<<20;
 
 // If the initial memory is too small, the program dynamically allocates more.
 // However, if the limits below are reached, then the program bails out.
@@ -60,10 +91,34 @@ const int max_wall_size=2048;
 const int max_ordering_size=67108864;
 /** The maximum size for the pre_container chunk index. */
 const int max_chunk_size=65536;
+/** The maximum number of cells in the cell_store index. */
+const int max_store_cells=268435456;
 
 /** The chunk size in the pre_container classes. */
 const int pre_container_chunk_size=1024;
 
+/** The number of records read at a time by the binary particle stream. */
+const int roi_stream_records=4096;
+
+/** The initial halo width used by the container_roi class if none is given,
+ * in units of the mean interparticle spacing. */
+const double roi_init_halo=3.;
+
+/** The number of values stored for each cell by the minkowski_tensors()
+ * routine. */
+const int minkowski_tensor_size=45;
+
+/** The number of nearest particles stored for each particle by the
+ * restricted_voronoi class. Longer lists are found when needed. */
+const int restricted_neighbors=24;
+
+/** The distance, relative to the size of the container, within which a vertex
+ * of a clipped triangle is taken to lie on a bisecting plane by the
+ * restricted_voronoi class. Polygons that touch a bisecting plane cause the
+ * particle on the other side to be searched, so this errs on the side of being
+ * large. */
+const double restricted_tolerance=1e-9;
+
 #ifndef VOROPP_VERBOSE
 /** Voro++ can print a number of different status and debugging messages to
  * notify the user of special behavior, and this macro sets the amount which
@@ -11,6 +11,96 @@
 
 namespace voro {
 
+/** The class constructor sets up an empty index. */
+id_index::id_index() : n(0), sz(0), lo(0), hi(-1), dn(0), hashed(false) {}
+
+/** The class destructor frees the dynamically allocated memory. */
+id_index::~id_index() {
+	if(dn!=0) delete [] dn;
+}
+
+/** Removes all of the records from the index. The direct lookup table is kept
+ * for reuse. */
+void id_index::clear() {
+	for(int *dp=dn;dp<dn+2*sz;dp++) *dp=-1;
+	hm.clear();
+	n=0;lo=0;hi=-1;hashed=false;
+}
+
+/** Adds a particle to the index. If the ID is negative, or too large for the
+ * direct lookup table to be reasonably dense, then the records are moved to
+ * the hash table. Since the IDs may arrive in any order, the records are moved
+ * back to the direct lookup table once enough particles have been added for
+ * it to be dense again. To avoid switching back and forth, the table is left
+ * when it would be eight times larger than the number of particles, but is
+ * only returned to when it would be four times larger.
+ * \param[in] pid the ID of the particle.
+ * \param[in] (ijk,q) the block and the index of the particle within the
+ *                    block. */
+void id_index::add(int pid,int ijk,int q) {
+	if(!hashed) {
+		if(pid<0||pid>=((n+1)<<3)+index_id_slack) switch_to_hash();
+		else {
+			if(pid>=sz) grow(pid);
+			int *dp=dn+(pid<<1);
+			if(*dp==-1) {
+				*dp=ijk;dp[1]=q;n++;
+				if(pid>hi) hi=pid;
+			}
+			return;
+		}
+	}
+	if(hm.insert(std::make_pair(pid,std::make_pair(ijk,q))).second) {
+		n++;
+		if(pid<lo) lo=pid;
+		if(pid>hi) hi=pid;
+		if(lo>=0&&hi<(n<<2)+index_id_slack) switch_to_table();
+	}
+}
+
+/** Extends the direct lookup table so that it covers a given ID.
+ * \param[in] pid the ID to cover. */
+void id_index::grow(int pid) {
+	int nsz=sz==0?index_id_slack:sz<<1,*dp;
+	while(nsz<=pid) nsz<<=1;
+#if VOROPP_VERBOSE >=3
+	fprintf(stderr,"ID index scaled up to %d\n",nsz);
+#endif
+	int *ndn=new int[nsz<<1];
+	for(dp=ndn;dp<ndn+2*sz;dp++) *dp=dn[dp-ndn];
+	for(;dp<ndn+2*nsz;dp++) *dp=-1;
+	if(dn!=0) delete [] dn;
+	dn=ndn;sz=nsz;
+}
+
+/** Moves all of the records from the direct lookup table to the hash table.
+ */
+void id_index::switch_to_hash() {
+#if VOROPP_VERBOSE >=3
+	fprintf(stderr,"ID index switched to a hash table\n");
+#endif
+	hm.reserve(n<<1);
+	for(int i=0;i<=hi;i++) if(dn[i<<1]!=-1) {
+		hm.insert(std::make_pair(i,std::make_pair(dn[i<<1],dn[(i<<1)+1])));
+		dn[i<<1]=-1;
+	}
+	hashed=true;
+}
+
+/** Moves all of the records from the hash table to the direct lookup table. */
+void id_index::switch_to_table() {
+#if VOROPP_VERBOSE >=3
+	fprintf(stderr,"ID index switched to a direct lookup table\n");
+#endif
+	if(hi>=sz) grow(hi);
+	for(std::unordered_map<int,std::pair<int,int> >::iterator it=hm.begin();it!=hm.end();it++) {
+		int *dp=dn+(it->first<<1);
+		*dp=it->second.first;dp[1]=it->second.second;
+	}
+	hm.clear();
+	hashed=false;
+}
+
 /** The class constructor sets up the geometry of container, initializing the
  * minimum and maximum coordinates in each direction, and setting whether each
  * direction is periodic or not. It divides the container into a rectangular
@@ -34,7 +124,7 @@ container_base::container_base(double ax_,double bx_,double ay_,double by_,doubl
 	max_len_sq((bx-ax)*(bx-ax)*(xperiodic_?0.25:1)+(by-ay)*(by-ay)*(yperiodic_?0.25:1)
 		  +(bz-az)*(bz-az)*(zperiodic_?0.25:1)),
 	xperiodic(xperiodic_), yperiodic(yperiodic_), zperiodic(zperiodic_),
-	id(new int*[nxyz]), p(new double*[nxyz]), co(new int[nxyz]), mem(new int[nxyz]), ps(ps_) {
+	id(new int*[nxyz]), p(new double*[nxyz]), co(new int[nxyz]), mem(new int[nxyz]), ps(ps_), idx(0) {
 
 	int l;
 	for(l=0;l<nxyz;l++) co[l]=0;
@@ -43,9 +133,23 @@ container_base::container_base(double ax_,double bx_,double ay_,double by_,doubl
 	for(l=0;l<nxyz;l++) p[l]=new double[ps*init_mem];
 }
 
+/** The move constructor takes over the particle storage and walls of another
+ * container. The other container is left without any particle storage, and
+ * may only be destroyed.
+ * \param[in] cb the container to move from. */
+container_base::container_base(container_base &&cb) noexcept
+	: voro_base(std::move(cb)), wall_list(std::move(cb)),
+	ax(cb.ax), bx(cb.bx), ay(cb.ay), by(cb.by), az(cb.az), bz(cb.bz),
+	max_len_sq(cb.max_len_sq), xperiodic(cb.xperiodic), yperiodic(cb.yperiodic),
+	zperiodic(cb.zperiodic), id(cb.id), p(cb.p), co(cb.co), mem(cb.mem), ps(cb.ps), idx(cb.idx) {
+	cb.id=0;cb.p=0;cb.co=cb.mem=0;cb.idx=0;
+}
+
 /** The container destructor frees the dynamically allocated memory. */
 container_base::~container_base() {
 	int l;
+	if(p==0) return;
+	if(idx!=0) delete idx;
 	for(l=0;l<nxyz;l++) delete [] p[l];
 	for(l=0;l<nxyz;l++) delete [] id[l];
 	delete [] id;
@@ -84,6 +188,20 @@ container_poly::container_poly(double ax_,double bx_,double ay_,double by_,doubl
 	: container_base(ax_,bx_,ay_,by_,az_,bz_,nx_,ny_,nz_,xperiodic_,yperiodic_,zperiodic_,init_mem,4),
 	vc(*this,xperiodic_?2*nx_+1:nx_,yperiodic_?2*ny_+1:ny_,zperiodic_?2*nz_+1:nz_) {ppr=p;}
 
+/** The move constructor takes over the particles of another container, and
+ * rebinds the computation class to this container.
+ * \param[in] c the container to move from. */
+container::container(container &&c) noexcept
+	: container_base(std::move(c)), vc(*this,std::move(c.vc)) {}
+
+/** The move constructor takes over the particles of another container, and
+ * rebinds the computation class to this container.
+ * \param[in] c the container to move from. */
+container_poly::container_poly(container_poly &&c) noexcept
+	: container_base(std::move(c)), vc(*this,std::move(c.vc)) {
+	ppr=p;max_radius=c.max_radius;
+}
+
 /** Put a particle into the correct region of the container.
  * \param[in] n the numerical ID of the inserted particle.
  * \param[in] (x,y,z) the position vector of the inserted particle. */
@@ -91,6 +209,7 @@ void container::put(int n,double x,double y,double z) {
 	int ijk;
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
+		if(idx!=0) idx->add(n,ijk,co[ijk]);
 		double *pp=p[ijk]+3*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*pp=z;
 	}
@@ -104,6 +223,7 @@ void container_poly::put(int n,double x,double y,double z,double r) {
 	int ijk;
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
+		if(idx!=0) idx->add(n,ijk,co[ijk]);
 		double *pp=p[ijk]+4*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
 		if(max_radius<r) max_radius=r;
@@ -120,6 +240,7 @@ void container::put(particle_order &vo,int n,double x,double y,double z) {
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
 		vo.add(ijk,co[ijk]);
+		if(idx!=0) idx->add(n,ijk,co[ijk]);
 		double *pp=p[ijk]+3*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*pp=z;
 	}
@@ -136,6 +257,7 @@ void container_poly::put(particle_order &vo,int n,double x,double y,double z,dou
 	if(put_locate_block(ijk,x,y,z)) {
 		id[ijk][co[ijk]]=n;
 		vo.add(ijk,co[ijk]);
+		if(idx!=0) idx->add(n,ijk,co[ijk]);
 		double *pp=p[ijk]+4*co[ijk]++;
 		*(pp++)=x;*(pp++)=y;*(pp++)=z;*pp=r;
 		if(max_radius<r) max_radius=r;
@@ -375,6 +497,174 @@ void container_poly::import(particle_order &vo,FILE *fp) {
 	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
 }
 
+/** Adds a list of particles to the container. The positions are copied and
+ * remapped into the primary domain in parallel, and the number of particles
+ * going into each block is counted so that the memory of each block only needs
+ * to be enlarged once. The particles are then stored serially, in the order
+ * that they are listed, so that the container, the ordering class and the ID
+ * index are the same as if the particles had been added individually.
+ * Particles outside the container are skipped.
+ * \param[in] m the number of particles.
+ * \param[in] nid the particle IDs.
+ * \param[in] pp the particle positions, followed by the radii if the
+ *               container stores them, so that there are ps values per
+ *               particle.
+ * \param[in,out] vo an ordering class in which to record the particles, or
+ *                   NULL if one is not needed.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \return The maximum radius of the particles that were stored, or zero if
+ *         the container does not store radii. */
+double container_base::bulk_insert(int m,const int *nid,const double *pp,particle_order *vo,int nt) {
+	int i,ijk;
+	double *qp,rm=0;
+	if(nt<=0) nt=voro_max_threads();
+
+	// Find the block of each particle in parallel
+	std::vector<int> bl(m);
+	std::vector<double> rp(3*long(m));
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+	for(i=0;i<m;i++) {
+		double x=pp[long(ps)*i],y=pp[long(ps)*i+1],z=pp[long(ps)*i+2];
+		if(put_remap(bl[i],x,y,z)) {
+			rp[3*long(i)]=x;rp[3*long(i)+1]=y;rp[3*long(i)+2]=z;
+		} else bl[i]=-1;
+	}
+
+	// Count the particles going into each block, and allocate the
+	// memory for them
+	std::vector<int> cnt(nxyz,0);
+	for(i=0;i<m;i++) if(bl[i]>=0) cnt[bl[i]]++;
+	for(ijk=0;ijk<nxyz;ijk++) while(co[ijk]+cnt[ijk]>mem[ijk]) add_particle_memory(ijk);
+
+	// Store the particles in order
+	for(i=0;i<m;i++) {
+		if((ijk=bl[i])<0) {
+#if VOROPP_REPORT_OUT_OF_BOUNDS ==1
+			fprintf(stderr,"Out of bounds: (x,y,z)=(%g,%g,%g)\n",pp[long(ps)*i],pp[long(ps)*i+1],pp[long(ps)*i+2]);
+#endif
+			continue;
+		}
+		id[ijk][co[ijk]]=nid[i];
+		if(vo!=NULL) vo->add(ijk,co[ijk]);
+		if(idx!=0) idx->add(nid[i],ijk,co[ijk]);
+		qp=p[ijk]+ps*co[ijk]++;
+		*qp=rp[3*long(i)];qp[1]=rp[3*long(i)+1];qp[2]=rp[3*long(i)+2];
+		if(ps==4) {
+			qp[3]=pp[4*long(i)+3];
+			if(rm<qp[3]) rm=qp[3];
+		}
+	}
+	return rm;
+}
+
+/** Imports a list of particles from an open file stream into the container,
+ * using the text_parser class to read the file in parallel. Entries of four
+ * numbers (Particle ID, x position, y position, z position) are searched for.
+ * If the file cannot be successfully read, then the routine causes a fatal
+ * error.
+ * \param[in] fp the file handle to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container::import_parallel(FILE *fp,int nt) {
+	text_parser tp(4);
+	if(!tp.parse(fp,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),NULL,nt);
+}
+
+/** Imports a list of particles from an open file stream into the container
+ * in parallel, also storing the order that the particles are read. Entries of
+ * four numbers (Particle ID, x position, y position, z position) are searched
+ * for. If the file cannot be successfully read, then the routine causes a
+ * fatal error.
+ * \param[in,out] vo a reference to an ordering class to use.
+ * \param[in] fp the file handle to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container::import_parallel(particle_order &vo,FILE *fp,int nt) {
+	text_parser tp(4);
+	if(!tp.parse(fp,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),&vo,nt);
+}
+
+/** Imports a list of particles from a file into the container in parallel.
+ * The file is mapped into memory if possible. Entries of four numbers
+ * (Particle ID, x position, y position, z position) are searched for. If the
+ * file cannot be successfully read, then the routine causes a fatal error.
+ * \param[in] filename the name of the file to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container::import_parallel(const char* filename,int nt) {
+	text_parser tp(4);
+	if(!tp.parse(filename,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),NULL,nt);
+}
+
+/** Imports a list of particles from a file into the container in parallel,
+ * also storing the order that the particles are read. Entries of four numbers
+ * (Particle ID, x position, y position, z position) are searched for. If the
+ * file cannot be successfully read, then the routine causes a fatal error.
+ * \param[in,out] vo a reference to an ordering class to use.
+ * \param[in] filename the name of the file to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container::import_parallel(particle_order &vo,const char* filename,int nt) {
+	text_parser tp(4);
+	if(!tp.parse(filename,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),&vo,nt);
+}
+
+/** Imports a list of particles from an open file stream into the container,
+ * using the text_parser class to read the file in parallel. Entries of five
+ * numbers (Particle ID, x position, y position, z position, radius) are
+ * searched for. If the file cannot be successfully read, then the routine
+ * causes a fatal error.
+ * \param[in] fp the file handle to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container_poly::import_parallel(FILE *fp,int nt) {
+	text_parser tp(5);
+	if(!tp.parse(fp,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),NULL,nt);
+}
+
+/** Imports a list of particles from an open file stream into the container
+ * in parallel, also storing the order that the particles are read. Entries of
+ * five numbers (Particle ID, x position, y position, z position, radius) are
+ * searched for. If the file cannot be successfully read, then the routine
+ * causes a fatal error.
+ * \param[in,out] vo a reference to an ordering class to use.
+ * \param[in] fp the file handle to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container_poly::import_parallel(particle_order &vo,FILE *fp,int nt) {
+	text_parser tp(5);
+	if(!tp.parse(fp,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),&vo,nt);
+}
+
+/** Imports a list of particles from a file into the container in parallel.
+ * The file is mapped into memory if possible. Entries of five numbers
+ * (Particle ID, x position, y position, z position, radius) are searched for.
+ * If the file cannot be successfully read, then the routine causes a fatal
+ * error.
+ * \param[in] filename the name of the file to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container_poly::import_parallel(const char* filename,int nt) {
+	text_parser tp(5);
+	if(!tp.parse(filename,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),NULL,nt);
+}
+
+/** Imports a list of particles from a file into the container in parallel,
+ * also storing the order that the particles are read. Entries of five numbers
+ * (Particle ID, x position, y position, z position, radius) are searched for.
+ * If the file cannot be successfully read, then the routine causes a fatal
+ * error.
+ * \param[in,out] vo a reference to an ordering class to use.
+ * \param[in] filename the name of the file to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container_poly::import_parallel(particle_order &vo,const char* filename,int nt) {
+	text_parser tp(5);
+	if(!tp.parse(filename,nt)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	put_bulk(tp.n,tp.id.data(),tp.v.data(),&vo,nt);
+}
+
 /** Outputs the a list of all the container regions along with the number of
  * particles stored within each. */
 void container_base::region_count() {
@@ -383,15 +673,83 @@ void container_base::region_count() {
 		printf("Region (%d,%d,%d): %d particles\n",i,j,k,*(cop++));
 }
 
+/** Reallocates the particle memory of every block from within a parallel
+ * region, so that on a NUMA machine each block is placed on the memory node
+ * of the thread that touches it first. The blocks are divided between the
+ * threads using the same static schedule as the compute_all_parallel
+ * routine, so that when that routine is run with the same number of threads,
+ * each thread mostly reads particles from its local memory. This should be
+ * called once all of the particles have been added, since blocks that later
+ * need more memory are reallocated by the thread adding the particles.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void container_base::first_touch(int nt) {
+	if(nt<=0) nt=voro_max_threads();
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+	for(int ijk=0;ijk<nxyz;ijk++) {
+		int l,*idp=new int[mem[ijk]];
+		double *pp=new double[ps*mem[ijk]];
+		for(l=0;l<co[ijk];l++) idp[l]=id[ijk][l];
+		for(l=0;l<ps*co[ijk];l++) pp[l]=p[ijk][l];
+		delete [] id[ijk];id[ijk]=idp;
+		delete [] p[ijk];p[ijk]=pp;
+	}
+}
+
+/** Enables the ID index, so that particles can be located by their IDs in
+ * constant time. The index is built from the particles that are currently in
+ * the container, and is then kept up to date as particles are added or the
+ * container is cleared. */
+void container_base::enable_id_index() {
+	if(idx!=0) delete idx;
+	idx=new id_index;
+	for(int ijk=0;ijk<nxyz;ijk++) for(int q=0;q<co[ijk];q++) idx->add(id[ijk][q],ijk,q);
+}
+
+/** Disables the ID index, freeing its memory. */
+void container_base::disable_id_index() {
+	if(idx!=0) {delete idx;idx=0;}
+}
+
+/** Locates a particle with a given ID. If the ID index has been enabled, then
+ * this takes constant time, and otherwise the container is scanned.
+ * \param[in] pid the ID of the particle.
+ * \param[out] (ijk,q) the block and the index of the particle within the
+ *                     block.
+ * \return True if the particle was found, false otherwise. */
+bool container_base::find_particle(int pid,int &ijk,int &q) {
+	if(idx!=0) return idx->find(pid,ijk,q);
+	for(ijk=0;ijk<nxyz;ijk++) for(q=0;q<co[ijk];q++) if(id[ijk][q]==pid) return true;
+	return false;
+}
+
+/** Looks up the position of a particle with a given ID. This can be used to
+ * find the positions of the neighbors of a Voronoi cell from the IDs returned
+ * by the voronoicell_neighbor::neighbors routine. For a periodic container,
+ * the position is that of the particle in the primary domain.
+ * \param[in] pid the ID of the particle.
+ * \param[out] (x,y,z) the position of the particle.
+ * \return True if the particle was found, false otherwise. */
+bool container_base::particle_position(int pid,double &x,double &y,double &z) {
+	int ijk,q;
+	if(!find_particle(pid,ijk,q)) return false;
+	double *pp=p[ijk]+ps*q;
+	x=*pp;y=pp[1];z=pp[2];
+	return true;
+}
+
 /** Clears a container of particles. */
 void container::clear() {
 	for(int *cop=co;cop<co+nxyz;cop++) *cop=0;
+	if(idx!=0) idx->clear();
 }
 
 /** Clears a container of particles, also clearing resetting the maximum radius
  * to zero. */
 void container_poly::clear() {
 	for(int *cop=co;cop<co+nxyz;cop++) *cop=0;
+	if(idx!=0) idx->clear();
 	max_radius=0;
 }
 
@@ -421,6 +779,16 @@ void container::print_custom(const char *format,const char *filename) {
 	fclose(fp);
 }
 
+/** Computes all the Voronoi cells and saves customized information about
+ * them, measuring the cost of each cell computation.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to.
+ * \param[in] cp the profiler to record the costs in. */
+void container::print_custom(const char *format,FILE *fp,cell_profiler &cp) {
+	c_loop_all vl(*this);
+	print_custom(vl,format,fp,cp);
+}
+
 /** Computes all the Voronoi cells and saves customized
  * information about them
  * \param[in] format the custom output string to use.
@@ -431,6 +799,16 @@ void container_poly::print_custom(const char *format,const char *filename) {
 	fclose(fp);
 }
 
+/** Computes all the Voronoi cells and saves customized information about
+ * them, measuring the cost of each cell computation.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to.
+ * \param[in] cp the profiler to record the costs in. */
+void container_poly::print_custom(const char *format,FILE *fp,cell_profiler &cp) {
+	c_loop_all vl(*this);
+	print_custom(vl,format,fp,cp);
+}
+
 /** Computes all of the Voronoi cells in the container, but does nothing
  * with the output. It is useful for measuring the pure computation time
  * of the Voronoi algorithm, without any additional calculations such as
@@ -442,6 +820,16 @@ void container::compute_all_cells() {
 	while(vl.inc());
 }
 
+/** Computes all of the Voronoi cells in the container, measuring the cost of
+ * each cell computation, but does nothing else with the output.
+ * \param[in] cp the profiler to record the costs in. */
+void container::compute_all_cells(cell_profiler &cp) {
+	voronoicell c(*this);
+	c_loop_all vl(*this);
+	if(vl.start()) do cp.compute_cell(*this,c,vl);
+	while(vl.inc());
+}
+
 /** Computes all of the Voronoi cells in the container, but does nothing
  * with the output. It is useful for measuring the pure computation time
  * of the Voronoi algorithm, without any additional calculations such as
@@ -452,6 +840,15 @@ void container_poly::compute_all_cells() {
 	if(vl.start()) do compute_cell(c,vl);while(vl.inc());
 }
 
+/** Computes all of the Voronoi cells in the container, measuring the cost of
+ * each cell computation, but does nothing else with the output.
+ * \param[in] cp the profiler to record the costs in. */
+void container_poly::compute_all_cells(cell_profiler &cp) {
+	voronoicell c(*this);
+	c_loop_all vl(*this);
+	if(vl.start()) do cp.compute_cell(*this,c,vl);while(vl.inc());
+}
+
 /** Calculates all of the Voronoi cells and sums their volumes. In most cases
  * without walls, the sum of the Voronoi cell volumes should equal the volume
  * of the container to numerical precision.
@@ -520,6 +917,15 @@ void container_base::draw_domain_pov(FILE *fp) {
 wall_list::wall_list() : walls(new wall*[init_wall_size]), wep(walls), wel(walls+init_wall_size),
 	current_wall_size(init_wall_size) {}
 
+/** The move constructor takes over the array of wall pointers from another
+ * wall_list. The other list is left empty.
+ * \param[in] wl the wall_list to move from. */
+wall_list::wall_list(wall_list &&wl) noexcept : walls(wl.walls), wep(wl.wep), wel(wl.wel),
+	current_wall_size(wl.current_wall_size) {
+	wl.walls=wl.wep=wl.wel=0;
+	wl.current_wall_size=0;
+}
+
 /** The wall_list destructor frees the array of pointers to the wall classes.
  */
 wall_list::~wall_list() {
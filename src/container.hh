@@ -12,6 +12,8 @@
 
 #include <cstdio>
 #include <vector>
+#include <utility>
+#include <unordered_map>
 
 #include "config.hh"
 #include "common.hh"
@@ -20,6 +22,8 @@
 #include "c_loops.hh"
 #include "v_compute.hh"
 #include "rad_option.hh"
+#include "cell_profiler.hh"
+#include "text_parser.hh"
 
 namespace voro {
 
@@ -57,6 +61,7 @@ class wall_list {
 		 */
 		wall **wep;
 		wall_list();
+		wall_list(wall_list &&wl) noexcept;
 		~wall_list();
 		/** Adds a wall to the list.
 		 * \param[in] w the wall to add. */
@@ -97,6 +102,69 @@ class wall_list {
 		int current_wall_size;
 };
 
+/** \brief A class for locating particles in a container by their IDs.
+ *
+ * The particles in a container are only stored in the per-block arrays, so
+ * finding a particle with a given ID would otherwise require a scan over the
+ * whole container. This class records the block and the index within the
+ * block of each particle as it is stored. If the IDs are non-negative and
+ * compact, then the records are held in a direct lookup table indexed by the
+ * ID. While the IDs are sparse, or if any of them are negative, the records are
+ * held in a hash table instead. If several particles share the same ID, then
+ * the first one to be added is recorded. */
+class id_index {
+	public:
+		id_index();
+		~id_index();
+		void clear();
+		void add(int pid,int ijk,int q);
+		/** Looks up the location of a particle.
+		 * \param[in] pid the ID of the particle.
+		 * \param[out] (ijk,q) the block and the index of the particle
+		 *                     within the block.
+		 * \return True if the particle was found, false otherwise. */
+		inline bool find(int pid,int &ijk,int &q) const {
+			if(hashed) {
+				std::unordered_map<int,std::pair<int,int> >::const_iterator it=hm.find(pid);
+				if(it==hm.end()) return false;
+				ijk=it->second.first;q=it->second.second;
+			} else {
+				if(pid<0||pid>=sz||dn[pid<<1]==-1) return false;
+				ijk=dn[pid<<1];q=dn[(pid<<1)+1];
+			}
+			return true;
+		}
+		/** Returns the number of particles in the index.
+		 * \return The number of particles. */
+		inline int total() const {return n;}
+		/** Returns whether the records are held in a hash table.
+		 * \return True if a hash table is used, false if a direct
+		 *         lookup table is used. */
+		inline bool is_hashed() const {return hashed;}
+	private:
+		/** The number of particles in the index. */
+		int n;
+		/** The number of IDs covered by the direct lookup table. */
+		int sz;
+		/** The smallest ID in the index, or zero if none of the IDs
+		 * are negative. */
+		int lo;
+		/** The largest ID in the index. */
+		int hi;
+		/** The direct lookup table, holding the block and the index
+		 * within the block for each ID, or -1 for IDs that are not
+		 * present. */
+		int *dn;
+		/** Whether the records are held in the hash table rather than
+		 * the direct lookup table. */
+		bool hashed;
+		/** The hash table of records, used when the IDs are sparse. */
+		std::unordered_map<int,std::pair<int,int> > hm;
+		void grow(int pid);
+		void switch_to_hash();
+		void switch_to_table();
+};
+
 /** \brief Class for representing a particle system in a three-dimensional
  * rectangular box.
  *
@@ -161,12 +229,22 @@ class container_base : public voro_base, public wall_list {
 		 * class container_poly, then this is set to 4, to also hold
 		 * the particle radii. */
 		const int ps;
+		/** An optional index for locating particles by their IDs. This
+		 * is zero unless it has been enabled using the
+		 * enable_id_index() function. */
+		id_index *idx;
 		container_base(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
 				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,
 				int init_mem,int ps_);
+		container_base(container_base &&cb) noexcept;
 		~container_base();
 		bool point_inside(double x,double y,double z);
 		void region_count();
+		void first_touch(int nt=0);
+		void enable_id_index();
+		void disable_id_index();
+		bool find_particle(int pid,int &ijk,int &q);
+		bool particle_position(int pid,double &x,double &y,double &z);
 		/** Initializes the Voronoi cell prior to a compute_cell
 		 * operation for a specific particle being carried out by a
 		 * voro_compute class. The cell is initialized to fill the
@@ -217,6 +295,16 @@ class container_base : public voro_base, public wall_list {
 			k=zperiodic?nz:ck;
 			disp=ijk-i-nx*(j+ny*k);
 		}
+		/** Computes the vector from a given position to a particle
+		 * stored in the container. This is used by the voro_compute
+		 * template to test the particles in a block.
+		 * \param[in] (ijk,q) the block and index of the particle.
+		 * \param[in] (x,y,z) the position to measure from.
+		 * \param[out] (dx,dy,dz) the vector to the particle. */
+		inline void rel_pos(int ijk,int q,double x,double y,double z,double &dx,double &dy,double &dz) {
+			double *pp=p[ijk]+ps*q;
+			dx=*pp-x;dy=pp[1]-y;dz=pp[2]-z;
+		}
 		/** Returns the position of a particle currently being computed
 		 * relative to the computational block that it is within. It is
 		 * used to select the optimal worklist entry to use.
@@ -274,6 +362,7 @@ class container_base : public voro_base, public wall_list {
 		}
 	protected:
 		void add_particle_memory(int i);
+		double bulk_insert(int m,const int *nid,const double *pp,particle_order *vo,int nt);
 		bool put_locate_block(int &ijk,double &x,double &y,double &z);
 		inline bool put_remap(int &ijk,double &x,double &y,double &z);
 		inline bool remap(int &ai,int &aj,int &ak,int &ci,int &cj,int &ck,double &x,double &y,double &z,int &ijk);
@@ -289,11 +378,31 @@ class container : public container_base, public radius_mono {
 	public:
 		container(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
 				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,int init_mem);
+		container(container &&c) noexcept;
 		void clear();
 		void put(int n,double x,double y,double z);
 		void put(particle_order &vo,int n,double x,double y,double z);
 		void import(FILE *fp=stdin);
 		void import(particle_order &vo,FILE *fp=stdin);
+		/** Adds a list of particles to the container. The blocks of
+		 * the particles are found in parallel, and the memory of each
+		 * block is enlarged once, before the particles are stored in
+		 * the order that they are listed. This gives the same result
+		 * as calling put() for each particle in turn.
+		 * \param[in] m the number of particles.
+		 * \param[in] nid the particle IDs.
+		 * \param[in] pp the particle positions, three per particle.
+		 * \param[in,out] vo an ordering class in which to record the
+		 *                   particles, or NULL if one is not needed.
+		 * \param[in] nt the number of threads to use, or zero to use
+		 *               the default. */
+		inline void put_bulk(int m,const int *nid,const double *pp,particle_order *vo=NULL,int nt=0) {
+			bulk_insert(m,nid,pp,vo,nt);
+		}
+		void import_parallel(FILE *fp=stdin,int nt=0);
+		void import_parallel(particle_order &vo,FILE *fp=stdin,int nt=0);
+		void import_parallel(const char* filename,int nt=0);
+		void import_parallel(particle_order &vo,const char* filename,int nt=0);
 		/** Imports a list of particles from an open file stream into
 		 * the container. Entries of four numbers (Particle ID, x
 		 * position, y position, z position) are searched for. If the
@@ -321,6 +430,7 @@ class container : public container_base, public radius_mono {
 			fclose(fp);
 		}
 		void compute_all_cells();
+		void compute_all_cells(cell_profiler &cp);
 		double sum_cell_volumes();
 		/** Dumps particle IDs and positions to a file.
 		 * \param[in] vl the loop class to use.
@@ -448,8 +558,32 @@ class container : public container_base, public radius_mono {
 				} while(vl.inc());
 			}
 		}
+		/** Computes the Voronoi cells and saves customized information
+		 * about them, measuring the cost of each cell computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] format the custom output string to use.
+		 * \param[in] fp a file handle to write to.
+		 * \param[in] cp the profiler to record the costs in. */
+		template<class c_loop>
+		void print_custom(c_loop &vl,const char *format,FILE *fp,cell_profiler &cp) {
+			int ijk,q;double *pp;
+			if(contains_neighbor(format)) {
+				voronoicell_neighbor c(*this);
+				if(vl.start()) do if(cp.compute_cell(*this,c,vl)) {
+					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
+					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],default_radius,fp);
+				} while(vl.inc());
+			} else {
+				voronoicell c(*this);
+				if(vl.start()) do if(cp.compute_cell(*this,c,vl)) {
+					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
+					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],default_radius,fp);
+				} while(vl.inc());
+			}
+		}
 		void print_custom(const char *format,FILE *fp=stdout);
 		void print_custom(const char *format,const char *filename);
+		void print_custom(const char *format,FILE *fp,cell_profiler &cp);
 		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid);
 		/** Computes the Voronoi cell for a particle currently being
 		 * referenced by a loop class.
@@ -476,6 +610,21 @@ class container : public container_base, public radius_mono {
 			int k=ijk/nxy,ijkt=ijk-nxy*k,j=ijkt/nx,i=ijkt-j*nx;
 			return vc.compute_cell(c,ijk,q,i,j,k);
 		}
+		/** Computes the Voronoi cell for a particle with a given ID.
+		 * If the ID index has been enabled, the particle is located in
+		 * constant time, and otherwise the container is scanned.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] pid the ID of the particle.
+		 * \return True if the cell was computed. If the particle is
+		 * not in the container, or if the cell is removed entirely by
+		 * a wall or boundary condition, then the routine returns
+		 * false. */
+		template<class v_cell>
+		inline bool compute_cell_by_id(v_cell &c,int pid) {
+			int ijk,q;
+			return find_particle(pid,ijk,q)&&compute_cell(c,ijk,q);
+		}
 		/** Computes the Voronoi cell for a ghost particle at a given
 		 * location.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -511,11 +660,33 @@ class container_poly : public container_base, public radius_poly {
 	public:
 		container_poly(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
 				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,int init_mem);
+		container_poly(container_poly &&c) noexcept;
 		void clear();
 		void put(int n,double x,double y,double z,double r);
 		void put(particle_order &vo,int n,double x,double y,double z,double r);
 		void import(FILE *fp=stdin);
 		void import(particle_order &vo,FILE *fp=stdin);
+		/** Adds a list of particles to the container. The blocks of
+		 * the particles are found in parallel, and the memory of each
+		 * block is enlarged once, before the particles are stored in
+		 * the order that they are listed. This gives the same result
+		 * as calling put() for each particle in turn.
+		 * \param[in] m the number of particles.
+		 * \param[in] nid the particle IDs.
+		 * \param[in] pp the particle positions and radii, four per
+		 *               particle.
+		 * \param[in,out] vo an ordering class in which to record the
+		 *                   particles, or NULL if one is not needed.
+		 * \param[in] nt the number of threads to use, or zero to use
+		 *               the default. */
+		inline void put_bulk(int m,const int *nid,const double *pp,particle_order *vo=NULL,int nt=0) {
+			double r=bulk_insert(m,nid,pp,vo,nt);
+			if(max_radius<r) max_radius=r;
+		}
+		void import_parallel(FILE *fp=stdin,int nt=0);
+		void import_parallel(particle_order &vo,FILE *fp=stdin,int nt=0);
+		void import_parallel(const char* filename,int nt=0);
+		void import_parallel(particle_order &vo,const char* filename,int nt=0);
 		/** Imports a list of particles from an open file stream into
 		 * the container_poly class. Entries of five numbers (Particle
 		 * ID, x position, y position, z position, radius) are searched
@@ -543,6 +714,7 @@ class container_poly : public container_base, public radius_poly {
 			fclose(fp);
 		}
 		void compute_all_cells();
+		void compute_all_cells(cell_profiler &cp);
 		double sum_cell_volumes();
 		/** Dumps particle IDs, positions and radii to a file.
 		 * \param[in] vl the loop class to use.
@@ -672,6 +844,29 @@ class container_poly : public container_base, public radius_poly {
 				} while(vl.inc());
 			}
 		}
+		/** Computes the Voronoi cells and saves customized information
+		 * about them, measuring the cost of each cell computation.
+		 * \param[in] vl the loop class to use.
+		 * \param[in] format the custom output string to use.
+		 * \param[in] fp a file handle to write to.
+		 * \param[in] cp the profiler to record the costs in. */
+		template<class c_loop>
+		void print_custom(c_loop &vl,const char *format,FILE *fp,cell_profiler &cp) {
+			int ijk,q;double *pp;
+			if(contains_neighbor(format)) {
+				voronoicell_neighbor c(*this);
+				if(vl.start()) do if(cp.compute_cell(*this,c,vl)) {
+					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
+					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],pp[3],fp);
+				} while(vl.inc());
+			} else {
+				voronoicell c(*this);
+				if(vl.start()) do if(cp.compute_cell(*this,c,vl)) {
+					ijk=vl.ijk;q=vl.q;pp=p[ijk]+ps*q;
+					c.output_custom(format,id[ijk][q],*pp,pp[1],pp[2],pp[3],fp);
+				} while(vl.inc());
+			}
+		}
 		/** Computes the Voronoi cell for a particle currently being
 		 * referenced by a loop class.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -697,6 +892,21 @@ class container_poly : public container_base, public radius_poly {
 			int k=ijk/nxy,ijkt=ijk-nxy*k,j=ijkt/nx,i=ijkt-j*nx;
 			return vc.compute_cell(c,ijk,q,i,j,k);
 		}
+		/** Computes the Voronoi cell for a particle with a given ID.
+		 * If the ID index has been enabled, the particle is located in
+		 * constant time, and otherwise the container is scanned.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] pid the ID of the particle.
+		 * \return True if the cell was computed. If the particle is
+		 * not in the container, or if the cell is removed entirely by
+		 * a wall or boundary condition, then the routine returns
+		 * false. */
+		template<class v_cell>
+		inline bool compute_cell_by_id(v_cell &c,int pid) {
+			int ijk,q;
+			return find_particle(pid,ijk,q)&&compute_cell(c,ijk,q);
+		}
 		/** Computes the Voronoi cell for a ghost particle at a given
 		 * location.
 		 * \param[out] c a Voronoi cell class in which to store the
@@ -721,6 +931,7 @@ class container_poly : public container_base, public radius_poly {
 		}
 		void print_custom(const char *format,FILE *fp=stdout);
 		void print_custom(const char *format,const char *filename);
+		void print_custom(const char *format,FILE *fp,cell_profiler &cp);
 		bool find_voronoi_cell(double x,double y,double z,double &rx,double &ry,double &rz,int &pid);
 	private:
 		voro_compute<container_poly> vc;
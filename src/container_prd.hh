@@ -143,6 +143,16 @@ class container_periodic_base : public unitcell, public voro_base {
 		inline void initialize_search(int ,int ,int ,int ,int &i,int &j,int &k,int &) {
 			i=nx;j=ey;k=ez;
 		}
+		/** Computes the vector from a given position to a particle
+		 * stored in the container. This is used by the voro_compute
+		 * template to test the particles in a block.
+		 * \param[in] (ijk,q) the block and index of the particle.
+		 * \param[in] (x,y,z) the position to measure from.
+		 * \param[out] (dx,dy,dz) the vector to the particle. */
+		inline void rel_pos(int ijk,int q,double x,double y,double z,double &dx,double &dy,double &dz) {
+			double *pp=p[ijk]+ps*q;
+			dx=*pp-x;dy=pp[1]-y;dz=pp[2]-z;
+		}
 		/** Returns the position of a particle currently being computed
 		 * relative to the computational block that it is within. It is
 		 * used to select the optimal worklist entry to use.
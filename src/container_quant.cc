@@ -0,0 +1,279 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file container_quant.cc
+ * \brief Function implementations for the container_quant class. */
+
+#include <cmath>
+
+#include "container_quant.hh"
+
+namespace voro {
+
+/** Chooses the number of bits to store each coordinate with, as the smallest
+ * of 16 and 32 for which the quantization error is within a given bound.
+ * \param[in] box the largest dimension of a block.
+ * \param[in] tol the bound on the error in each coordinate.
+ * \return The number of bits. */
+static int quant_bits(double box,double tol) {
+	if(0.5*ldexp(box,-16)<=tol) return 16;
+	if(0.5*ldexp(box,-32)>tol)
+		voro_fatal_error("Quantization error bound cannot be met with 32-bit coordinates",VOROPP_INTERNAL_ERROR);
+	return 32;
+}
+
+/** The class constructor sets up the geometry of container, and allocates
+ * memory for storing the particles in each block. The number of bits used for
+ * each coordinate is chosen so that the error in each coordinate of a stored
+ * position is at most a given bound.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] (nx_,ny_,nz_) the number of grid blocks in each of the three
+ *                       coordinate directions.
+ * \param[in] (xperiodic_,yperiodic_,zperiodic_) flags setting whether the
+ *                                               container is periodic in each
+ *                                               coordinate direction.
+ * \param[in] init_mem the initial memory allocation for each block.
+ * \param[in] tol the bound on the error in each coordinate of a stored
+ *                position. */
+container_quant::container_quant(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+	int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,int init_mem,double tol)
+	: voro_base(nx_,ny_,nz_,(bx_-ax_)/nx_,(by_-ay_)/ny_,(bz_-az_)/nz_),
+	ax(ax_), bx(bx_), ay(ay_), by(by_), az(az_), bz(bz_),
+	max_len_sq((bx-ax)*(bx-ax)*(xperiodic_?0.25:1)+(by-ay)*(by-ay)*(yperiodic_?0.25:1)
+		  +(bz-az)*(bz-az)*(zperiodic_?0.25:1)),
+	xperiodic(xperiodic_), yperiodic(yperiodic_), zperiodic(zperiodic_),
+	id(new int*[nxyz]), co(new int[nxyz]), mem(new int[nxyz]),
+	bits(quant_bits(boxx>boxy?(boxx>boxz?boxx:boxz):(boxy>boxz?boxy:boxz),tol)),
+	qx(ldexp(boxx,-bits)), qy(ldexp(boxy,-bits)), qz(ldexp(boxz,-bits)),
+	max_error(0.5*(qx>qy?(qx>qz?qx:qz):(qy>qz?qy:qz))),
+	q16(bits==16?new unsigned short*[nxyz]:0), q32(bits==32?new unsigned int*[nxyz]:0),
+	org(new double[3*nxyz]), qn(ldexp(1.,bits)),
+	vc(*this,xperiodic_?2*nx_+1:nx_,yperiodic_?2*ny_+1:ny_,zperiodic_?2*nz_+1:nz_) {
+	int i,j,k,l;
+	double *op=org;
+	for(l=0;l<nxyz;l++) co[l]=0;
+	for(l=0;l<nxyz;l++) mem[l]=init_mem;
+	for(l=0;l<nxyz;l++) id[l]=new int[init_mem];
+	if(bits==16) for(l=0;l<nxyz;l++) q16[l]=new unsigned short[3*init_mem];
+	else for(l=0;l<nxyz;l++) q32[l]=new unsigned int[3*init_mem];
+	for(k=0;k<nz;k++) for(j=0;j<ny;j++) for(i=0;i<nx;i++) {
+		*(op++)=ax+boxx*i+0.5*qx;
+		*(op++)=ay+boxy*j+0.5*qy;
+		*(op++)=az+boxz*k+0.5*qz;
+	}
+}
+
+/** The container destructor frees the dynamically allocated memory. */
+container_quant::~container_quant() {
+	int l;
+	if(bits==16) {
+		for(l=0;l<nxyz;l++) delete [] q16[l];
+		delete [] q16;
+	} else {
+		for(l=0;l<nxyz;l++) delete [] q32[l];
+		delete [] q32;
+	}
+	for(l=0;l<nxyz;l++) delete [] id[l];
+	delete [] org;
+	delete [] id;
+	delete [] co;
+	delete [] mem;
+}
+
+/** Clears a container of particles. */
+void container_quant::clear() {
+	for(int *cop=co;cop<co+nxyz;cop++) *cop=0;
+}
+
+/** Put a particle into the correct region of the container.
+ * \param[in] n the numerical ID of the inserted particle.
+ * \param[in] (x,y,z) the position vector of the inserted particle. */
+void container_quant::put(int n,double x,double y,double z) {
+	int ijk;
+	if(put_locate_block(ijk,x,y,z)) {
+		id[ijk][co[ijk]]=n;
+		store(ijk,x,y,z);
+	}
+}
+
+/** Put a particle into the correct region of the container, also recording
+ * into which region it was stored.
+ * \param[in] vo the ordering class in which to record the region.
+ * \param[in] n the numerical ID of the inserted particle.
+ * \param[in] (x,y,z) the position vector of the inserted particle. */
+void container_quant::put(particle_order &vo,int n,double x,double y,double z) {
+	int ijk;
+	if(put_locate_block(ijk,x,y,z)) {
+		id[ijk][co[ijk]]=n;
+		vo.add(ijk,co[ijk]);
+		store(ijk,x,y,z);
+	}
+}
+
+/** Converts a particle position into integer coordinates within its block,
+ * and stores them after the other particles in the block.
+ * \param[in] ijk the block to store the particle in.
+ * \param[in] (x,y,z) the position of the particle, which must lie within the
+ *                    block. */
+void container_quant::store(int ijk,double x,double y,double z) {
+	double *op=org+3*ijk,fx=(x-*op)/qx+0.5,fy=(y-op[1])/qy+0.5,fz=(z-op[2])/qz+0.5,
+	       qm=qn-1;
+	unsigned int ux=fx<=0?0:(fx>=qm?(unsigned int) qm:(unsigned int) fx),
+		     uy=fy<=0?0:(fy>=qm?(unsigned int) qm:(unsigned int) fy),
+		     uz=fz<=0?0:(fz>=qm?(unsigned int) qm:(unsigned int) fz);
+	if(bits==16) {
+		unsigned short *sp=q16[ijk]+3*co[ijk]++;
+		*sp=ux;sp[1]=uy;sp[2]=uz;
+	} else {
+		unsigned int *sp=q32[ijk]+3*co[ijk]++;
+		*sp=ux;sp[1]=uy;sp[2]=uz;
+	}
+}
+
+/** This routine takes a particle position vector, tries to remap it into the
+ * primary domain. If successful, it computes the region into which it can be
+ * stored and checks that there is enough memory within this region to store
+ * it.
+ * \param[out] ijk the region index.
+ * \param[in,out] (x,y,z) the particle position, remapped into the primary
+ *                        domain if necessary.
+ * \return True if the particle can be successfully placed into the container,
+ * false otherwise. */
+bool container_quant::put_locate_block(int &ijk,double &x,double &y,double &z) {
+	if(put_remap(ijk,x,y,z)) {
+		if(co[ijk]==mem[ijk]) add_particle_memory(ijk);
+		return true;
+	}
+#if VOROPP_REPORT_OUT_OF_BOUNDS ==1
+	fprintf(stderr,"Out of bounds: (x,y,z)=(%g,%g,%g)\n",x,y,z);
+#endif
+	return false;
+}
+
+/** Takes a particle position vector and computes the region index into which
+ * it should be stored. If the container is periodic, then the routine also
+ * maps the particle position to ensure it is in the primary domain. If the
+ * container is not periodic, the routine bails out.
+ * \param[out] ijk the region index.
+ * \param[in,out] (x,y,z) the particle position, remapped into the primary
+ *                        domain if necessary.
+ * \return True if the particle can be successfully placed into the container,
+ * false otherwise. */
+bool container_quant::put_remap(int &ijk,double &x,double &y,double &z) {
+	int l;
+
+	ijk=step_int((x-ax)*xsp);
+	if(xperiodic) {l=step_mod(ijk,nx);x+=boxx*(l-ijk);ijk=l;}
+	else if(ijk<0||ijk>=nx) return false;
+
+	int j=step_int((y-ay)*ysp);
+	if(yperiodic) {l=step_mod(j,ny);y+=boxy*(l-j);j=l;}
+	else if(j<0||j>=ny) return false;
+
+	int k=step_int((z-az)*zsp);
+	if(zperiodic) {l=step_mod(k,nz);z+=boxz*(l-k);k=l;}
+	else if(k<0||k>=nz) return false;
+
+	ijk+=nx*j+nxy*k;
+	return true;
+}
+
+/** Increase memory for a particular region.
+ * \param[in] i the index of the region to reallocate. */
+void container_quant::add_particle_memory(int i) {
+	int l,nmem=mem[i]<<1;
+
+	// Carry out a check on the memory allocation size, and
+	// print a status message if requested
+	if(nmem>max_particle_memory)
+		voro_fatal_error("Absolute maximum memory allocation exceeded",VOROPP_MEMORY_ERROR);
+#if VOROPP_VERBOSE >=3
+	fprintf(stderr,"Particle memory in region %d scaled up to %d\n",i,nmem);
+#endif
+
+	// Allocate new memory and copy in the contents of the old arrays
+	int *idp=new int[nmem];
+	for(l=0;l<co[i];l++) idp[l]=id[i][l];
+	delete [] id[i];id[i]=idp;
+	if(bits==16) {
+		unsigned short *sp=new unsigned short[3*nmem];
+		for(l=0;l<3*co[i];l++) sp[l]=q16[i][l];
+		delete [] q16[i];q16[i]=sp;
+	} else {
+		unsigned int *sp=new unsigned int[3*nmem];
+		for(l=0;l<3*co[i];l++) sp[l]=q32[i][l];
+		delete [] q32[i];q32[i]=sp;
+	}
+	mem[i]=nmem;
+}
+
+/** Import a list of particles from an open file stream into the container.
+ * Entries of four numbers (Particle ID, x position, y position, z position)
+ * are searched for. If the file cannot be successfully read, then the routine
+ * causes a fatal error.
+ * \param[in] fp the file handle to read from. */
+void container_quant::import(FILE *fp) {
+	int i,j;
+	double x,y,z;
+	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) put(i,x,y,z);
+	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+}
+
+/** Import a list of particles from an open file stream, also storing the order
+ * of that the particles are read. Entries of four numbers (Particle ID, x
+ * position, y position, z position) are searched for. If the file cannot be
+ * successfully read, then the routine causes a fatal error.
+ * \param[in,out] vo a reference to an ordering class to use.
+ * \param[in] fp the file handle to read from. */
+void container_quant::import(particle_order &vo,FILE *fp) {
+	int i,j;
+	double x,y,z;
+	while((j=fscanf(fp,"%d %lg %lg %lg",&i,&x,&y,&z))==4) put(vo,i,x,y,z);
+	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+}
+
+/** Computes all of the Voronoi cells in the container, but does nothing with
+ * the output. It is useful for measuring the pure computation time of the
+ * Voronoi algorithm, without any additional calculations such as volume
+ * evaluation or cell output. */
+void container_quant::compute_all_cells() {
+	voronoicell c(*this);
+	for(int ijk=0;ijk<nxyz;ijk++) for(int q=0;q<co[ijk];q++) compute_cell(c,ijk,q);
+}
+
+/** Calculates all of the Voronoi cells and sums their volumes. In most cases
+ * without walls, the sum of the Voronoi cell volumes should equal the volume
+ * of the container to numerical precision.
+ * \return The sum of all of the computed Voronoi volumes. */
+double container_quant::sum_cell_volumes() {
+	voronoicell c(*this);
+	double vol=0;
+	for(int ijk=0;ijk<nxyz;ijk++) for(int q=0;q<co[ijk];q++)
+		if(compute_cell(c,ijk,q)) vol+=c.volume();
+	return vol;
+}
+
+/** Computes all the Voronoi cells and saves customized information about them.
+ * The particle positions that are printed are the stored positions.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to. */
+void container_quant::print_custom(const char *format,FILE *fp) {
+	int ijk,q;
+	double x,y,z;
+	if(contains_neighbor(format)) {
+		voronoicell_neighbor c(*this);
+		for(ijk=0;ijk<nxyz;ijk++) for(q=0;q<co[ijk];q++) if(compute_cell(c,ijk,q)) {
+			position(ijk,q,x,y,z);
+			c.output_custom(format,id[ijk][q],x,y,z,default_radius,fp);
+		}
+	} else {
+		voronoicell c(*this);
+		for(ijk=0;ijk<nxyz;ijk++) for(q=0;q<co[ijk];q++) if(compute_cell(c,ijk,q)) {
+			position(ijk,q,x,y,z);
+			c.output_custom(format,id[ijk][q],x,y,z,default_radius,fp);
+		}
+	}
+}
+
+}
@@ -0,0 +1,287 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file container_quant.hh
+ * \brief Header file for the container_quant class. */
+
+#ifndef VOROPP_CONTAINER_QUANT_HH
+#define VOROPP_CONTAINER_QUANT_HH
+
+#include <cstdio>
+
+#include "config.hh"
+#include "common.hh"
+#include "v_base.hh"
+#include "cell.hh"
+#include "c_loops.hh"
+#include "v_compute.hh"
+#include "rad_option.hh"
+#include "container.hh"
+
+namespace voro {
+
+/** \brief A container class that stores the particle positions in a
+ * compressed form.
+ *
+ * The container_base class stores each particle position as three doubles,
+ * which take up most of the memory for very large systems. Since each
+ * particle lies within a computational block, its position can instead be
+ * stored as three integers giving its fractional position within the block.
+ * This class stores each coordinate as a 16-bit or a 32-bit integer, so that
+ * the positions take two or four times less memory than in the container
+ * class. The integer width is chosen when the class is constructed, as the
+ * smallest one for which the quantization error is within a given bound.
+ *
+ * A stored coordinate refers to the center of one of 2^bits equal intervals
+ * across the block, so that the error in each coordinate is at most half of
+ * the interval width. The positions are converted back to doubles as they are
+ * needed by the voro_compute template, and the cells that are computed are
+ * the exact Voronoi cells of the quantized positions. This class carries out
+ * the regular Voronoi tessellation, without particle radii.
+ *
+ * Since the loop classes refer to the double precision positions of the
+ * container_base class, the cells are instead computed by block and index,
+ * either directly, through a particle_order class, or with the
+ * compute_order_parallel and compute_all_parallel routines. */
+class container_quant : public voro_base, public wall_list, public radius_mono {
+	public:
+		/** The minimum x coordinate of the container. */
+		const double ax;
+		/** The maximum x coordinate of the container. */
+		const double bx;
+		/** The minimum y coordinate of the container. */
+		const double ay;
+		/** The maximum y coordinate of the container. */
+		const double by;
+		/** The minimum z coordinate of the container. */
+		const double az;
+		/** The maximum z coordinate of the container. */
+		const double bz;
+		/** The maximum length squared that could be encountered in the
+		 * Voronoi cell calculation. */
+		const double max_len_sq;
+		/** A boolean value that determines if the x coordinate in
+		 * periodic or not. */
+		const bool xperiodic;
+		/** A boolean value that determines if the y coordinate in
+		 * periodic or not. */
+		const bool yperiodic;
+		/** A boolean value that determines if the z coordinate in
+		 * periodic or not. */
+		const bool zperiodic;
+		/** This array holds the numerical IDs of each particle in each
+		 * computational box. */
+		int **id;
+		/** This array holds the number of particles within each
+		 * computational box of the container. */
+		int *co;
+		/** This array holds the maximum amount of particle memory for
+		 * each computational box of the container. */
+		int *mem;
+		/** The number of bits used to store each coordinate, which is
+		 * either 16 or 32. */
+		const int bits;
+		/** The width of a quantization interval in the x direction. */
+		const double qx;
+		/** The width of a quantization interval in the y direction. */
+		const double qy;
+		/** The width of a quantization interval in the z direction. */
+		const double qz;
+		/** The maximum error in any coordinate of a stored position,
+		 * up to floating point rounding, which is half of the largest
+		 * interval width. The distance between a stored position and
+		 * the original position is at most half of the length of the
+		 * diagonal of an interval cell. */
+		const double max_error;
+		container_quant(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,
+				int init_mem,double tol);
+		~container_quant();
+		void clear();
+		void put(int n,double x,double y,double z);
+		void put(particle_order &vo,int n,double x,double y,double z);
+		void import(FILE *fp=stdin);
+		void import(particle_order &vo,FILE *fp=stdin);
+		/** Imports a list of particles from an open file stream into
+		 * the container. Entries of four numbers (Particle ID, x
+		 * position, y position, z position) are searched for. If the
+		 * file cannot be successfully read, then the routine causes a
+		 * fatal error.
+		 * \param[in] filename the name of the file to open and read
+		 *                     from. */
+		inline void import(const char* filename) {
+			FILE *fp=safe_fopen(filename,"r");
+			import(fp);
+			fclose(fp);
+		}
+		/** Imports a list of particles from an open file stream into
+		 * the container, also saving the order in which the particles
+		 * are read into an ordering class. If the file cannot be
+		 * successfully read, then the routine causes a fatal error.
+		 * \param[in,out] vo the ordering class to use.
+		 * \param[in] filename the name of the file to open and read
+		 *                     from. */
+		inline void import(particle_order &vo,const char* filename) {
+			FILE *fp=safe_fopen(filename,"r");
+			import(vo,fp);
+			fclose(fp);
+		}
+		/** Sums up the total number of stored particles.
+		 * \return The number of particles. */
+		inline int total_particles() {
+			int tp=*co;
+			for(int *cop=co+1;cop<co+nxyz;cop++) tp+=*cop;
+			return tp;
+		}
+		/** Returns the number of bytes used to store the position of
+		 * each particle.
+		 * \return The number of bytes. */
+		inline int position_bytes() {return 3*(bits>>3);}
+		/** Computes the stored position of a particle.
+		 * \param[in] (ijk,q) the block and index of the particle.
+		 * \param[out] (x,y,z) the position. */
+		inline void position(int ijk,int q,double &x,double &y,double &z) {
+			rel_pos(ijk,q,0,0,0,x,y,z);
+		}
+		void compute_all_cells();
+		double sum_cell_volumes();
+		void print_custom(const char *format,FILE *fp=stdout);
+		/** Computes all the Voronoi cells and saves customized
+		 * information about them.
+		 * \param[in] format the custom output string to use.
+		 * \param[in] filename the name of the file to write to. */
+		inline void print_custom(const char *format,const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			print_custom(format,fp);
+			fclose(fp);
+		}
+		/** Computes the Voronoi cell for given particle.
+		 * \param[out] c a Voronoi cell class in which to store the
+		 * 		 computed cell.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within the block.
+		 * \return True if the cell was computed. If the cell cannot be
+		 * computed, if it is removed entirely by a wall or boundary
+		 * condition, then the routine returns false. */
+		template<class v_cell>
+		inline bool compute_cell(v_cell &c,int ijk,int q) {
+			int k=ijk/nxy,ijkt=ijk-nxy*k,j=ijkt/nx,i=ijkt-j*nx;
+			return vc.compute_cell(c,ijk,q,i,j,k);
+		}
+		/** Initializes the Voronoi cell prior to a compute_cell
+		 * operation for a specific particle being carried out by a
+		 * voro_compute class, in the same way as the container_base
+		 * class.
+		 * \param[in,out] c a reference to a voronoicell object.
+		 * \param[in] ijk the block that the particle is within.
+		 * \param[in] q the index of the particle within its block.
+		 * \param[in] (ci,cj,ck) the coordinates of the block in the
+		 * 			 container coordinate system.
+		 * \param[out] (i,j,k) the coordinates of the test block
+		 * 		       relative to the voro_compute
+		 * 		       coordinate system.
+		 * \param[out] (x,y,z) the position of the particle.
+		 * \param[out] disp a block displacement used internally by the
+		 *		    compute_cell routine.
+		 * \return False if the plane cuts applied by walls completely
+		 * removed the cell, true otherwise. */
+		template<class v_cell>
+		inline bool initialize_voronoicell(v_cell &c,int ijk,int q,int ci,int cj,int ck,
+				int &i,int &j,int &k,double &x,double &y,double &z,int &disp) {
+			double x1,x2,y1,y2,z1,z2;
+			position(ijk,q,x,y,z);
+			if(xperiodic) {x1=-(x2=0.5*(bx-ax));i=nx;} else {x1=ax-x;x2=bx-x;i=ci;}
+			if(yperiodic) {y1=-(y2=0.5*(by-ay));j=ny;} else {y1=ay-y;y2=by-y;j=cj;}
+			if(zperiodic) {z1=-(z2=0.5*(bz-az));k=nz;} else {z1=az-z;z2=bz-z;k=ck;}
+			c.init(x1,x2,y1,y2,z1,z2);
+			if(!apply_walls(c,x,y,z)) return false;
+			disp=ijk-i-nx*(j+ny*k);
+			return true;
+		}
+		/** Initializes parameters for a find_voronoi_cell call within
+		 * the voro_compute template.
+		 * \param[in] (ci,cj,ck) the coordinates of the test block in
+		 * 			 the container coordinate system.
+		 * \param[in] ijk the index of the test block
+		 * \param[out] (i,j,k) the coordinates of the test block
+		 * 		       relative to the voro_compute
+		 * 		       coordinate system.
+		 * \param[out] disp a block displacement used internally by the
+		 *		    find_voronoi_cell routine. */
+		inline void initialize_search(int ci,int cj,int ck,int ijk,int &i,int &j,int &k,int &disp) {
+			i=xperiodic?nx:ci;
+			j=yperiodic?ny:cj;
+			k=zperiodic?nz:ck;
+			disp=ijk-i-nx*(j+ny*k);
+		}
+		/** Computes the vector from a given position to a particle
+		 * stored in the container, converting the stored integer
+		 * coordinates back into a position. This is used by the
+		 * voro_compute template to test the particles in a block.
+		 * \param[in] (ijk,q) the block and index of the particle.
+		 * \param[in] (x,y,z) the position to measure from.
+		 * \param[out] (dx,dy,dz) the vector to the particle. */
+		inline void rel_pos(int ijk,int q,double x,double y,double z,double &dx,double &dy,double &dz) {
+			double *op=org+3*ijk;
+			if(bits==16) {
+				unsigned short *sp=q16[ijk]+3*q;
+				dx=*op+qx*(*sp)-x;dy=op[1]+qy*sp[1]-y;dz=op[2]+qz*sp[2]-z;
+			} else {
+				unsigned int *sp=q32[ijk]+3*q;
+				dx=*op+qx*(*sp)-x;dy=op[1]+qy*sp[1]-y;dz=op[2]+qz*sp[2]-z;
+			}
+		}
+		/** Returns the position of a particle currently being computed
+		 * relative to the computational block that it is within. It is
+		 * used to select the optimal worklist entry to use.
+		 * \param[in] (x,y,z) the position of the particle.
+		 * \param[in] (ci,cj,ck) the block that the particle is within.
+		 * \param[out] (fx,fy,fz) the position relative to the block.
+		 */
+		inline void frac_pos(double x,double y,double z,double ci,double cj,double ck,
+				double &fx,double &fy,double &fz) {
+			fx=x-ax-boxx*ci;
+			fy=y-ay-boxy*cj;
+			fz=z-az-boxz*ck;
+		}
+		/** Calculates the index of block in the container structure
+		 * corresponding to given coordinates.
+		 * \param[in] (ci,cj,ck) the coordinates of the original block
+		 * 			 in the current computation, relative
+		 * 			 to the container coordinate system.
+		 * \param[in] (ei,ej,ek) the displacement of the current block
+		 * 			 from the original block.
+		 * \param[in,out] (qx_,qy_,qz_) the periodic displacement that
+		 * 			       must be added to the particles
+		 * 			       within the computed block.
+		 * \param[in] disp a block displacement used internally by the
+		 * 		    compute_cell routine.
+		 * \return The block index. */
+		inline int region_index(int ci,int cj,int ck,int ei,int ej,int ek,double &qx_,double &qy_,double &qz_,int &disp) {
+			if(xperiodic) {if(ci+ei<nx) {ei+=nx;qx_=-(bx-ax);} else if(ci+ei>=(nx<<1)) {ei-=nx;qx_=bx-ax;} else qx_=0;}
+			if(yperiodic) {if(cj+ej<ny) {ej+=ny;qy_=-(by-ay);} else if(cj+ej>=(ny<<1)) {ej-=ny;qy_=by-ay;} else qy_=0;}
+			if(zperiodic) {if(ck+ek<nz) {ek+=nz;qz_=-(bz-az);} else if(ck+ek>=(nz<<1)) {ek-=nz;qz_=bz-az;} else qz_=0;}
+			return disp+ei+nx*(ej+ny*ek);
+		}
+	private:
+		/** The stored coordinates of the particles in each block, if
+		 * 16-bit integers are used. */
+		unsigned short **q16;
+		/** The stored coordinates of the particles in each block, if
+		 * 32-bit integers are used. */
+		unsigned int **q32;
+		/** The positions of the centers of the first quantization
+		 * intervals of the blocks, three per block. */
+		double *org;
+		/** The number of quantization intervals across each block. */
+		const double qn;
+		voro_compute<container_quant> vc;
+		void add_particle_memory(int i);
+		bool put_locate_block(int &ijk,double &x,double &y,double &z);
+		bool put_remap(int &ijk,double &x,double &y,double &z);
+		void store(int ijk,double x,double y,double z);
+		friend class voro_compute<container_quant>;
+};
+
+}
+
+#endif
@@ -0,0 +1,242 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file container_roi.cc
+ * \brief Function implementations for the container_roi class and the
+ * particle streams. */
+
+#include <cmath>
+#include <cstring>
+
+#include "container_roi.hh"
+#include "pre_container.hh"
+
+namespace voro {
+
+/** Reads the next entry of four numbers from the file. If the file cannot be
+ * successfully read, then the routine causes a fatal error.
+ * \param[out] n the numerical ID of the particle.
+ * \param[out] (x,y,z) the position of the particle.
+ * \return True if a particle was read, false if the end of the file was
+ *         reached. */
+bool particle_stream_text::next(int &n,double &x,double &y,double &z) {
+	int j=fscanf(fp,"%d %lg %lg %lg",&n,&x,&y,&z);
+	if(j==4) return true;
+	if(j!=EOF) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	return false;
+}
+
+/** Returns to the start of the file. */
+void particle_stream_text::rewind() {
+	if(fseek(fp,0,SEEK_SET)!=0) voro_fatal_error("Particle stream is not seekable",VOROPP_FILE_ERROR);
+}
+
+/** Constructs a stream from an open file handle, which must be seekable so
+ * that the file can be read several times.
+ * \param[in] fp_ the file handle to read from. */
+particle_stream_binary::particle_stream_binary(FILE *fp_) : fp(fp_), own(false),
+	buf(new char[roi_stream_records*rsize]), bp(buf), be(buf) {}
+
+/** Constructs a stream by opening a file.
+ * \param[in] filename the name of the file to read from. */
+particle_stream_binary::particle_stream_binary(const char *filename) : fp(safe_fopen(filename,"rb")),
+	own(true), buf(new char[roi_stream_records*rsize]), bp(buf), be(buf) {}
+
+/** The destructor frees the buffer and closes the file if it was opened by
+ * the class. */
+particle_stream_binary::~particle_stream_binary() {
+	delete [] buf;
+	if(own) fclose(fp);
+}
+
+/** Reads the next block of records from the file into the buffer. */
+void particle_stream_binary::fill() {
+	size_t l=fread(buf,rsize,roi_stream_records,fp);
+	if(l<size_t(roi_stream_records)&&ferror(fp)) voro_fatal_error("File import error",VOROPP_FILE_ERROR);
+	bp=buf;be=buf+l*rsize;
+}
+
+/** Reads the next record from the file.
+ * \param[out] n the numerical ID of the particle.
+ * \param[out] (x,y,z) the position of the particle.
+ * \return True if a particle was read, false if the end of the file was
+ *         reached. */
+bool particle_stream_binary::next(int &n,double &x,double &y,double &z) {
+	if(bp==be) {
+		fill();
+		if(bp==be) return false;
+	}
+	memcpy(&n,bp,sizeof(int));bp+=sizeof(int);
+	memcpy(&x,bp,sizeof(double));bp+=sizeof(double);
+	memcpy(&y,bp,sizeof(double));bp+=sizeof(double);
+	memcpy(&z,bp,sizeof(double));bp+=sizeof(double);
+	return true;
+}
+
+/** Returns to the start of the file, discarding any buffered records. */
+void particle_stream_binary::rewind() {
+	if(fseek(fp,0,SEEK_SET)!=0) voro_fatal_error("Particle stream is not seekable",VOROPP_FILE_ERROR);
+	bp=be=buf;
+}
+
+/** The class constructor sets up the geometry of the global domain and the
+ * region of interest.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates of the domain.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates of the domain.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates of the domain.
+ * \param[in] (rax_,rbx_) the minimum and maximum x coordinates of the region
+ *                        of interest.
+ * \param[in] (ray_,rby_) the minimum and maximum y coordinates of the region
+ *                        of interest.
+ * \param[in] (raz_,rbz_) the minimum and maximum z coordinates of the region
+ *                        of interest.
+ * \param[in] halo_ the initial halo width. If this is zero or negative, then
+ *                  an initial width is estimated from the mean particle
+ *                  density. */
+container_roi::container_roi(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+	double rax_,double rbx_,double ray_,double rby_,double raz_,double rbz_,double halo_) :
+	ax(ax_), bx(bx_), ay(ay_), by(by_), az(az_), bz(bz_),
+	rax(rax_<ax_?ax_:rax_), rbx(rbx_>bx_?bx_:rbx_), ray(ray_<ay_?ay_:ray_),
+	rby(rby_>by_?by_:rby_), raz(raz_<az_?az_:raz_), rbz(rbz_>bz_?bz_:rbz_),
+	halo(halo_), passes(0), total(0), con(0) {}
+
+/** The destructor frees the dynamically allocated container. */
+container_roi::~container_roi() {
+	if(con!=0) delete con;
+}
+
+/** Imports the particles in the region of interest and its halo from a
+ * particle stream. The halo is grown, and the stream is read again, until the
+ * cells of all particles in the region of interest are certified to be exact.
+ * \param[in] ps the particle stream to read from. */
+void container_roi::import(particle_stream &ps) {
+	double req;
+	passes=0;
+
+	// If no initial halo was given, then count the particles and use a
+	// multiple of the mean interparticle spacing
+	if(halo<=0) {
+		int n;double x,y,z;
+		ps.rewind();total=0;
+		while(ps.next(n,x,y,z)) total++;
+		passes++;
+		halo=total==0?0:roi_init_halo*pow((bx-ax)*(by-ay)*(bz-az)/total,1/3.0);
+	}
+
+	// Load the particles and check the cells, growing the halo until
+	// every cell is certified
+	while(true) {
+		load(ps);passes++;
+		req=certify();
+		if(req<=halo) break;
+#if VOROPP_VERBOSE >=2
+		fprintf(stderr,"ROI halo grown from %g to %g\n",halo,req>2*halo?req:2*halo);
+#endif
+		halo=req>2*halo?req:2*halo;
+	}
+}
+
+/** Reads through the particle stream, storing the particles that lie within
+ * the region of interest or the current halo in a new container.
+ * \param[in] ps the particle stream to read from. */
+void container_roi::load(particle_stream &ps) {
+	int n,nx,ny,nz;double x,y,z;
+	double lax=rax-halo,lbx=rbx+halo,lay=ray-halo,lby=rby+halo,laz=raz-halo,lbz=rbz+halo;
+	if(lax<ax) lax=ax;
+	if(lbx>bx) lbx=bx;
+	if(lay<ay) lay=ay;
+	if(lby>by) lby=by;
+	if(laz<az) laz=az;
+	if(lbz>bz) lbz=bz;
+
+	// Read the stream into a pre_container, which discards any particles
+	// outside the loading region
+	pre_container pc(lax,lbx,lay,lby,laz,lbz,false,false,false);
+	ps.rewind();total=0;
+	while(ps.next(n,x,y,z)) {pc.put(n,x,y,z);total++;}
+
+	// Set up a container with an appropriate grid size and transfer the
+	// particles to it
+	if(con!=0) delete con;
+	pc.guess_optimal(nx,ny,nz);
+	con=new container(lax,lbx,lay,lby,laz,lbz,nx,ny,nz,false,false,false,8);
+	pc.setup(*con);
+}
+
+/** Computes the cells of all particles in the region of interest, and
+ * determines the halo width that is needed to certify them. A cell is
+ * certified if the sphere centered on its particle with twice its maximum
+ * vertex radius lies within the loaded region, or extends beyond it only where
+ * the loaded region meets the domain boundary.
+ * \return The halo width required to certify all of the computed cells. */
+double container_roi::certify() {
+	double *pp,x,y,z,r,l,req=0;
+	c_loop_subset vl(*con);
+	voronoicell c(*con);
+	setup_loop(vl);
+	if(vl.start()) do if(con->compute_cell(c,vl)) {
+		pp=con->p[vl.ijk]+con->ps*vl.q;
+		x=*pp;y=pp[1];z=pp[2];
+
+		// Since the vertex positions are stored at twice their actual
+		// value, the diameter of the influence sphere is the square
+		// root of the maximum radius squared
+		r=sqrt(c.max_radius_squared());
+		l=x-r<ax?rax-ax:rax-x+r;if(l>req) req=l;
+		l=x+r>bx?bx-rbx:x+r-rbx;if(l>req) req=l;
+		l=y-r<ay?ray-ay:ray-y+r;if(l>req) req=l;
+		l=y+r>by?by-rby:y+r-rby;if(l>req) req=l;
+		l=z-r<az?raz-az:raz-z+r;if(l>req) req=l;
+		l=z+r>bz?bz-rbz:z+r-rbz;if(l>req) req=l;
+	} while(vl.inc());
+	return req;
+}
+
+/** Computes all of the Voronoi cells in the region of interest, but does
+ * nothing with the output. It is useful for measuring the pure computation
+ * time of the Voronoi algorithm, without any additional calculations such as
+ * volume evaluation or cell output. */
+void container_roi::compute_all_cells() {
+	if(con==0) return;
+	c_loop_subset vl(*con);
+	voronoicell c(*con);
+	setup_loop(vl);
+	if(vl.start()) do con->compute_cell(c,vl);
+	while(vl.inc());
+}
+
+/** Calculates all of the Voronoi cells in the region of interest and sums
+ * their volumes.
+ * \return The computed volume. */
+double container_roi::sum_cell_volumes() {
+	double vvol=0;
+	if(con==0) return 0;
+	c_loop_subset vl(*con);
+	voronoicell c(*con);
+	setup_loop(vl);
+	if(vl.start()) do if(con->compute_cell(c,vl)) vvol+=c.volume();
+	while(vl.inc());
+	return vvol;
+}
+
+/** Computes all the Voronoi cells in the region of interest and saves
+ * customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to. */
+void container_roi::print_custom(const char *format,FILE *fp) {
+	if(con==0) return;
+	c_loop_subset vl(*con);
+	setup_loop(vl);
+	con->print_custom(vl,format,fp);
+}
+
+/** Computes all the Voronoi cells in the region of interest and saves
+ * customized information about them.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to. */
+void container_roi::print_custom(const char *format,const char *filename) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_custom(format,fp);
+	fclose(fp);
+}
+
+}
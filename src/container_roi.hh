@@ -0,0 +1,190 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file container_roi.hh
+ * \brief Header file for the container_roi class and the particle streams that
+ * feed it. */
+
+#ifndef VOROPP_CONTAINER_ROI_HH
+#define VOROPP_CONTAINER_ROI_HH
+
+#include <cstdio>
+
+#include "config.hh"
+#include "common.hh"
+#include "c_loops.hh"
+#include "container.hh"
+
+namespace voro {
+
+/** \brief Pure virtual class from which particle streams are derived.
+ *
+ * This class describes a sequential source of particles that can be read
+ * through several times. It is used by the container_roi class, which makes
+ * repeated passes over a large snapshot while only keeping a small part of it
+ * in memory. */
+class particle_stream {
+	public:
+		virtual ~particle_stream() {}
+		/** Reads the next particle from the stream.
+		 * \param[out] n the numerical ID of the particle.
+		 * \param[out] (x,y,z) the position of the particle.
+		 * \return True if a particle was read, false if the end of the
+		 *         stream was reached. */
+		virtual bool next(int &n,double &x,double &y,double &z) = 0;
+		/** Returns the stream to its start, so that the particles can
+		 * be read again. */
+		virtual void rewind() = 0;
+};
+
+/** \brief A particle stream that reads a text file.
+ *
+ * This class reads entries of four numbers (Particle ID, x position, y
+ * position, z position) from a text file, in the same format as the
+ * container::import routine. */
+class particle_stream_text : public particle_stream {
+	public:
+		/** Constructs a stream from an open file handle, which must
+		 * be seekable so that the file can be read several times.
+		 * \param[in] fp_ the file handle to read from. */
+		particle_stream_text(FILE *fp_) : fp(fp_), own(false) {}
+		/** Constructs a stream by opening a file.
+		 * \param[in] filename the name of the file to read from. */
+		particle_stream_text(const char *filename) : fp(safe_fopen(filename,"r")), own(true) {}
+		virtual ~particle_stream_text() {if(own) fclose(fp);}
+		virtual bool next(int &n,double &x,double &y,double &z);
+		virtual void rewind();
+	private:
+		/** The file handle to read from. */
+		FILE *fp;
+		/** Whether the file handle was opened by this class, and
+		 * should therefore be closed by it. */
+		const bool own;
+};
+
+/** \brief A particle stream that reads a binary file.
+ *
+ * This class reads a binary file made up of consecutive records, each holding
+ * an integer particle ID followed by three double precision coordinates, in
+ * the native byte order of the machine. The file is read in blocks of
+ * roi_stream_records records at a time. */
+class particle_stream_binary : public particle_stream {
+	public:
+		particle_stream_binary(FILE *fp_);
+		particle_stream_binary(const char *filename);
+		virtual ~particle_stream_binary();
+		virtual bool next(int &n,double &x,double &y,double &z);
+		virtual void rewind();
+	private:
+		/** The number of bytes in a single record. */
+		static const int rsize=sizeof(int)+3*sizeof(double);
+		/** The file handle to read from. */
+		FILE *fp;
+		/** Whether the file handle was opened by this class, and
+		 * should therefore be closed by it. */
+		const bool own;
+		/** A buffer holding a block of records read from the file. */
+		char *buf;
+		/** A pointer to the next unread record in the buffer. */
+		char *bp;
+		/** A pointer to the end of the valid records in the buffer. */
+		char *be;
+		void fill();
+};
+
+/** \brief A class for computing the Voronoi cells in a region of interest
+ * within a large particle snapshot.
+ *
+ * When only the cells in a small sub-box of a large snapshot are required,
+ * importing the entire snapshot into a container is wasteful. This class
+ * instead makes passes over a particle stream, keeping only the particles that
+ * lie within the region of interest (ROI) or a halo surrounding it. After each
+ * pass, the cells of the ROI particles are computed and certified: a cell is
+ * exact if the sphere of twice its maximum vertex radius lies entirely within
+ * the loaded region, since no particle outside that sphere can cut it. If any
+ * cell fails this test then the halo is grown and another pass is made. The
+ * memory and computation therefore scale with the size of the ROI rather than
+ * with the size of the snapshot.
+ *
+ * The global domain is assumed to be non-periodic, with walls at its
+ * boundaries, so that the computed cells match those that would be obtained
+ * by importing the whole snapshot into a container with the same bounds. */
+class container_roi {
+	public:
+		/** The minimum x coordinate of the global domain. */
+		const double ax;
+		/** The maximum x coordinate of the global domain. */
+		const double bx;
+		/** The minimum y coordinate of the global domain. */
+		const double ay;
+		/** The maximum y coordinate of the global domain. */
+		const double by;
+		/** The minimum z coordinate of the global domain. */
+		const double az;
+		/** The maximum z coordinate of the global domain. */
+		const double bz;
+		/** The minimum x coordinate of the region of interest. */
+		const double rax;
+		/** The maximum x coordinate of the region of interest. */
+		const double rbx;
+		/** The minimum y coordinate of the region of interest. */
+		const double ray;
+		/** The maximum y coordinate of the region of interest. */
+		const double rby;
+		/** The minimum z coordinate of the region of interest. */
+		const double raz;
+		/** The maximum z coordinate of the region of interest. */
+		const double rbz;
+		/** The width of the halo surrounding the region of interest.
+		 * After a call to import(), this holds the halo width that
+		 * certified all of the cells. */
+		double halo;
+		/** The number of passes made over the particle stream during
+		 * the last import. */
+		int passes;
+		/** The total number of particles in the particle stream. */
+		int total;
+		/** A pointer to the container holding the particles in the
+		 * region of interest and the halo, or a null pointer if no
+		 * particles have been imported. */
+		container *con;
+		container_roi(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				double rax_,double rbx_,double ray_,double rby_,double raz_,double rbz_,double halo_=0);
+		~container_roi();
+		void import(particle_stream &ps);
+		/** Imports particles from a text file.
+		 * \param[in] filename the name of the file to read from. */
+		inline void import(const char *filename) {
+			particle_stream_text ps(filename);
+			import(ps);
+		}
+		/** Imports particles from a binary file, in the format
+		 * described in the particle_stream_binary class.
+		 * \param[in] filename the name of the file to read from. */
+		inline void import_binary(const char *filename) {
+			particle_stream_binary ps(filename);
+			import(ps);
+		}
+		/** Sets up a loop class over the particles in the region of
+		 * interest.
+		 * \param[in] vl the loop class to set up. */
+		inline void setup_loop(c_loop_subset &vl) {
+			vl.setup_box(rax,rbx,ray,rby,raz,rbz,true);
+		}
+		/** Returns the number of particles currently held, including
+		 * those in the halo.
+		 * \return The number of particles. */
+		inline int loaded_particles() {
+			return con==0?0:con->total_particles();
+		}
+		void compute_all_cells();
+		double sum_cell_volumes();
+		void print_custom(const char *format,FILE *fp=stdout);
+		void print_custom(const char *format,const char *filename);
+	private:
+		void load(particle_stream &ps);
+		double certify();
+};
+
+}
+
+#endif
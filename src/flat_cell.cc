@@ -0,0 +1,271 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file flat_cell.cc
+ * \brief Function implementations for the flat_cell class. */
+
+#include <cmath>
+#include <algorithm>
+
+#include "flat_cell.hh"
+
+namespace voro {
+
+/** The class constructor sets up an empty cell. */
+flat_cell::flat_cell() : nf(0), nt(0) {}
+
+/** Converts a Voronoi cell into the flattened representation. The faces are
+ * found in a single traversal of the edge graph, and each face with n
+ * vertices is split into a fan of n-2 triangles sharing its first vertex.
+ * The face vertex lists run clockwise when viewed from outside the cell, so
+ * the triangles are reversed to give them an outward orientation.
+ * \param[in] c the cell to convert. */
+void flat_cell::flatten(voronoicell_base &c) {
+	int i,j,l,*vp,*ve;
+	c.vertices(pts);
+	c.face_vertices(vi);
+
+	// Count the faces and triangles, and assemble the index arrays
+	nf=nt=0;l=vi.size();
+	for(i=0;i<l;i+=vi[i]+1) {nf++;nt+=vi[i]-2;}
+	fo.resize(nf+1);tri.resize(3*nt);
+	vp=tri.data();nf=0;
+	for(i=0;i<l;i+=vi[i]+1) {
+		fo[nf++]=(vp-tri.data())/3;
+		for(j=i+2;j<i+vi[i];j++) {
+			*(vp++)=vi[i+1];*(vp++)=vi[j+1];*(vp++)=vi[j];
+		}
+	}
+	fo[nf]=nt;
+
+	// Gather the corner positions of the triangles, and discard the
+	// face planes and tetrahedra of any previous cell
+	tc.resize(9*nt);ts.resize(nt);
+	fpl.clear();tv.clear();
+	double *cp=tc.data();
+	for(j=0;j<3;j++) for(l=0;l<3;l++)
+		for(vp=tri.data()+j,ve=vp+3*nt;vp<ve;vp+=3) *(cp++)=pts[3**vp+l];
+}
+
+/** Calculates the volume of the cell, by summing the signed volumes of the
+ * tetrahedra formed by each triangle and the particle position.
+ * \return The computed volume. */
+double flat_cell::volume() {
+	const double *ax=tc.data(),*ay=ax+nt,*az=ay+nt,*bx=az+nt,*by=bx+nt,
+	      *bz=by+nt,*cx=bz+nt,*cy=cx+nt,*cz=cy+nt;
+	double vol=0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+:vol)
+#endif
+	for(int t=0;t<nt;t++)
+		vol+=ax[t]*(by[t]*cz[t]-bz[t]*cy[t])+ay[t]*(bz[t]*cx[t]-bx[t]*cz[t])
+		    +az[t]*(bx[t]*cy[t]-by[t]*cx[t]);
+	return vol*(1/6.0);
+}
+
+/** Calculates the centroid of the cell, relative to the particle position,
+ * along with the volume of the cell.
+ * \param[out] (cx,cy,cz) the centroid vector.
+ * \param[out] vol the volume of the cell. */
+void flat_cell::centroid(double &cx,double &cy,double &cz,double &vol) {
+	const double *ax=tc.data(),*ay=ax+nt,*az=ay+nt,*bx=az+nt,*by=bx+nt,
+	      *bz=by+nt,*qx=bz+nt,*qy=qx+nt,*qz=qy+nt;
+	double sx=0,sy=0,sz=0,v;
+	vol=0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+:vol,sx,sy,sz) private(v)
+#endif
+	for(int t=0;t<nt;t++) {
+		v=ax[t]*(by[t]*qz[t]-bz[t]*qy[t])+ay[t]*(bz[t]*qx[t]-bx[t]*qz[t])
+		 +az[t]*(bx[t]*qy[t]-by[t]*qx[t]);
+		vol+=v;
+		sx+=(ax[t]+bx[t]+qx[t])*v;
+		sy+=(ay[t]+by[t]+qy[t])*v;
+		sz+=(az[t]+bz[t]+qz[t])*v;
+	}
+	if(vol>0) {
+		v=0.25/vol;
+		cx=sx*v;cy=sy*v;cz=sz*v;
+	} else cx=cy=cz=0;
+	vol*=1/6.0;
+}
+
+/** Computes the vector products of the edges of each triangle, whose lengths
+ * are twice the triangle areas.
+ * \param[out] (wx,wy,wz) arrays in which to store the components of the
+ *                        vector products. */
+void flat_cell::triangle_normals(double *wx,double *wy,double *wz) {
+	const double *ax=tc.data(),*ay=ax+nt,*az=ay+nt,*bx=az+nt,*by=bx+nt,
+	      *bz=by+nt,*cx=bz+nt,*cy=cx+nt,*cz=cy+nt;
+	double ux,uy,uz,vx,vy,vz;
+#ifdef _OPENMP
+#pragma omp simd private(ux,uy,uz,vx,vy,vz)
+#endif
+	for(int t=0;t<nt;t++) {
+		ux=bx[t]-ax[t];uy=by[t]-ay[t];uz=bz[t]-az[t];
+		vx=cx[t]-ax[t];vy=cy[t]-ay[t];vz=cz[t]-az[t];
+		wx[t]=uy*vz-uz*vy;
+		wy[t]=uz*vx-ux*vz;
+		wz[t]=ux*vy-uy*vx;
+	}
+}
+
+/** Calculates the areas of the faces of the cell.
+ * \param[out] v the vector to store the results in. */
+void flat_cell::face_areas(std::vector<double> &v) {
+	std::vector<double> w(3*nt);
+	double *wx=w.data(),*wy=wx+nt,*wz=wy+nt,*ar=ts.data();
+	triangle_normals(wx,wy,wz);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+	for(int t=0;t<nt;t++) ar[t]=0.5*sqrt(wx[t]*wx[t]+wy[t]*wy[t]+wz[t]*wz[t]);
+	v.resize(nf);
+	for(int i=0;i<nf;i++) {
+		double a=0;
+		for(int t=fo[i];t<fo[i+1];t++) a+=ar[t];
+		v[i]=a;
+	}
+}
+
+/** Calculates the total surface area of the cell.
+ * \return The computed area. */
+double flat_cell::surface_area() {
+	std::vector<double> w(3*nt);
+	double *wx=w.data(),*wy=wx+nt,*wz=wy+nt,area=0;
+	triangle_normals(wx,wy,wz);
+#ifdef _OPENMP
+#pragma omp simd reduction(+:area)
+#endif
+	for(int t=0;t<nt;t++) area+=sqrt(wx[t]*wx[t]+wy[t]*wy[t]+wz[t]*wz[t]);
+	return 0.5*area;
+}
+
+/** Calculates the outward unit normal vectors of the faces of the cell. Each
+ * normal is found by summing the vector products of the triangles of the
+ * face, so that all of its vertices contribute. If a face has zero area,
+ * then (0,0,0) is returned as its normal.
+ * \param[out] v the vector to store the results in, three per face. */
+void flat_cell::normals(std::vector<double> &v) {
+	std::vector<double> w(3*nt);
+	double *wx=w.data(),*wy=wx+nt,*wz=wy+nt,nx,ny,nz,l;
+	triangle_normals(wx,wy,wz);
+	v.resize(3*nf);
+	for(int i=0;i<nf;i++) {
+		nx=ny=nz=0;
+		for(int t=fo[i];t<fo[i+1];t++) {nx+=wx[t];ny+=wy[t];nz+=wz[t];}
+		l=nx*nx+ny*ny+nz*nz;
+		if(l>0) {
+			l=1/sqrt(l);
+			v[3*i]=nx*l;v[3*i+1]=ny*l;v[3*i+2]=nz*l;
+		} else v[3*i]=v[3*i+1]=v[3*i+2]=0;
+	}
+}
+
+/** Computes the planes of the faces, if they have not already been computed
+ * for this cell. */
+void flat_cell::setup_planes() {
+	if(!fpl.empty()||nf==0) return;
+	std::vector<double> v;
+	normals(v);
+	fpl.resize(4*nf);
+	for(int i=0;i<nf;i++) {
+		double *pp=fpl.data()+4*i;
+		const double *ap=pts.data()+3*tri[3*fo[i]];
+		*pp=v[3*i];pp[1]=v[3*i+1];pp[2]=v[3*i+2];
+		pp[3]=*pp**ap+pp[1]*ap[1]+pp[2]*ap[2];
+	}
+}
+
+/** Returns the planes of the faces of the cell.
+ * \param[out] v the vector to store the results in. For each face, the
+ *               outward unit normal (nx,ny,nz) and the distance d of the
+ *               plane from the particle are stored, so that a point x
+ *               relative to the particle is on the inner side of the face
+ *               if n.x<=d. */
+void flat_cell::face_planes(std::vector<double> &v) {
+	setup_planes();
+	v=fpl;
+}
+
+/** Tests whether a batch of points are inside the cell. The points are
+ * tested against one face plane at a time, so that the inner loop over the
+ * points has no branches and can be vectorized. Points on the boundary of the
+ * cell are counted as inside.
+ * \param[in] n the number of points.
+ * \param[in] x an array of the point positions relative to the particle,
+ *              three per point.
+ * \param[out] in an array of n values, in which to store whether each point
+ *               is inside the cell. */
+void flat_cell::contains(int n,const double *x,bool *in) {
+	int i;
+	setup_planes();
+	for(i=0;i<n;i++) in[i]=true;
+	for(const double *pp=fpl.data(),*pe=pp+4*nf;pp<pe;pp+=4) {
+		double nx=*pp,ny=pp[1],nz=pp[2],d=pp[3];
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+		for(i=0;i<n;i++) in[i]&=nx*x[3*i]+ny*x[3*i+1]+nz*x[3*i+2]<=d;
+	}
+}
+
+/** Computes the cumulative volumes of the tetrahedra formed by each triangle
+ * and the first vertex of the cell, if they have not already been computed
+ * for this cell. Since the cell is convex, all of the volumes are
+ * non-negative, and those of the triangles on faces touching the first vertex
+ * are zero. */
+void flat_cell::setup_tetrahedra() {
+	if(!tv.empty()||nt==0) return;
+	const double *ax=tc.data(),*ay=ax+nt,*az=ay+nt,*bx=az+nt,*by=bx+nt,
+	      *bz=by+nt,*cx=bz+nt,*cy=cx+nt,*cz=cy+nt;
+	double ox=pts[0],oy=pts[1],oz=pts[2],ux,uy,uz,vx,vy,vz,wx,wy,wz,*vp=ts.data();
+#ifdef _OPENMP
+#pragma omp simd private(ux,uy,uz,vx,vy,vz,wx,wy,wz)
+#endif
+	for(int t=0;t<nt;t++) {
+		ux=ax[t]-ox;uy=ay[t]-oy;uz=az[t]-oz;
+		vx=bx[t]-ox;vy=by[t]-oy;vz=bz[t]-oz;
+		wx=cx[t]-ox;wy=cy[t]-oy;wz=cz[t]-oz;
+		vp[t]=fabs(ux*(vy*wz-vz*wy)+uy*(vz*wx-vx*wz)+uz*(vx*wy-vy*wx));
+	}
+	tv.resize(nt);
+	double s=0;
+	for(int t=0;t<nt;t++) {s+=vp[t];tv[t]=s;}
+}
+
+/** Generates uniformly distributed random points inside the cell. For each
+ * point, a tetrahedron of the decomposition is chosen with probability
+ * proportional to its volume, and a point is chosen uniformly within it by
+ * folding a point of the unit cube into the unit simplex, so that no samples
+ * are rejected.
+ * \param[in] n the number of points to generate.
+ * \param[out] x an array in which to store the point positions relative to
+ *               the particle, three per point.
+ * \param[in] gen the random number generator to use. */
+void flat_cell::sample(int n,double *x,std::mt19937_64 &gen) {
+	setup_tetrahedra();
+	if(nt==0||tv[nt-1]<=0) voro_fatal_error("Cannot sample points in a cell with no volume",VOROPP_INTERNAL_ERROR);
+	std::uniform_real_distribution<double> un(0,1);
+	const double *ax=tc.data(),*ay=ax+nt,*az=ay+nt,*bx=az+nt,*by=bx+nt,
+	      *bz=by+nt,*cx=bz+nt,*cy=cx+nt,*cz=cy+nt;
+	double ox=pts[0],oy=pts[1],oz=pts[2],r,s,t,u,w;
+	for(int i=0;i<n;i++,x+=3) {
+
+		// Choose a tetrahedron, with probability proportional to its
+		// volume
+		int l=std::upper_bound(tv.begin(),tv.end(),un(gen)*tv[nt-1])-tv.begin();
+		if(l==nt) l=nt-1;
+
+		// Choose a point in the unit simplex
+		s=un(gen);t=un(gen);u=un(gen);
+		if(s+t>1) {s=1-s;t=1-t;}
+		if(t+u>1) {w=u;u=1-s-t;t=1-w;}
+		else if(s+t+u>1) {w=u;u=s+t+u-1;s=1-t-w;}
+		r=1-s-t-u;
+		*x=r*ox+s*ax[l]+t*bx[l]+u*cx[l];
+		x[1]=r*oy+s*ay[l]+t*by[l]+u*cy[l];
+		x[2]=r*oz+s*az[l]+t*bz[l]+u*cz[l];
+	}
+}
+
+}
@@ -0,0 +1,95 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file flat_cell.hh
+ * \brief Header file for the flat_cell class. */
+
+#ifndef VOROPP_FLAT_CELL_HH
+#define VOROPP_FLAT_CELL_HH
+
+#include <cstdio>
+#include <vector>
+#include <random>
+
+#include "config.hh"
+#include "common.hh"
+#include "cell.hh"
+
+namespace voro {
+
+/** \brief A class holding a Voronoi cell as a flattened list of triangles.
+ *
+ * The statistics routines of the voronoicell classes trace around the edge
+ * graph of the cell, marking the edges as they go, and evaluate the
+ * contribution of each triangle as it is found. This class instead converts
+ * the faces of a cell into triangle fans in a single traversal, storing the
+ * vertex indices of each triangle in a contiguous array, with an offset
+ * array marking where the triangles of each face start. The corner positions
+ * of the triangles are also stored as nine separate coordinate arrays, so
+ * that the volume, centroid, face area, and normal computations are straight
+ * loops over the triangles that the compiler can vectorize.
+ *
+ * The vertex positions are relative to the particle, as in the vertices()
+ * routine of the voronoicell classes. The faces are in the same order as
+ * those returned by the face_areas() and neighbors() routines. Several
+ * statistics of the same cell can be computed from a single flattening.
+ *
+ * The class can also test whether points are inside the cell, using the
+ * planes of the faces, and generate uniformly distributed random points
+ * inside the cell, by splitting it into tetrahedra that share a vertex. The
+ * face planes and the tetrahedron volumes are computed the first time that
+ * they are needed, and are kept until the next flattening. */
+class flat_cell {
+	public:
+		/** The number of faces. */
+		int nf;
+		/** The number of triangles. */
+		int nt;
+		/** The offsets of the triangles of each face, so that the
+		 * triangles of face i are those from fo[i] to fo[i+1]-1. */
+		std::vector<int> fo;
+		/** The vertex indices of the triangles, three per triangle.
+		 * The first vertex of each triangle is the apex of the fan
+		 * of its face. */
+		std::vector<int> tri;
+		/** The vertex positions, three per vertex. */
+		std::vector<double> pts;
+		flat_cell();
+		void flatten(voronoicell_base &c);
+		double volume();
+		double surface_area();
+		void centroid(double &cx,double &cy,double &cz,double &vol);
+		void face_areas(std::vector<double> &v);
+		void normals(std::vector<double> &v);
+		void face_planes(std::vector<double> &v);
+		void contains(int n,const double *x,bool *in);
+		void sample(int n,double *x,std::mt19937_64 &gen);
+		/** Returns the number of faces.
+		 * \return The number of faces. */
+		inline int number_of_faces() {return nf;}
+		/** Returns the number of triangles.
+		 * \return The number of triangles. */
+		inline int number_of_triangles() {return nt;}
+	private:
+		/** The corner positions of the triangles, stored as nine
+		 * consecutive arrays of length nt, holding the x, y, and z
+		 * coordinates of the first, second, and third corners. */
+		std::vector<double> tc;
+		/** A scratch array holding one value per triangle. */
+		std::vector<double> ts;
+		/** A scratch vector for the face vertex list. */
+		std::vector<int> vi;
+		/** The planes of the faces, each stored as four entries
+		 * giving the outward unit normal and the distance of the
+		 * plane from the particle. */
+		std::vector<double> fpl;
+		/** The cumulative volumes of the tetrahedra formed by each
+		 * triangle and the first vertex of the cell. */
+		std::vector<double> tv;
+		void triangle_normals(double *wx,double *wy,double *wz);
+		void setup_planes();
+		void setup_tetrahedra();
+};
+
+}
+
+#endif
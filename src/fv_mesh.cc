@@ -0,0 +1,111 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file fv_mesh.cc
+ * \brief Function implementations for the fv_mesh class. */
+
+#include <algorithm>
+
+#include "fv_mesh.hh"
+
+namespace voro {
+
+/** Removes all cells and faces from the mesh. */
+void fv_mesh::clear() {
+	nc=nf=0;
+	id.clear();vol.clear();cen.clear();
+	owner.clear();neighbor.clear();area.clear();normal.clear();fcen.clear();
+	cf_off.clear();cf.clear();
+}
+
+/** Finds the cell with a given particle ID.
+ * \param[in] ic a list of the particle IDs and cell indices, sorted by ID.
+ * \param[in] pid the particle ID to search for.
+ * \return The index of the cell. */
+int fv_mesh::find_cell(std::vector<std::pair<int,int> > &ic,int pid) {
+	std::vector<std::pair<int,int> >::iterator ip=std::lower_bound(ic.begin(),ic.end(),std::make_pair(pid,-1));
+	if(ip==ic.end()||ip->first!=pid) voro_fatal_error("Neighboring particle not found in the mesh",VOROPP_INTERNAL_ERROR);
+	return ip->second;
+}
+
+/** Links the faces reported by the cells, using the staged face information
+ * from the parallel computation. The cells are processed in order. A face of
+ * cell a that is shared with a cell b of higher index is stored as a new face
+ * owned by a. A face shared with a cell b of lower index is matched to the
+ * unclaimed face of b with neighbor a whose normal is closest to being
+ * opposite, and a new face is only stored if no such face exists. */
+void fv_mesh::link() {
+	int a,b,e,f,g,i,ijk,s;
+	double *dp,best,d;
+	std::vector<char> claimed;
+
+	// Make a list of the particle IDs and cell indices sorted by ID, for
+	// looking up the neighbors
+	std::vector<std::pair<int,int> > ic(nc);
+	for(a=0;a<nc;a++) ic[a]=std::make_pair(id[a],a);
+	std::sort(ic.begin(),ic.end());
+
+	cf_off.resize(nc+1);
+	for(a=ijk=0;ijk<(int) bo.size();ijk++) {
+		e=ijk+1<(int) bo.size()?bo[ijk+1]:nc;
+		for(i=0,dp=sd[ijk].data();a<e;a++) {
+			cf_off[a]=cf.size();
+			for(s=0;s<nfc[a];s++,i++,dp+=7) {
+				b=sn[ijk][i];
+				if(b>=0) b=find_cell(ic,b);
+
+				// Search for a matching face reported by the
+				// neighboring cell
+				if(b>=0&&b<=a) {
+					g=-1;best=0;
+					for(int j=cf_off[b];j<(b==a?(int) cf.size():cf_off[b+1]);j++) {
+						f=cf[j];
+						if(owner[f]!=b||neighbor[f]!=a||claimed[f]) continue;
+						d=-(normal[3*f]*dp[1]+normal[3*f+1]*dp[2]+normal[3*f+2]*dp[3]);
+						if(d>best) {best=d;g=f;}
+					}
+					if(g>=0) {
+						claimed[g]=1;
+						cf.push_back(g);
+						continue;
+					}
+				}
+
+				// Store a new face owned by this cell
+				cf.push_back(nf++);
+				owner.push_back(a);
+				neighbor.push_back(b>=0?b:sn[ijk][i]);
+				area.push_back(*dp);
+				normal.insert(normal.end(),dp+1,dp+4);
+				fcen.insert(fcen.end(),dp+4,dp+7);
+				claimed.push_back(0);
+			}
+		}
+	}
+	cf_off[nc]=cf.size();
+
+	// Free the staging areas
+	std::vector<std::vector<int> >().swap(sn);
+	std::vector<std::vector<double> >().swap(sd);
+	std::vector<int>().swap(nfc);
+	std::vector<int>().swap(bo);
+}
+
+/** Prints a summary of the mesh, giving the number of cells, the numbers of
+ * interior and boundary faces, and the number of faces that are only reported
+ * by one of their two cells.
+ * \param[in] fp the file handle to write to. */
+void fv_mesh::print_summary(FILE *fp) {
+	int f,ni=0,nh=0;
+	std::vector<int> rc(nf,0);
+	for(int j=0;j<(int) cf.size();j++) rc[cf[j]]++;
+	for(f=0;f<nf;f++) if(interior(f)) {
+		ni++;
+		if(rc[f]==1&&owner[f]!=neighbor[f]) nh++;
+	}
+	fprintf(fp,"Cells           : %d\n"
+		   "Interior faces  : %d\n"
+		   "Boundary faces  : %d\n"
+		   "One-sided faces : %d\n",nc,ni,nf-ni,nh);
+}
+
+}
@@ -0,0 +1,154 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file fv_mesh.hh
+ * \brief Header file for the fv_mesh class. */
+
+#ifndef VOROPP_FV_MESH_HH
+#define VOROPP_FV_MESH_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+#include "common.hh"
+#include "cell.hh"
+#include "order_parallel.hh"
+
+namespace voro {
+
+/** \brief A class holding the Voronoi cells of a container as a finite-volume
+ * mesh.
+ *
+ * Finite-volume solvers use the Voronoi cells as control volumes, and need
+ * the volume and centroid of each cell, together with the area, normal,
+ * centroid, and the pair of cells on either side of each face. This class
+ * assembles this information for all of the particles in a container. The
+ * cells are computed in parallel, and the geometry of each cell is found in a
+ * single traversal using the face_geometry() routine of the
+ * voronoicell_neighbor class. The faces of the cells are then linked
+ * serially, so that each face between two cells is stored once.
+ *
+ * The cells are numbered in the order of the blocks of the container, which
+ * is the order used by the c_loop_all class, and the particle ID of each cell
+ * is stored. Each face has an owner cell and a neighbor, and its normal points
+ * from the owner to the neighbor. For faces between two cells, the owner is
+ * the cell with the lower index. For faces on the container boundary or on a
+ * wall, the neighbor is the negative ID of the boundary or wall, as given by
+ * the neighbors() routine of the voronoicell_neighbor class. The faces of
+ * each cell are stored in compressed sparse row format.
+ *
+ * Since each cell is computed individually, the neighbor information may not
+ * be exactly symmetric for very small faces. A face that is only reported by
+ * one of its two cells is stored, but only appears in the face list of the
+ * cell that reported it. Curved walls are approximated by a separate plane
+ * for each cell, so two cells next to a wall may see slightly different
+ * versions of the face between them; the stored face is the one computed by
+ * its owner. In periodic containers, the centroid of a face is given in the
+ * frame of its owner cell. The particle IDs are assumed to be unique. */
+class fv_mesh {
+	public:
+		/** The number of cells. */
+		int nc;
+		/** The number of faces. */
+		int nf;
+		/** The particle IDs of the cells. */
+		std::vector<int> id;
+		/** The volumes of the cells. Cells that could not be computed
+		 * have zero volume and no faces. */
+		std::vector<double> vol;
+		/** The centroids of the cells, three per cell. */
+		std::vector<double> cen;
+		/** The owner cell of each face. */
+		std::vector<int> owner;
+		/** The neighbor of each face, which is either the index of a
+		 * cell, or the negative ID of a boundary or wall. */
+		std::vector<int> neighbor;
+		/** The areas of the faces. */
+		std::vector<double> area;
+		/** The unit normals of the faces, three per face, pointing
+		 * from the owner to the neighbor. */
+		std::vector<double> normal;
+		/** The centroids of the faces, three per face. */
+		std::vector<double> fcen;
+		/** The offsets of the face lists of the cells, so that the
+		 * faces of cell i are listed from cf[cf_off[i]] to
+		 * cf[cf_off[i+1]-1]. */
+		std::vector<int> cf_off;
+		/** The face lists of the cells. */
+		std::vector<int> cf;
+		fv_mesh() : nc(0), nf(0) {}
+		void clear();
+		/** Computes the Voronoi cells of all of the particles in a
+		 * container, and assembles them into a finite-volume mesh.
+		 * This routine can be used with the container and
+		 * container_poly classes.
+		 * \param[in] con the container class to use.
+		 * \param[in] nt the number of threads to use, or zero to use
+		 *               the default. */
+		template<class c_class>
+		void assemble(c_class &con,int nt=0) {
+			int ijk,q,l;
+			double *pp;
+			if(nt<=0) nt=voro_max_threads();
+			clear();
+
+			// Number the cells in block order, and initialize the
+			// centroids to the particle positions
+			bo.resize(con.nxyz);
+			for(ijk=0;ijk<con.nxyz;ijk++) {bo[ijk]=nc;nc+=con.co[ijk];}
+			id.resize(nc);vol.assign(nc,0);cen.resize(3*nc);nfc.assign(nc,0);
+			for(l=ijk=0;ijk<con.nxyz;ijk++) for(q=0;q<con.co[ijk];q++,l++) {
+				id[l]=con.id[ijk][q];pp=con.p[ijk]+con.ps*q;
+				cen[3*l]=*pp;cen[3*l+1]=pp[1];cen[3*l+2]=pp[2];
+			}
+
+			// Compute the cells in parallel, storing the faces of
+			// each block in its own staging area, which is only
+			// written by the thread that computes the block
+			sn.assign(con.nxyz,std::vector<int>());
+			sd.assign(con.nxyz,std::vector<double>());
+			std::vector<std::vector<int> > tn(nt);
+			std::vector<std::vector<double> > td(nt);
+			compute_all_parallel<voronoicell_neighbor>(con,[&](voronoicell_neighbor &c,int ijk,int q) {
+				int t=voro_thread_num(),l=bo[ijk]+q;
+				double cv[4],*pp=con.p[ijk]+con.ps*q,*dp;
+				std::vector<int> &nb=tn[t];
+				std::vector<double> &fd=td[t];
+				c.face_geometry(nb,fd,cv);
+				vol[l]=*cv;
+				cen[3*l]+=cv[1];cen[3*l+1]+=cv[2];cen[3*l+2]+=cv[3];
+				nfc[l]=nb.size();
+				sn[ijk].insert(sn[ijk].end(),nb.begin(),nb.end());
+				for(dp=fd.data();dp<fd.data()+fd.size();dp+=7) {
+					sd[ijk].insert(sd[ijk].end(),dp,dp+4);
+					sd[ijk].push_back(dp[4]+*pp);
+					sd[ijk].push_back(dp[5]+pp[1]);
+					sd[ijk].push_back(dp[6]+pp[2]);
+				}
+			},nt);
+			link();
+		}
+		/** Returns whether a face lies between two cells.
+		 * \param[in] f the index of the face.
+		 * \return True if the face is between two cells, false if it
+		 *         is on a boundary or wall. */
+		inline bool interior(int f) {return neighbor[f]>=0;}
+		void print_summary(FILE *fp=stdout);
+	private:
+		/** The index of the first cell in each block. */
+		std::vector<int> bo;
+		/** The number of faces reported by each cell. */
+		std::vector<int> nfc;
+		/** The neighbor IDs of the faces reported by the cells in each
+		 * block. */
+		std::vector<std::vector<int> > sn;
+		/** The geometry of the faces reported by the cells in each
+		 * block, seven entries per face. */
+		std::vector<std::vector<double> > sd;
+		void link();
+		int find_cell(std::vector<std::pair<int,int> > &ic,int pid);
+};
+
+}
+
+#endif
@@ -0,0 +1,387 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file kinetic.cc
+ * \brief Function implementations for the kinetic_container class. */
+
+#include <cmath>
+#include <algorithm>
+
+#include "kinetic.hh"
+#include "order_parallel.hh"
+
+namespace voro {
+
+/** The class constructor sets up the geometry of the container.
+ * \param[in] (ax_,bx_) the minimum and maximum x coordinates.
+ * \param[in] (ay_,by_) the minimum and maximum y coordinates.
+ * \param[in] (az_,bz_) the minimum and maximum z coordinates.
+ * \param[in] (nx_,ny_,nz_) the number of grid blocks in each of the three
+ *                          coordinate directions, for the container that is
+ *                          used to compute the cells.
+ * \param[in] (xperiodic_,yperiodic_,zperiodic_) flags setting whether the
+ *                                               container is periodic in each
+ *                                               coordinate direction.
+ * \param[in] horizon_ the length of time ahead for which the certificates
+ *                     are checked.
+ * \param[in] t_ the initial time. */
+kinetic_container::kinetic_container(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+		int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,double horizon_,double t_)
+	: ax(ax_), bx(bx_), ay(ay_), by(by_), az(az_), bz(bz_), nx(nx_), ny(ny_), nz(nz_),
+	xperiodic(xperiodic_), yperiodic(yperiodic_), zperiodic(zperiodic_), horizon(horizon_),
+	t(t_), np(0), recomputed(0) {}
+
+/** Adds a particle to the container. Its cell is computed at the next call to
+ * advance().
+ * \param[in] n the numerical ID of the particle.
+ * \param[in] (x,y,z) the position of the particle at the current time.
+ * \param[in] (vx,vy,vz) the velocity of the particle. */
+void kinetic_container::put(int n,double x,double y,double z,double vx,double vy,double vz) {
+	ids.push_back(n);
+	pos.push_back(x);pos.push_back(y);pos.push_back(z);
+	vel.push_back(vx);vel.push_back(vy);vel.push_back(vz);
+	nb.push_back(std::vector<int>());
+	ev.push_back(t);due.push_back(0);
+	remap(pos.data()+3*np);
+	mark(np++);
+}
+
+/** Changes the velocity of a particle. The certificates that involve the
+ * particle are no longer valid, so the cells of the particle, its neighbors,
+ * and their neighbors are recomputed at the next call to advance().
+ * \param[in] i the index of the particle.
+ * \param[in] (vx,vy,vz) the new velocity. */
+void kinetic_container::set_velocity(int i,double vx,double vy,double vz) {
+	double *vp=vel.data()+3*i;
+	*vp=vx;vp[1]=vy;vp[2]=vz;
+	mark(i);
+	for(std::vector<int>::iterator jp=nb[i].begin();jp!=nb[i].end();jp++) if(*jp>=0) {
+		mark(*jp);
+		for(std::vector<int>::iterator kp=nb[*jp].begin();kp!=nb[*jp].end();kp++) if(*kp>=0) mark(*kp);
+	}
+}
+
+/** Moves the particles forward in time, recomputing the cells whose
+ * certificates fail before the new time. The recomputation is carried out
+ * in parallel, first finding the new neighbors of all of the cells that need
+ * to be recomputed, and then finding their certificates, since these depend
+ * on the neighbors of the neighboring cells.
+ * \param[in] t_ the new time, which must not be earlier than the current
+ *               time.
+ * \return The number of cells that were recomputed. */
+int kinetic_container::advance(double t_) {
+	int i,k,s,n0;
+	if(t_<t) voro_fatal_error("Kinetic container cannot move backward in time",VOROPP_INTERNAL_ERROR);
+	move(t_-t);t=t_;
+
+	// Mark the cells whose certificates have failed, skipping the queue
+	// entries that have been superseded
+	while(!pq.empty()&&pq.top().first<=t) {
+		i=pq.top().second;
+		if(pq.top().first==ev[i]) mark(i);
+		pq.pop();
+	}
+	if(pend.empty()) return 0;
+
+	// Set up a container with the current particle positions
+	container con(ax,bx,ay,by,az,bz,nx,ny,nz,xperiodic,yperiodic,zperiodic,8);
+	particle_order po;
+	for(i=0;i<np;i++) con.put(po,i,pos[3*i],pos[3*i+1],pos[3*i+2]);
+
+	// Recompute the neighbors of the cells that are due. For each vertex
+	// of order three, the faces that meet there are stored, followed by
+	// the number of faces at the far ends of its edges, and then the
+	// faces themselves. Any cell that gains or loses one of these cells
+	// as a neighbor is recomputed in a further pass.
+	std::vector<std::vector<int> > vd,onb;
+	for(s=0;s<(int) pend.size();s=n0) {
+		n0=pend.size();
+		particle_order bo;
+		for(k=s;k<n0;k++) {i=pend[k];bo.add(po.o[2*i],po.o[2*i+1]);}
+		vd.resize(n0);onb.resize(n0);
+		compute_order_parallel<voronoicell_neighbor>(con,bo,[&](voronoicell_neighbor &c,int,int,int l) {
+			int i=pend[s+l],j,k,u,v,f0,f1,f2,ci;
+			std::vector<int> &v_=vd[s+l],&nn=nb[i];
+			onb[s+l].swap(nn);
+			c.neighbors(nn);
+			std::sort(nn.begin(),nn.end());
+			nn.erase(std::unique(nn.begin(),nn.end()),nn.end());
+			std::vector<int>::iterator ip=std::lower_bound(nn.begin(),nn.end(),i);
+			if(ip!=nn.end()&&*ip==i) nn.erase(ip);
+			for(v=0;v<c.p;v++) if(c.nu[v]==3) {
+				f0=c.ne[v][0];f1=c.ne[v][1];f2=c.ne[v][2];
+				v_.push_back(f0);v_.push_back(f1);v_.push_back(f2);
+				ci=v_.size();v_.push_back(0);
+				for(j=0;j<3;j++) {
+					u=c.ed[v][j];
+					for(k=0;k<c.nu[u];k++) if(c.ne[u][k]!=f0&&c.ne[u][k]!=f1&&c.ne[u][k]!=f2) {
+						v_.push_back(c.ne[u][k]);v_[ci]++;
+					}
+				}
+			}
+		});
+		for(k=s;k<n0;k++) {
+			std::vector<int> dif;
+			i=pend[k];
+			std::set_symmetric_difference(onb[k].begin(),onb[k].end(),nb[i].begin(),nb[i].end(),std::back_inserter(dif));
+			for(std::vector<int>::iterator jp=dif.begin();jp!=dif.end();jp++) if(*jp>=0) mark(*jp);
+		}
+	}
+
+	// Compute the certificates of the recomputed cells, and add their
+	// failure times to the queue
+	n0=pend.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,order_chunk_size)
+#endif
+	for(k=0;k<n0;k++) ev[pend[k]]=t+certificates(pend[k],vd[k]);
+	for(k=0;k<n0;k++) {
+		i=pend[k];
+		if(ev[i]<=t) ev[i]=nextafter(t,large_number);
+		pq.push(std::make_pair(ev[i],i));
+		due[i]=0;
+	}
+	recomputed+=n0;
+	pend.clear();
+	return n0;
+}
+
+/** Returns the earliest time at which the neighbors of a cell may change.
+ * \return The time, or the current time if there are cells that are due to
+ *         be recomputed. */
+double kinetic_container::next_event() {
+	if(!pend.empty()) return t;
+	while(!pq.empty()&&pq.top().first!=ev[pq.top().second]) pq.pop();
+	return pq.empty()?large_number:pq.top().first;
+}
+
+/** Computes the Voronoi cell of a particle at the current time, using only its
+ * stored neighbors. This is much faster than a full computation, and gives
+ * the correct cell as long as the particle's certificates have not failed.
+ * \param[in,out] c a reference to a voronoicell_neighbor object to store the
+ *                  cell in.
+ * \param[in] i the index of the particle.
+ * \return False if the cell was removed entirely, true otherwise. */
+bool kinetic_container::compute_cell(voronoicell_neighbor &c,int i) {
+	double *pp=pos.data()+3*i,r[3];
+	c.init(xperiodic?-0.5*(bx-ax):ax-*pp,xperiodic?0.5*(bx-ax):bx-*pp,
+	       yperiodic?-0.5*(by-ay):ay-pp[1],yperiodic?0.5*(by-ay):by-pp[1],
+	       zperiodic?-0.5*(bz-az):az-pp[2],zperiodic?0.5*(bz-az):bz-pp[2]);
+	for(std::vector<int>::iterator jp=nb[i].begin();jp!=nb[i].end();jp++) if(*jp>=0) {
+		displacement(i,*jp,r);
+		if(!c.nplane(*r,r[1],r[2],*r*(*r)+r[1]*r[1]+r[2]*r[2],*jp)) return false;
+	}
+	return true;
+}
+
+/** Moves the particles along their velocities.
+ * \param[in] dt the time interval. */
+void kinetic_container::move(double dt) {
+	double *pp=pos.data(),*vp=vel.data(),*pe=pp+3*np;
+	for(;pp<pe;pp+=3,vp+=3) {
+		*pp+=*vp*dt;pp[1]+=vp[1]*dt;pp[2]+=vp[2]*dt;
+		remap(pp);
+	}
+}
+
+/** Remaps a particle position into the container in the periodic directions,
+ * and checks that it is inside the container in the other directions.
+ * \param[in,out] pp the position vector. */
+void kinetic_container::remap(double *pp) {
+	if(xperiodic) *pp-=(bx-ax)*floor((*pp-ax)/(bx-ax));
+	else if(*pp<ax||*pp>bx) voro_fatal_error("Particle outside the kinetic container",VOROPP_INTERNAL_ERROR);
+	if(yperiodic) pp[1]-=(by-ay)*floor((pp[1]-ay)/(by-ay));
+	else if(pp[1]<ay||pp[1]>by) voro_fatal_error("Particle outside the kinetic container",VOROPP_INTERNAL_ERROR);
+	if(zperiodic) pp[2]-=(bz-az)*floor((pp[2]-az)/(bz-az));
+	else if(pp[2]<az||pp[2]>bz) voro_fatal_error("Particle outside the kinetic container",VOROPP_INTERNAL_ERROR);
+}
+
+/** Computes the displacement from one particle to another, using the nearest
+ * periodic image.
+ * \param[in] (i,j) the indices of the two particles.
+ * \param[out] r the displacement vector. */
+void kinetic_container::displacement(int i,int j,double *r) {
+	double *pi=pos.data()+3*i,*pj=pos.data()+3*j;
+	*r=*pj-*pi;r[1]=pj[1]-pi[1];r[2]=pj[2]-pi[2];
+	if(xperiodic) *r-=(bx-ax)*round(*r/(bx-ax));
+	if(yperiodic) r[1]-=(by-ay)*round(r[1]/(by-ay));
+	if(zperiodic) r[2]-=(bz-az)*round(r[2]/(bz-az));
+}
+
+/** Computes the plane of a face of a cell as a function of time, relative to
+ * the particle. The cell lies on the side where n.x<=b, where the normal n
+ * is linear in time and b is quadratic.
+ * \param[in] i the index of the particle.
+ * \param[in] f the particle index or boundary ID of the face.
+ * \param[out] pn the coefficients of the three components of the normal.
+ * \param[out] pb the coefficients of the right hand side. */
+void kinetic_container::face_plane(int i,int f,double (*pn)[3],double *pb) {
+	int c;
+	for(c=0;c<3;c++) pn[c][0]=pn[c][1]=pn[c][2]=0;
+	if(f>=0) {
+		double r[3],*vi=vel.data()+3*i,*vf=vel.data()+3*f,u[3]={*vf-*vi,vf[1]-vi[1],vf[2]-vi[2]};
+		displacement(i,f,r);
+		for(c=0;c<3;c++) {pn[c][0]=r[c];pn[c][1]=u[c];}
+		*pb=0.5*(*r*(*r)+r[1]*r[1]+r[2]*r[2]);
+		pb[1]=*r*(*u)+r[1]*u[1]+r[2]*u[2];
+		pb[2]=0.5*(*u*(*u)+u[1]*u[1]+u[2]*u[2]);
+		return;
+	}
+
+	// The container boundaries are fixed, so they move relative to the
+	// particle, except in the periodic directions where the initial
+	// planes are centered on the particle
+	bool up=((-1-f)&1)==1,per;
+	double lo,hi;
+	c=(-1-f)>>1;
+	switch(c) {
+		case 0: lo=ax;hi=bx;per=xperiodic;break;
+		case 1: lo=ay;hi=by;per=yperiodic;break;
+		default: lo=az;hi=bz;per=zperiodic;
+	}
+	pn[c][0]=up?1:-1;pb[2]=0;
+	if(per) {*pb=0.5*(hi-lo);pb[1]=0;}
+	else if(up) {*pb=hi-pos[3*i+c];pb[1]=-vel[3*i+c];}
+	else {*pb=pos[3*i+c]-lo;pb[1]=vel[3*i+c];}
+}
+
+/** Computes the time until the first certificate of a cell fails. For each
+ * vertex, the position is given by Cramer's rule applied to the planes of
+ * the three faces that meet there, and the condition that the vertex lies
+ * inside the plane of a candidate is multiplied through by the determinant of
+ * the system, giving a polynomial in time.
+ * \param[in] i the index of the particle.
+ * \param[in] vd the vertex information of the cell, in the format described
+ *               in advance().
+ * \return The time until the first failure, or the horizon if there is no
+ *         failure before then. */
+double kinetic_container::certificates(int i,std::vector<int> &vd) {
+	int j,k,c,r,f[3],na;
+	double tmin=horizon,e[3][3][3],pb[3][3],qn[3][3],qb[3],d[max_degree+1],
+	       dc[3][max_degree+1],g[max_degree+1],s0;
+	std::vector<int> cand,tmp;
+	for(std::vector<int>::iterator vp=vd.begin();vp!=vd.end();vp+=4+na) {
+		f[0]=*vp;f[1]=vp[1];f[2]=vp[2];na=vp[3];
+
+		// Set up the planes of the three faces, and compute the
+		// determinant of the system and the Cramer numerators
+		for(r=0;r<3;r++) face_plane(i,f[r],e[r],pb[r]);
+		poly_det(e,d);
+		if(*d==0) continue;
+		s0=*d>0?1:-1;
+		for(c=0;c<3;c++) {
+			double ec[3][3][3];
+			for(r=0;r<3;r++) for(j=0;j<3;j++) for(k=0;k<3;k++) ec[r][j][k]=j==c?pb[r][k]:e[r][j][k];
+			poly_det(ec,dc[c]);
+		}
+
+		// Assemble the candidates, from the far ends of the edges and
+		// from the common neighbors of the particles at the vertex
+		cand.assign(vp+4,vp+4+na);
+		bool first=true;
+		for(r=0;r<3;r++) if(f[r]>=0) {
+			if(first) {tmp=nb[f[r]];first=false;}
+			else {
+				std::vector<int> t2;
+				std::set_intersection(tmp.begin(),tmp.end(),nb[f[r]].begin(),nb[f[r]].end(),std::back_inserter(t2));
+				tmp.swap(t2);
+			}
+		}
+		if(!first) cand.insert(cand.end(),tmp.begin(),tmp.end());
+
+		// Compute the failure time of each certificate
+		for(std::vector<int>::iterator cp=cand.begin();cp!=cand.end();cp++) {
+			if(*cp==i||*cp==f[0]||*cp==f[1]||*cp==f[2]) continue;
+			face_plane(i,*cp,qn,qb);
+			for(k=0;k<=max_degree;k++) g[k]=0;
+			for(j=0;j<=max_degree-2;j++) {
+				for(k=0;k<3;k++) g[j+k]+=d[j]*qb[k];
+				for(c=0;c<3;c++) for(k=0;k<2;k++) g[j+k]-=dc[c][j]*qn[c][k];
+			}
+			for(k=0;k<=max_degree;k++) g[k]*=s0;
+			tmin=first_failure(g,max_degree,tmin);
+		}
+	}
+	return tmin;
+}
+
+/** Finds the first time at which a certificate polynomial becomes negative.
+ * \param[in] g the coefficients of the polynomial.
+ * \param[in] n the degree of the polynomial.
+ * \param[in] h the end of the time interval to consider.
+ * \return The first time in the interval at which the polynomial changes
+ *         from positive to negative, or h if there is no such time. */
+double kinetic_container::first_failure(const double *g,int n,double h) {
+	double ro[max_degree];
+	int k,nr=poly_roots(g,n,0,h,ro);
+	for(k=0;k<nr;k++)
+		if(poly_eval(g,n,0.5*(ro[k]+(k+1<nr?ro[k+1]:h)))<0) return ro[k];
+	return h;
+}
+
+/** Finds the roots of a polynomial within an interval, by recursively finding
+ * the roots of its derivative, which divide the interval into pieces where
+ * the polynomial is monotonic, and then bisecting each piece where the
+ * polynomial changes sign.
+ * \param[in] c the coefficients of the polynomial.
+ * \param[in] n the degree of the polynomial.
+ * \param[in] (a,b) the interval to search.
+ * \param[out] r an array in which to store the roots, in increasing order.
+ * \return The number of roots found. */
+int kinetic_container::poly_roots(const double *c,int n,double a,double b,double *r) {
+	while(n>0&&c[n]==0) n--;
+	if(n==0) return 0;
+	if(n==1) {
+		double x=-*c/c[1];
+		if(x>a&&x<b) {*r=x;return 1;}
+		return 0;
+	}
+	double dp[max_degree]={},cr[max_degree]={},x0=a,x1,f0,f1,lo,hi,xm,fm;
+	int i,k,nc,nr=0;
+	for(k=1;k<=n;k++) dp[k-1]=k*c[k];
+	nc=poly_roots(dp,n-1,a,b,cr);
+	f0=poly_eval(c,n,a);
+	for(i=0;i<=nc;i++,x0=x1,f0=f1) {
+		x1=i<nc?cr[i]:b;
+		f1=poly_eval(c,n,x1);
+		if((f0<0&&f1>0)||(f0>0&&f1<0)) {
+			lo=x0;hi=x1;
+			for(k=0;k<128;k++) {
+				xm=0.5*(lo+hi);
+				if(xm<=lo||xm>=hi) break;
+				fm=poly_eval(c,n,xm);
+				if(fm!=0&&(fm<0)==(f0<0)) lo=xm;else hi=xm;
+			}
+			r[nr++]=0.5*(lo+hi);
+		} else if(f1==0&&i<nc) r[nr++]=x1;
+	}
+	return nr;
+}
+
+/** Evaluates a polynomial using Horner's method.
+ * \param[in] c the coefficients of the polynomial.
+ * \param[in] n the degree of the polynomial.
+ * \param[in] x the point at which to evaluate it.
+ * \return The value. */
+double kinetic_container::poly_eval(const double *c,int n,double x) {
+	double s=c[n];
+	for(int k=n-1;k>=0;k--) s=s*x+c[k];
+	return s;
+}
+
+/** Computes the determinant of a three by three matrix whose entries are
+ * quadratic polynomials.
+ * \param[in] e the coefficients of the matrix entries.
+ * \param[out] d the coefficients of the determinant. */
+void kinetic_container::poly_det(double (*e)[3][3],double *d) {
+	int i,j,k,a,b;
+	double m[5];
+	for(k=0;k<=max_degree;k++) d[k]=0;
+	for(i=0;i<3;i++) {
+		a=i==0?1:0;b=i==2?1:2;
+		for(k=0;k<5;k++) m[k]=0;
+		for(j=0;j<3;j++) for(k=0;k<3;k++) m[j+k]+=e[1][a][j]*e[2][b][k]-e[1][b][j]*e[2][a][k];
+		for(j=0;j<3;j++) for(k=0;k<5;k++) d[j+k]+=(i==1?-e[0][i][j]:e[0][i][j])*m[k];
+	}
+}
+
+}
@@ -0,0 +1,150 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file kinetic.hh
+ * \brief Header file for the kinetic_container class. */
+
+#ifndef VOROPP_KINETIC_HH
+#define VOROPP_KINETIC_HH
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+
+#include "config.hh"
+#include "common.hh"
+#include "cell.hh"
+#include "container.hh"
+
+namespace voro {
+
+/** \brief A class for following the Voronoi tessellation of particles that
+ * move with constant velocities.
+ *
+ * In event-driven and coarse-stepped simulations, the particles move by small
+ * amounts between steps, and most Voronoi cells keep the same neighbors. This
+ * class stores the neighbors of each cell, and for each cell it computes the
+ * time at which its neighbors could first change under linear motion, so that
+ * only the cells whose neighbors may have changed are recomputed.
+ *
+ * The neighbors of a cell remain valid while each vertex of the cell stays on
+ * the inner side of the plane of every particle that could cut it. For a
+ * vertex where three faces meet, the candidates are the particles that create
+ * the faces at the far ends of its edges, which are the ones that remove a
+ * face when its edge shrinks to zero length, and the particles that neighbor
+ * all of the particles whose faces meet at the vertex, which include any
+ * particle that could enter as a new neighbor. Since the planes move linearly
+ * with time, each of these certificates is the sign of a polynomial of degree
+ * at most five, whose first root gives the failure time. The failure times of
+ * the cells are kept in a priority queue, and when the simulation advances
+ * past the failure time of a cell, that cell is recomputed. Cells that gain or
+ * lose a neighbor during a recomputation cause that neighbor to be recomputed
+ * as well, so that the neighbor relation stays symmetric.
+ *
+ * The particles are numbered in the order that they are added, and the
+ * neighbor lists use these indices, along with the negative IDs of the
+ * container boundaries, as in the voronoicell_neighbor class. Particles must
+ * remain inside the container in non-periodic directions. Vertices where more
+ * than three faces meet are degenerate, and are not given certificates. */
+class kinetic_container {
+	public:
+		/** The minimum x coordinate of the container. */
+		const double ax;
+		/** The maximum x coordinate of the container. */
+		const double bx;
+		/** The minimum y coordinate of the container. */
+		const double ay;
+		/** The maximum y coordinate of the container. */
+		const double by;
+		/** The minimum z coordinate of the container. */
+		const double az;
+		/** The maximum z coordinate of the container. */
+		const double bz;
+		/** The number of blocks in the x direction of the container
+		 * used to compute the cells. */
+		const int nx;
+		/** The number of blocks in the y direction. */
+		const int ny;
+		/** The number of blocks in the z direction. */
+		const int nz;
+		/** A boolean value that determines if the x coordinate is
+		 * periodic. */
+		const bool xperiodic;
+		/** A boolean value that determines if the y coordinate is
+		 * periodic. */
+		const bool yperiodic;
+		/** A boolean value that determines if the z coordinate is
+		 * periodic. */
+		const bool zperiodic;
+		/** The length of time ahead for which the certificates are
+		 * checked. A cell whose certificates remain valid over this
+		 * time is recomputed once it has elapsed. */
+		const double horizon;
+		/** The current time. */
+		double t;
+		/** The number of particles. */
+		int np;
+		/** The total number of cells that have been computed. */
+		long recomputed;
+		kinetic_container(double ax_,double bx_,double ay_,double by_,double az_,double bz_,
+				int nx_,int ny_,int nz_,bool xperiodic_,bool yperiodic_,bool zperiodic_,
+				double horizon_,double t_=0);
+		void put(int n,double x,double y,double z,double vx,double vy,double vz);
+		void set_velocity(int i,double vx,double vy,double vz);
+		int advance(double t_);
+		double next_event();
+		bool compute_cell(voronoicell_neighbor &c,int i);
+		/** Returns the ID of a particle.
+		 * \param[in] i the index of the particle.
+		 * \return The ID. */
+		inline int id(int i) {return ids[i];}
+		/** Returns the neighbors of the cell of a particle, as a sorted
+		 * list of particle indices and boundary IDs.
+		 * \param[in] i the index of the particle.
+		 * \return A reference to the list. */
+		inline const std::vector<int> &neighbors(int i) {return nb[i];}
+		/** Returns the time at which the neighbors of a cell may next
+		 * change.
+		 * \param[in] i the index of the particle.
+		 * \return The time. */
+		inline double event_time(int i) {return ev[i];}
+	private:
+		/** The particle IDs. */
+		std::vector<int> ids;
+		/** The current particle positions, three per particle. */
+		std::vector<double> pos;
+		/** The particle velocities, three per particle. */
+		std::vector<double> vel;
+		/** The sorted neighbor lists of the cells. */
+		std::vector<std::vector<int> > nb;
+		/** The failure times of the certificates of the cells. */
+		std::vector<double> ev;
+		/** Flags marking the cells that are due to be recomputed. */
+		std::vector<char> due;
+		/** A list of the cells that are due to be recomputed. */
+		std::vector<int> pend;
+		/** The queue of certificate failure times, with the earliest
+		 * first. Entries for cells whose failure time has since been
+		 * recomputed are skipped. */
+		std::priority_queue<std::pair<double,int>,std::vector<std::pair<double,int> >,
+			std::greater<std::pair<double,int> > > pq;
+		/** The maximum degree of the polynomials used for the
+		 * certificates. */
+		static const int max_degree=8;
+		inline void mark(int i) {
+			if(!due[i]) {due[i]=1;pend.push_back(i);}
+		}
+		void move(double dt);
+		void remap(double *pp);
+		void displacement(int i,int j,double *r);
+		void face_plane(int i,int f,double (*pn)[3],double *pb);
+		double certificates(int i,std::vector<int> &vd);
+		double first_failure(const double *g,int n,double h);
+		int poly_roots(const double *c,int n,double a,double b,double *r);
+		double poly_eval(const double *c,int n,double x);
+		void poly_det(double (*e)[3][3],double *d);
+};
+
+}
+
+#endif
@@ -0,0 +1,429 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file order_parallel.hh
+ * \brief Header file for the routines that compute the cells of the particles
+ * in an ordering, or in a whole container, in parallel. */
+
+#ifndef VOROPP_ORDER_PARALLEL_HH
+#define VOROPP_ORDER_PARALLEL_HH
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+#include "config.hh"
+#include "common.hh"
+#include "v_base.hh"
+#include "cell.hh"
+#include "flat_cell.hh"
+#include "c_loops.hh"
+#include "v_compute.hh"
+
+namespace voro {
+
+/** Computes the Voronoi cell for a particle referenced by a record in an
+ * ordering, using a given computation class.
+ * \param[in] con the container class to use.
+ * \param[in] vcomp the computation class to use.
+ * \param[out] c a Voronoi cell class in which to store the computed cell.
+ * \param[in] (ijk,q) the block and index of the particle.
+ * \return True if the cell was computed, false otherwise. */
+template<class c_class,class v_cell>
+inline bool order_compute_cell(c_class &con,voro_compute<c_class> &vcomp,v_cell &c,int ijk,int q) {
+	int k=ijk/con.nxy,ijkt=ijk-con.nxy*k,j=ijkt/con.nx,i=ijkt-j*con.nx;
+	return vcomp.compute_cell(c,ijk,q,i,j,k);
+}
+
+/** Computes the Voronoi cells of the particles in an ordering in parallel. The
+ * records are handed out to the threads in small chunks, and each thread uses
+ * its own voro_compute class, so that the computation class belonging to the
+ * container is not touched. For each cell that is computed, a function object
+ * is called by the thread that computed it, as f(c,ijk,q,l), where c is the
+ * cell, (ijk,q) locate the particle in the container, and l is the index of
+ * the record in the ordering. The function object must therefore be safe to
+ * call concurrently. Typically it stores its results in an array indexed by l,
+ * so that they can be used in the original insertion order afterwards.
+ *
+ * This routine can be used with the container and container_poly classes. The
+ * container must not be modified during the computation.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[in] f the function object to call for each cell.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+template<class v_cell,class c_class,class c_func>
+void compute_order_parallel(c_class &con,particle_order &vo,c_func f,int nt=0) {
+	int n=vo.total();
+	if(nt<=0) nt=voro_max_threads();
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		v_cell c(con);
+		voro_compute<c_class> vcomp(con,con.xperiodic?2*con.nx+1:con.nx,
+			con.yperiodic?2*con.ny+1:con.ny,con.zperiodic?2*con.nz+1:con.nz);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,order_chunk_size)
+#endif
+		for(int l=0;l<n;l++) {
+			int ijk=vo.o[l<<1],q=vo.o[(l<<1)+1];
+			if(order_compute_cell(con,vcomp,c,ijk,q)) f(c,ijk,q,l);
+		}
+	}
+}
+
+/** Computes the Voronoi cells of the particles in an ordering in parallel, and
+ * saves customized information about them, using a given cell class. The
+ * ordering is processed in batches of order_batch_size records. Each thread
+ * writes the output for its cells to its own memory stream, and once a batch
+ * is complete, the output is written to the file in the order of the records.
+ * Hence the file is identical to the one produced by looping over the
+ * ordering with a c_loop_order class.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \param[out] vol an array in which to store the volume of the cell of each
+ *                 record, or a null pointer if the volumes are not needed.
+ *                 The entries for cells that cannot be computed are not
+ *                 changed. */
+template<class v_cell,class c_class>
+void print_custom_order_cells(c_class &con,particle_order &vo,const char *format,FILE *fp,int nt,double *vol) {
+	int n=vo.total(),bn=n<order_batch_size?n:order_batch_size;
+	if(n==0) return;
+	if(nt<=0) nt=voro_max_threads();
+	long *bs=new long[bn<<1];
+	int *bt=new int[bn];
+	std::vector<char*> tb(nt);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		int t=voro_thread_num();
+		char *buf=0;size_t len=0;
+		FILE *mf=open_memstream(&buf,&len);
+		if(mf==NULL) voro_fatal_error("Unable to open memory stream",VOROPP_FILE_ERROR);
+		v_cell c(con);
+		voro_compute<c_class> vcomp(con,con.xperiodic?2*con.nx+1:con.nx,
+			con.yperiodic?2*con.ny+1:con.ny,con.zperiodic?2*con.nz+1:con.nz);
+		for(int s=0;s<n;s+=bn) {
+			int e=s+bn<n?s+bn:n;
+
+			// Compute the cells in the batch, recording where the
+			// output for each one is held
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,order_chunk_size) nowait
+#endif
+			for(int l=s;l<e;l++) {
+				int ijk=vo.o[l<<1],q=vo.o[(l<<1)+1];
+				long *bp=bs+((l-s)<<1);
+				bt[l-s]=t;*bp=ftell(mf);
+				if(order_compute_cell(con,vcomp,c,ijk,q)) {
+					double *pp=con.p[ijk]+con.ps*q;
+					c.output_custom(format,con.id[ijk][q],*pp,pp[1],pp[2],
+							con.ps==4?pp[3]:default_radius,mf);
+					if(vol!=0) vol[l]=c.volume();
+				}
+				bp[1]=ftell(mf);
+			}
+			fflush(mf);tb[t]=buf;
+
+			// Write out the batch in order, and then reuse the
+			// memory streams for the next batch
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+			for(int l=0;l<e-s;l++) fwrite(tb[bt[l]]+bs[l<<1],1,bs[(l<<1)+1]-bs[l<<1],fp);
+			fseek(mf,0,SEEK_SET);
+		}
+		fclose(mf);
+		free(buf);
+	}
+	delete [] bt;
+	delete [] bs;
+}
+
+/** Computes the Voronoi cells of the particles in an ordering in parallel, and
+ * saves customized information about them. The output is written in the order
+ * of the records, so that it is identical to the output of the serial
+ * print_custom routine when used with a c_loop_order class. This routine can
+ * be used with the container and container_poly classes.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[in] format the custom output string to use.
+ * \param[in] fp a file handle to write to.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \param[out] vol an optional array in which to store the volume of the cell
+ *                 of each record, so that the cells do not need to be
+ *                 computed again to find them. */
+template<class c_class>
+void print_custom_order_parallel(c_class &con,particle_order &vo,const char *format,FILE *fp=stdout,int nt=0,double *vol=0) {
+	if(voro_base::contains_neighbor(format)) print_custom_order_cells<voronoicell_neighbor>(con,vo,format,fp,nt,vol);
+	else print_custom_order_cells<voronoicell>(con,vo,format,fp,nt,vol);
+}
+
+/** Computes the Voronoi cells of the particles in an ordering in parallel, and
+ * saves customized information about them.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[in] format the custom output string to use.
+ * \param[in] filename the name of the file to write to.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+template<class c_class>
+void print_custom_order_parallel(c_class &con,particle_order &vo,const char *format,const char *filename,int nt=0) {
+	FILE *fp=safe_fopen(filename,"w");
+	print_custom_order_parallel(con,vo,format,fp,nt);
+	fclose(fp);
+}
+
+/** Computes the Voronoi cells of the particles in an ordering in parallel, and
+ * sums their volumes. The volumes are added up in the order of the records,
+ * so the result does not depend on the number of threads.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \return The computed volume. */
+template<class c_class>
+double sum_cell_volumes_order_parallel(c_class &con,particle_order &vo,int nt=0) {
+	std::vector<double> vol(vo.total(),0);
+	compute_order_parallel<voronoicell>(con,vo,[&vol](voronoicell &c,int,int,int l) {vol[l]=c.volume();},nt);
+	double vvol=0;
+	for(std::vector<double>::iterator vp=vol.begin();vp<vol.end();vp++) vvol+=*vp;
+	return vvol;
+}
+
+/** Computes the Voronoi cells of all of the particles in a container in
+ * parallel. The blocks of the container are divided between the threads in
+ * contiguous ranges using a static schedule, which matches the placement made
+ * by the container's first_touch routine when the same number of threads is
+ * used. For each cell that is computed, a function object is called by the
+ * thread that computed it, as f(c,ijk,q), so it must be safe to call
+ * concurrently. This routine can be used with the container and
+ * container_poly classes. The container must not be modified during the
+ * computation.
+ * \param[in] con the container class to use.
+ * \param[in] f the function object to call for each cell.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+template<class v_cell,class c_class,class c_func>
+void compute_all_parallel(c_class &con,c_func f,int nt=0) {
+	if(nt<=0) nt=voro_max_threads();
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		v_cell c(con);
+		voro_compute<c_class> vcomp(con,con.xperiodic?2*con.nx+1:con.nx,
+			con.yperiodic?2*con.ny+1:con.ny,con.zperiodic?2*con.nz+1:con.nz);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+		for(int ijk=0;ijk<con.nxyz;ijk++) for(int q=0;q<con.co[ijk];q++)
+			if(order_compute_cell(con,vcomp,c,ijk,q)) f(c,ijk,q);
+	}
+}
+
+/** Computes the Voronoi cells of all of the particles in a container in
+ * parallel, and sums their volumes. The volumes are first summed within each
+ * block, and the block totals are then added up in order, so the result does
+ * not depend on the number of threads.
+ * \param[in] con the container class to use.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \return The computed volume. */
+template<class c_class>
+double sum_cell_volumes_parallel(c_class &con,int nt=0) {
+	std::vector<double> vol(con.nxyz,0);
+	compute_all_parallel<voronoicell>(con,[&vol](voronoicell &c,int ijk,int) {vol[ijk]+=c.volume();},nt);
+	double vvol=0;
+	for(std::vector<double>::iterator vp=vol.begin();vp<vol.end();vp++) vvol+=*vp;
+	return vvol;
+}
+
+/** Computes the intersections of the Voronoi cells of the particles in an
+ * ordering with balls centered on the particles, for several radii, in
+ * parallel. This can be used to find local packing fractions and free
+ * volumes.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[in] n the number of radii.
+ * \param[in] r an array of the radii to consider.
+ * \param[out] v a vector in which to store the results. For the lth record of
+ *               the ordering, the n intersection volumes, the n areas of the
+ *               spheres inside the cell, and the n areas of the faces inside
+ *               the balls are stored consecutively, starting at entry 3*n*l.
+ *               If the cell of a record cannot be computed, then its entries
+ *               are set to NaN.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+template<class c_class>
+void ball_intersection_order_parallel(c_class &con,particle_order &vo,int n,const double *r,std::vector<double> &v,int nt=0) {
+	v.assign(3*n*vo.total(),std::numeric_limits<double>::quiet_NaN());
+	compute_order_parallel<voronoicell>(con,vo,[&v,n,r](voronoicell &c,int,int,int l) {
+		double *vp=v.data()+3*n*l;
+		c.ball_intersection(n,r,vp,vp+n,vp+2*n);
+	},nt);
+}
+
+/** Computes the Minkowski tensors, inertia tensors, and anisotropy indices of
+ * the Voronoi cells of the particles in an ordering, in parallel, using the
+ * minkowski_tensors() routine of the voronoicell class.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[out] v a vector in which to store the results, with
+ *               minkowski_tensor_size entries for each record of the
+ *               ordering. The entries for a record whose cell cannot be
+ *               computed are set to NaN.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+template<class c_class>
+void minkowski_tensors_order_parallel(c_class &con,particle_order &vo,std::vector<double> &v,int nt=0) {
+	v.assign(minkowski_tensor_size*vo.total(),std::numeric_limits<double>::quiet_NaN());
+	compute_order_parallel<voronoicell>(con,vo,[&v](voronoicell &c,int,int,int l) {
+		c.minkowski_tensors(v.data()+minkowski_tensor_size*l);
+	},nt);
+}
+
+/** Computes the derivatives of the volumes and surface areas of the Voronoi
+ * cells of the particles in an ordering with respect to the particle
+ * positions, in parallel, using the gradients() routine of the
+ * voronoicell_neighbor class. The results are assembled into a sparse matrix
+ * in compressed sparse row format, with one row for each record of the
+ * ordering. The first entry of each row is for the particle itself, and it is
+ * followed by one entry for each distinct neighboring particle. Faces created
+ * by periodic images of the particle are included in the first entry. Walls
+ * are taken to be fixed, so a curved wall, which is approximated by a plane
+ * that depends on the particle position, is not accounted for exactly. For
+ * the radical tessellation, the displacement to each neighbor is found by
+ * looking up the neighbor's position, choosing the periodic image that is
+ * consistent with the plane of the face.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[out] off a vector in which to store the row offsets, so that the
+ *                 entries of the lth record are from off[l] to off[l+1]-1.
+ *                 The row of a record whose cell cannot be computed is
+ *                 empty.
+ * \param[out] nid a vector in which to store the particle ID of each entry.
+ * \param[out] g a vector in which to store the derivatives, six per entry,
+ *               giving the gradients of the cell volume and surface area with
+ *               respect to the position of the particle of the entry.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+template<class c_class>
+void gradients_order_parallel(c_class &con,particle_order &vo,std::vector<int> &off,std::vector<int> &nid,
+		std::vector<double> &g,int nt=0) {
+	int n=vo.total(),l;
+	if(nt<=0) nt=voro_max_threads();
+
+	// For the radical tessellation, the neighbors are located using the
+	// container's ID index, which is enabled for the duration of the
+	// computation if it is not already in use
+	bool tidx=con.ps==4&&con.idx==0;
+	if(tidx) con.enable_id_index();
+
+	// Compute the cells, storing the rows in a buffer for each thread
+	std::vector<int> cnt(n,0),tl(n,0),to(n,0);
+	std::vector<std::vector<int> > tn(nt);
+	std::vector<std::vector<double> > tg(nt);
+	compute_order_parallel<voronoicell_neighbor>(con,vo,[&](voronoicell_neighbor &c,int ijk,int q,int l) {
+		int t=voro_thread_num(),pid=con.id[ijk][q],f,j,s;
+		std::vector<int> nb,&bn=tn[t];
+		std::vector<double> gg,dx,&bg=tg[t];
+		if(con.ps==4) {
+
+			// Find the displacement to the neighbor of each face.
+			// The plane of a face may be consistent with two
+			// distances to the neighbor, so the periodic image of
+			// the neighbor that best matches each one is found,
+			// and the closest match is used.
+			int nijk,nq;
+			double *pi=con.p[ijk]+4*q,*pj,*fp,h,d,e,ux,uy,uz,rx,ry,rz,sx,sy,sz,ex,ey,ez,best;
+			c.face_geometry(nb,dx);
+			for(f=0;f<(int) nb.size();f++) if(nb[f]>=0) {
+				fp=dx.data()+7*f;
+				if(!con.find_particle(nb[f],nijk,nq)) voro_fatal_error("Neighboring particle not found",VOROPP_INTERNAL_ERROR);
+				pj=con.p[nijk]+4*nq;
+				rx=*pj-*pi;ry=pj[1]-pi[1];rz=pj[2]-pi[2];
+				ux=fp[1];uy=fp[2];uz=fp[3];
+				h=ux*fp[4]+uy*fp[5]+uz*fp[6];
+				e=h*h-pi[3]*pi[3]+pj[3]*pj[3];e=e>0?sqrt(e):0;
+				best=std::numeric_limits<double>::max();
+				for(j=-1;j<=1;j+=2) {
+					d=h+j*e;
+					sx=con.xperiodic?(con.bx-con.ax)*round((ux*d-rx)/(con.bx-con.ax)):0;
+					sy=con.yperiodic?(con.by-con.ay)*round((uy*d-ry)/(con.by-con.ay)):0;
+					sz=con.zperiodic?(con.bz-con.az)*round((uz*d-rz)/(con.bz-con.az)):0;
+					ex=rx+sx-ux*d;ey=ry+sy-uy*d;ez=rz+sz-uz*d;
+					if(ex*ex+ey*ey+ez*ez<best) {
+						best=ex*ex+ey*ey+ez*ez;
+						dx[3*f]=rx+sx;dx[3*f+1]=ry+sy;dx[3*f+2]=rz+sz;
+					}
+				}
+			}
+		}
+		c.gradients(nb,gg,con.ps==4?dx.data():NULL);
+
+		// Store the row, merging the faces that have the same
+		// neighbor
+		tl[l]=t;to[l]=s=bn.size();
+		bn.push_back(pid);
+		bg.insert(bg.end(),gg.end()-6,gg.end());
+		for(f=0;f<(int) nb.size();f++) if(nb[f]>=0) {
+			for(j=s;j<(int) bn.size()&&bn[j]!=nb[f];j++);
+			if(j==(int) bn.size()) {
+				bn.push_back(nb[f]);
+				bg.insert(bg.end(),gg.begin()+6*f,gg.begin()+6*f+6);
+			} else for(int k=0;k<6;k++) bg[6*j+k]+=gg[6*f+k];
+		}
+		cnt[l]=bn.size()-s;
+	},nt);
+	if(tidx) con.disable_id_index();
+
+	// Assemble the rows in the order of the records
+	off.resize(n+1);off[0]=0;
+	for(l=0;l<n;l++) off[l+1]=off[l]+cnt[l];
+	nid.resize(off[n]);g.resize(6*off[n]);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nt)
+#endif
+	for(l=0;l<n;l++) if(cnt[l]>0) {
+		std::copy(tn[tl[l]].begin()+to[l],tn[tl[l]].begin()+to[l]+cnt[l],nid.begin()+off[l]);
+		std::copy(tg[tl[l]].begin()+6*to[l],tg[tl[l]].begin()+6*(to[l]+cnt[l]),g.begin()+6*off[l]);
+	}
+}
+
+/** Generates uniformly distributed random points inside the Voronoi cells of
+ * the particles in an ordering, in parallel. Each cell is flattened and
+ * sampled using the tetrahedral decomposition of the flat_cell class. The
+ * random number generator for each cell is seeded from the given seed and
+ * the index of the record in the ordering, so the points do not depend on
+ * the number of threads or on the order in which the cells are computed.
+ * \param[in] con the container class to use.
+ * \param[in] vo the ordering class to use.
+ * \param[in] ns the number of points to generate in each cell.
+ * \param[out] x a vector in which to store the points. The ns points for the
+ *               lth record of the ordering are stored, three coordinates per
+ *               point, starting at entry 3*ns*l. If the cell of a record
+ *               cannot be computed, then its entries are set to NaN.
+ * \param[in] seed the seed for the random number generators.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+template<class c_class>
+void sample_cells_order_parallel(c_class &con,particle_order &vo,int ns,std::vector<double> &x,
+		unsigned int seed=0,int nt=0) {
+	x.assign(3*ns*vo.total(),std::numeric_limits<double>::quiet_NaN());
+	if(nt<=0) nt=voro_max_threads();
+	std::vector<flat_cell> fcs(nt);
+	compute_order_parallel<voronoicell>(con,vo,[&](voronoicell &c,int ijk,int q,int l) {
+		flat_cell &fc=fcs[voro_thread_num()];
+		double *pp=con.p[ijk]+con.ps*q,*xp=x.data()+3*ns*l;
+		std::seed_seq sq{seed,(unsigned int) l};
+		std::mt19937_64 gen(sq);
+		fc.flatten(c);
+		fc.sample(ns,xp,gen);
+		for(int i=0;i<ns;i++,xp+=3) {*xp+=*pp;xp[1]+=pp[1];xp[2]+=pp[2];}
+	},nt);
+}
+
+}
+
+#endif
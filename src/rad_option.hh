@@ -15,6 +15,23 @@
 
 namespace voro {
 
+/** \brief A structure holding the constants that the radius classes set up
+ * during a single Voronoi cell computation.
+ *
+ * The structure is stored in the voro_compute class rather than in the
+ * container, so that several cells can be computed concurrently from the same
+ * container, each using its own voro_compute class. */
+struct radius_state {
+	/** The radius squared of the particle whose cell is being computed.
+	 */
+	double r_rad;
+	/** The difference between the radius squared of the particle and
+	 * the maximum radius squared. */
+	double r_mul;
+	/** The scaling factor for the current plane bounds check. */
+	double r_val;
+};
+
 /** \brief Class containing all of the routines that are specific to computing
  * the regular Voronoi tessellation.
  *
@@ -25,23 +42,29 @@ class radius_mono {
 	protected:
 		/** This is called prior to computing a Voronoi cell for a
 		 * given particle to initialize any required constants.
+		 * \param[out] st the structure to store the constants in.
 		 * \param[in] ijk the block that the particle is within.
 		 * \param[in] s the index of the particle within the block. */
-		inline void r_init(int ,int ) {}
+		inline void r_init(radius_state &,int ,int ) {}
 		/** Sets a required constant to be used when carrying out a
-		 * plane bounds check. */
-		inline void r_prime(double ) {}
+		 * plane bounds check.
+		 * \param[in,out] st the structure holding the constants.
+		 * \param[in] rv the radius squared of the block corner,
+		 *               edge, or face that is being tested. */
+		inline void r_prime(radius_state &,double ) {}
 		/** Carries out a radius bounds check.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in] crs the radius squared to be tested.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
 		 * \return True if particles at this radius could not possibly
 		 * cut the cell, false otherwise. */
-		inline bool r_ctest(double crs,double mrs) {return crs>mrs;}
+		inline bool r_ctest(radius_state &,double crs,double mrs) {return crs>mrs;}
 		/** Scales a plane displacement during a plane bounds check.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in] lrs the plane displacement.
 		 * \return The scaled value. */
-		inline double r_cutoff(double lrs) {return lrs;}
+		inline double r_cutoff(radius_state &,double lrs) {return lrs;}
 		/** Adds the maximum radius squared to a given value.
 		 * \param[in] rs the value to consider.
 		 * \return The value with the radius squared added. */
@@ -55,14 +78,16 @@ class radius_mono {
 		inline double r_current_sub(double rs,int ,int ) {return rs;}
 		/** Scales a plane displacement prior to use in the plane cutting
 		 * algorithm.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in] rs the initial plane displacement.
 		 * \param[in] ijk the block that the particle is within.
 		 * \param[in] q the index of the particle within the block.
 		 * \return The scaled plane displacement. */
-		inline double r_scale(double rs,int ,int ) {return rs;}
+		inline double r_scale(radius_state &,double rs,int ,int ) {return rs;}
 		/** Scales a plane displacement prior to use in the plane
 		 * cutting algorithm, and also checks if it could possibly cut
 		 * the cell.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in,out] rs the plane displacement to be scaled.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
@@ -70,7 +95,7 @@ class radius_mono {
 		 * \param[in] q the index of the particle within the block.
 		 * \return True if the cell could possibly cut the cell, false
 		 * otherwise. */
-		inline bool r_scale_check(double &rs,double mrs,int ,int ) {return rs<mrs;}
+		inline bool r_scale_check(radius_state &,double &rs,double mrs,int ,int ) {return rs<mrs;}
 };
 
 /**  \brief Class containing all of the routines that are specific to computing
@@ -93,26 +118,32 @@ class radius_poly {
 	protected:
 		/** This is called prior to computing a Voronoi cell for a
 		 * given particle to initialize any required constants.
+		 * \param[out] st the structure to store the constants in.
 		 * \param[in] ijk the block that the particle is within.
 		 * \param[in] s the index of the particle within the block. */
-		inline void r_init(int ijk,int s) {
-			r_rad=ppr[ijk][4*s+3]*ppr[ijk][4*s+3];
-			r_mul=r_rad-max_radius*max_radius;
+		inline void r_init(radius_state &st,int ijk,int s) {
+			st.r_rad=ppr[ijk][4*s+3]*ppr[ijk][4*s+3];
+			st.r_mul=st.r_rad-max_radius*max_radius;
 		}
 		/** Sets a required constant to be used when carrying out a
-		 * plane bounds check. */
-		inline void r_prime(double rv) {r_val=1+r_mul/rv;}
+		 * plane bounds check.
+		 * \param[in,out] st the structure holding the constants.
+		 * \param[in] rv the radius squared of the block corner,
+		 *               edge, or face that is being tested. */
+		inline void r_prime(radius_state &st,double rv) {st.r_val=1+st.r_mul/rv;}
 		/** Carries out a radius bounds check.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in] crs the radius squared to be tested.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
 		 * \return True if particles at this radius could not possibly
 		 * cut the cell, false otherwise. */
-		inline bool r_ctest(double crs,double mrs) {return crs+r_mul>sqrt(mrs*crs);}
+		inline bool r_ctest(radius_state &st,double crs,double mrs) {return crs+st.r_mul>sqrt(mrs*crs);}
 		/** Scales a plane displacement during a plane bounds check.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in] lrs the plane displacement.
 		 * \return The scaled value. */
-		inline double r_cutoff(double lrs) {return lrs*r_val;}
+		inline double r_cutoff(radius_state &st,double lrs) {return lrs*st.r_val;}
 		/** Adds the maximum radius squared to a given value.
 		 * \param[in] rs the value to consider.
 		 * \return The value with the radius squared added. */
@@ -128,16 +159,18 @@ class radius_poly {
 		}
 		/** Scales a plane displacement prior to use in the plane cutting
 		 * algorithm.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in] rs the initial plane displacement.
 		 * \param[in] ijk the block that the particle is within.
 		 * \param[in] q the index of the particle within the block.
 		 * \return The scaled plane displacement. */
-		inline double r_scale(double rs,int ijk,int q) {
-			return rs+r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
+		inline double r_scale(radius_state &st,double rs,int ijk,int q) {
+			return rs+st.r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
 		}
 		/** Scales a plane displacement prior to use in the plane
 		 * cutting algorithm, and also checks if it could possibly cut
 		 * the cell.
+		 * \param[in] st the structure holding the constants.
 		 * \param[in,out] rs the plane displacement to be scaled.
 		 * \param[in] mrs the current maximum distance to a Voronoi
 		 *                vertex multiplied by two.
@@ -145,13 +178,11 @@ class radius_poly {
 		 * \param[in] q the index of the particle within the block.
 		 * \return True if the cell could possibly cut the cell, false
 		 * otherwise. */
-		inline bool r_scale_check(double &rs,double mrs,int ijk,int q) {
+		inline bool r_scale_check(radius_state &st,double &rs,double mrs,int ijk,int q) {
 			double trs=rs;
-			rs+=r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
+			rs+=st.r_rad-ppr[ijk][4*q+3]*ppr[ijk][4*q+3];
 			return rs<sqrt(mrs*trs);
 		}
-	private:
-		double r_rad,r_mul,r_val;
 };
 
 }
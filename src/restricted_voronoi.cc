@@ -0,0 +1,388 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file restricted_voronoi.cc
+ * \brief Function implementations for the restricted_voronoi class. */
+
+#include <cmath>
+#include <algorithm>
+
+#include "restricted_voronoi.hh"
+
+namespace voro {
+
+/** Removes all cells and polygons. */
+void restricted_voronoi::clear() {
+	nc=np=0;
+	id.clear();area.clear();cen.clear();
+	pcell.clear();ptri.clear();poff.clear();pv.clear();
+}
+
+/** Computes the restricted Voronoi diagram of the particles in a container on
+ * a triangle mesh. This routine can be used with the container and
+ * container_poly classes, although the particle radii are not used.
+ * \param[in] con the container class to use.
+ * \param[in] nv the number of mesh vertices.
+ * \param[in] v the mesh vertex positions, three per vertex.
+ * \param[in] ntri the number of triangles.
+ * \param[in] tri the vertex indices of the triangles, three per triangle.
+ * \param[in] nt the number of threads to use, or zero to use the default. */
+void restricted_voronoi::compute(container_base &con,int nv,const double *v,int ntri,const int *tri,int nt) {
+	int ijk,q,l;
+	if(con.xperiodic||con.yperiodic||con.zperiodic)
+		voro_fatal_error("Restricted Voronoi diagrams require a non-periodic container",VOROPP_INTERNAL_ERROR);
+	if(nt<=0) nt=voro_max_threads();
+	clear();
+	ax=con.ax;ay=con.ay;az=con.az;
+	boxx=con.boxx;boxy=con.boxy;boxz=con.boxz;
+	nx=con.nx;ny=con.ny;nz=con.nz;
+	ptol=restricted_tolerance*std::max(con.bx-con.ax,std::max(con.by-con.ay,con.bz-con.az));
+
+	// Number the cells in block order, and copy the particle positions
+	bo.resize(con.nxyz+1);
+	for(ijk=0;ijk<con.nxyz;ijk++) {bo[ijk]=nc;nc+=con.co[ijk];}
+	bo[con.nxyz]=nc;
+	id.resize(nc);sp.resize(3*nc);
+	for(l=ijk=0;ijk<con.nxyz;ijk++) for(q=0;q<con.co[ijk];q++,l++) {
+		id[l]=con.id[ijk][q];
+		double *pp=con.p[ijk]+con.ps*q;
+		sp[3*l]=*pp;sp[3*l+1]=pp[1];sp[3*l+2]=pp[2];
+	}
+	cen=sp;
+
+	// Find the nearest particles to each particle, and the nearest
+	// particle to each mesh vertex
+	nn.resize(long(nc)*restricted_neighbors);nnc.resize(nc);vs.resize(nv);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		std::vector<std::pair<double,int> > nb;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,order_chunk_size)
+#endif
+		for(int i=0;i<nc;i++) {
+			nearest(sp[3*i],sp[3*i+1],sp[3*i+2],restricted_neighbors,i,nb);
+			int k=std::min(int(nb.size()),restricted_neighbors);
+			std::copy(nb.begin(),nb.begin()+k,nn.begin()+long(i)*restricted_neighbors);
+			nnc[i]=k;
+		}
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,order_chunk_size)
+#endif
+		for(int i=0;i<nv;i++) {
+			nearest(v[3*i],v[3*i+1],v[3*i+2],1,-1,nb);
+			vs[i]=nb.empty()?-1:nb[0].second;
+		}
+	}
+
+	// Clip the triangles in parallel. Each thread handles a contiguous
+	// range of triangles, so the polygons can be gathered in triangle
+	// order.
+	std::vector<std::vector<int> > tr(nt);
+	std::vector<std::vector<double> > tg(nt);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nt)
+#endif
+	{
+		int t=voro_thread_num();
+		std::vector<int> qu,cu;
+		std::vector<double> pa,pb;
+		std::vector<std::pair<double,int> > nb;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+		for(int i=0;i<ntri;i++) clip_triangle(v,tri,i,qu,cu,pa,pb,nb,tr[t],tg[t]);
+	}
+	gather_polygons(tr,tg);
+}
+
+/** Finds the nearest particles to a point, by searching the blocks of the
+ * container in cubic shells of increasing size. The search stops once at
+ * least a given number of particles have been found that are closer than any
+ * particle in the blocks that have not been searched.
+ * \param[in] (x,y,z) the point to search from.
+ * \param[in] k the number of particles to find.
+ * \param[in] ex the index of a cell to leave out, or -1 to consider all of
+ *               them.
+ * \param[out] nb the particles found, as pairs of the squared distance and the
+ *                cell index, in order of increasing distance. There may be
+ *                more than k of them.
+ * \return True if every particle was considered, so that the list holds all
+ *         of them, false otherwise. */
+bool restricted_voronoi::nearest(double x,double y,double z,int k,int ex,std::vector<std::pair<double,int> > &nb) {
+	int ci=std::min(std::max(int(floor((x-ax)/boxx)),0),nx-1),
+	    cj=std::min(std::max(int(floor((y-ay)/boxy)),0),ny-1),
+	    ck=std::min(std::max(int(floor((z-az)/boxz)),0),nz-1);
+	int i,j,kk,l,r,c;
+	double b,dx,dy,dz;
+	bool done;
+	nb.clear();
+	for(r=0;;r++) {
+
+		// Add the particles in the blocks on the surface of the shell
+		for(kk=std::max(ck-r,0);kk<=std::min(ck+r,nz-1);kk++)
+			for(j=std::max(cj-r,0);j<=std::min(cj+r,ny-1);j++) {
+				bool face=kk==ck-r||kk==ck+r||j==cj-r||j==cj+r;
+				for(i=std::max(ci-r,0);i<=std::min(ci+r,nx-1);i++) {
+					if(!face&&i!=ci-r&&i!=ci+r) {i=ci+r-1;continue;}
+					int ijk=i+nx*(j+ny*kk);
+					for(l=bo[ijk];l<bo[ijk+1];l++) if(l!=ex) {
+						dx=sp[3*l]-x;dy=sp[3*l+1]-y;dz=sp[3*l+2]-z;
+						nb.push_back(std::make_pair(dx*dx+dy*dy+dz*dz,l));
+					}
+				}
+			}
+
+		// Find the distance to the nearest block that has not been
+		// searched, and stop if enough particles are closer than it
+		done=true;b=large_number;
+		if(ci-r>0) {b=std::min(b,x-ax-(ci-r)*boxx);done=false;}
+		if(ci+r<nx-1) {b=std::min(b,ax+(ci+r+1)*boxx-x);done=false;}
+		if(cj-r>0) {b=std::min(b,y-ay-(cj-r)*boxy);done=false;}
+		if(cj+r<ny-1) {b=std::min(b,ay+(cj+r+1)*boxy-y);done=false;}
+		if(ck-r>0) {b=std::min(b,z-az-(ck-r)*boxz);done=false;}
+		if(ck+r<nz-1) {b=std::min(b,az+(ck+r+1)*boxz-z);done=false;}
+		if(done) {
+			std::sort(nb.begin(),nb.end());
+			return true;
+		}
+		b*=b;
+		for(c=0,l=0;l<(int) nb.size();l++) if(nb[l].first<=b) c++;
+		if(c>=k) {
+			std::sort(nb.begin(),nb.end());
+			nb.resize(c);
+			return false;
+		}
+	}
+}
+
+/** Clips a triangle against the cells that it meets. The search starts with
+ * the cells of the particles nearest to the vertices of the triangle. After
+ * the triangle has been clipped against a cell, the particles across any
+ * bisecting plane that the clipped polygon touches are added to the search.
+ * For each polygon of positive area, the cell, the triangle, and the number of
+ * vertices are appended to one list, and the area, centroid, and vertex
+ * positions are appended to another.
+ * \param[in] v the mesh vertex positions.
+ * \param[in] tri the vertex indices of the triangles.
+ * \param[in] i the index of the triangle to clip.
+ * \param[in] (qu,cu,pa,pb,nb) vectors to use as scratch space.
+ * \param[in] rr the list to append the integer information to.
+ * \param[in] rg the list to append the geometric information to. */
+void restricted_voronoi::clip_triangle(const double *v,const int *tri,int i,std::vector<int> &qu,
+				       std::vector<int> &cu,std::vector<double> &pa,std::vector<double> &pb,
+				       std::vector<std::pair<double,int> > &nb,std::vector<int> &rr,std::vector<double> &rg) {
+	const int *tp=tri+3*i;
+	int c,k,n;
+	unsigned int h,g;
+	double t[9],pl[4],*a,*u,*w,*s,ar,cx,cy,cz,nx,ny,nz,sx,sy,sz,tx,ty,tz,d;
+	for(k=0;k<3;k++) {
+		t[3*k]=v[3*tp[k]];t[3*k+1]=v[3*tp[k]+1];t[3*k+2]=v[3*tp[k]+2];
+	}
+
+	// Start the search with the cells of the nearest particles to the
+	// vertices
+	qu.clear();
+	for(k=0;k<3;k++) if((c=vs[tp[k]])>=0) {
+		for(h=0;h<qu.size();h++) if(qu[h]==c) break;
+		if(h==qu.size()) qu.push_back(c);
+	}
+
+	for(h=0;h<qu.size();h++) {
+		c=qu[h];
+		n=clip_cell(t,c,pa,pb,nb,cu);
+		if(n<3) continue;
+		a=pa.data();
+
+		// Compute the area and centroid of the polygon, by splitting
+		// it into a fan of triangles about its first vertex
+		ar=cx=cy=cz=0;
+		for(k=1;k<n-1;k++) {
+			u=a+3*k;w=u+3;
+			sx=*u-*a;sy=u[1]-a[1];sz=u[2]-a[2];
+			tx=*w-*a;ty=w[1]-a[1];tz=w[2]-a[2];
+			nx=sy*tz-sz*ty;ny=sz*tx-sx*tz;nz=sx*ty-sy*tx;
+			d=sqrt(nx*nx+ny*ny+nz*nz);
+			ar+=d;
+			cx+=d*(*a+*u+*w);cy+=d*(a[1]+u[1]+w[1]);cz+=d*(a[2]+u[2]+w[2]);
+		}
+		if(ar>0) {
+			rr.push_back(c);rr.push_back(i);rr.push_back(n);
+			rg.push_back(0.5*ar);
+			ar=1/(3*ar);
+			rg.push_back(cx*ar);rg.push_back(cy*ar);rg.push_back(cz*ar);
+			rg.insert(rg.end(),a,a+3*n);
+		}
+
+		// Add the particles across any bisecting planes that the
+		// polygon touches to the search
+		s=sp.data()+3*c;
+		for(std::vector<int>::iterator ip=cu.begin();ip<cu.end();ip++) {
+			for(g=0;g<qu.size();g++) if(qu[g]==*ip) break;
+			if(g<qu.size()) continue;
+			bisector(s,sp.data()+3*(*ip),pl);
+			for(u=a;u<a+3*n;u+=3) if(*pl**u+pl[1]*u[1]+pl[2]*u[2]-pl[3]>-ptol) break;
+			if(u<a+3*n) qu.push_back(*ip);
+		}
+	}
+}
+
+/** Clips a triangle against the cell of a particle. The bisecting planes with
+ * the nearest particles are applied in order of increasing distance, until
+ * the next particle is more than twice as far away as the furthest vertex of
+ * the clipped polygon. If the stored list of nearest particles runs out
+ * first, then a longer list is found and the clipping is started again.
+ * \param[in] t the vertex positions of the triangle.
+ * \param[in] c the cell to clip against.
+ * \param[in] (pa,pb) vectors to hold the polygon. The clipped polygon is
+ *                    returned in pa.
+ * \param[in] nb a vector to use for a longer list of nearest particles.
+ * \param[out] cu the cells of the particles whose bisecting planes cut the
+ *                polygon.
+ * \return The number of vertices of the clipped polygon. */
+int restricted_voronoi::clip_cell(const double *t,int c,std::vector<double> &pa,std::vector<double> &pb,
+				  std::vector<std::pair<double,int> > &nb,std::vector<int> &cu) {
+	const double *s=sp.data()+3*c;
+	const std::pair<double,int> *lp=nn.data()+long(c)*restricted_neighbors,*le=lp+nnc[c];
+	bool complete=nnc[c]<restricted_neighbors;
+	int k=restricted_neighbors,m,n;
+	double pl[4],r;
+	while(true) {
+
+		// Set up the polygon as the triangle
+		if(pa.size()<9) pa.resize(9);
+		std::copy(t,t+9,pa.begin());
+		n=3;cu.clear();
+		r=polygon_radius(s,pa.data(),n);
+
+		// Apply the bisecting planes until the remaining particles
+		// are too far away to cut the polygon
+		for(;lp<le;lp++) {
+			if(lp->first>4*r) return n;
+			bisector(s,sp.data()+3*lp->second,pl);
+			if(pb.size()<3*(unsigned int) (n+1)) pb.resize(3*(n+1));
+			if((m=clip(pl,pa.data(),pb.data(),n))<0) continue;
+			pa.swap(pb);
+			cu.push_back(lp->second);
+			if((n=m)==0) return 0;
+			r=polygon_radius(s,pa.data(),n);
+		}
+		if(complete) return n;
+
+		// Find a longer list of nearest particles, and start again
+		k<<=1;
+		complete=nearest(*s,s[1],s[2],k,c,nb);
+		lp=nb.data();le=lp+nb.size();
+	}
+}
+
+/** Computes the bisecting plane between two particles.
+ * \param[in] s the position of the first particle.
+ * \param[in] q the position of the second particle.
+ * \param[out] pl the plane, as a unit normal pointing towards the second
+ *                particle and a displacement, so that points closer to the
+ *                first particle lie on the inner side. */
+void restricted_voronoi::bisector(const double *s,const double *q,double *pl) {
+	double dx=*q-*s,dy=q[1]-s[1],dz=q[2]-s[2],l=1/sqrt(dx*dx+dy*dy+dz*dz);
+	*pl=dx*l;pl[1]=dy*l;pl[2]=dz*l;
+	pl[3]=0.5*(*pl*(*q+*s)+pl[1]*(q[1]+s[1])+pl[2]*(q[2]+s[2]));
+}
+
+/** Computes the squared distance from a particle to the furthest vertex of a
+ * polygon.
+ * \param[in] s the position of the particle.
+ * \param[in] a the vertices of the polygon.
+ * \param[in] n the number of vertices.
+ * \return The squared distance. */
+double restricted_voronoi::polygon_radius(const double *s,const double *a,int n) {
+	double r=0,dx,dy,dz;
+	for(const double *u=a;u<a+3*n;u+=3) {
+		dx=*u-*s;dy=u[1]-s[1];dz=u[2]-s[2];
+		r=std::max(r,dx*dx+dy*dy+dz*dz);
+	}
+	return r;
+}
+
+/** Clips a polygon against a plane, keeping the part on the inner side.
+ * \param[in] pp the plane, given as a unit normal and a displacement.
+ * \param[in] a the vertices of the polygon.
+ * \param[in] b an array in which to store the vertices of the clipped polygon,
+ *              which must have space for one more vertex than the polygon.
+ * \param[in] n the number of vertices of the polygon.
+ * \return The number of vertices of the clipped polygon, or -1 if the polygon
+ *         lies entirely on the inner side, in which case it is not copied. */
+int restricted_voronoi::clip(const double *pp,const double *a,double *b,int n) {
+	int k,m=0;
+	const double *u,*w;
+	double fu,fw,t;
+	for(k=0;k<n;k++) if(*pp*a[3*k]+pp[1]*a[3*k+1]+pp[2]*a[3*k+2]>pp[3]) break;
+	if(k==n) return -1;
+	u=a+3*(n-1);
+	fu=*pp**u+pp[1]*u[1]+pp[2]*u[2]-pp[3];
+	for(k=0;k<n;k++,u=w,fu=fw) {
+		w=a+3*k;
+		fw=*pp**w+pp[1]*w[1]+pp[2]*w[2]-pp[3];
+		if((fu>0)!=(fw>0)) {
+			t=fu/(fu-fw);
+			b[3*m]=*u+t*(*w-*u);
+			b[3*m+1]=u[1]+t*(w[1]-u[1]);
+			b[3*m+2]=u[2]+t*(w[2]-u[2]);
+			m++;
+		}
+		if(fw<=0) {
+			b[3*m]=*w;b[3*m+1]=w[1];b[3*m+2]=w[2];
+			m++;
+		}
+	}
+	return m;
+}
+
+/** Assembles the polygons found by the threads, in triangle order, and sums
+ * the areas and centroids of the restricted cells.
+ * \param[in] tr the integer information about the polygons from each thread.
+ * \param[in] tg the geometric information about the polygons from each
+ *               thread. */
+void restricted_voronoi::gather_polygons(std::vector<std::vector<int> > &tr,std::vector<std::vector<double> > &tg) {
+	int c,l,n;
+	double *gp,ar;
+	std::vector<double> mo(3*nc,0);
+	area.assign(nc,0);
+	poff.push_back(0);
+	for(unsigned int t=0;t<tr.size();t++) {
+		gp=tg[t].data();
+		for(unsigned int k=0;k<tr[t].size();k+=3) {
+			c=tr[t][k];n=tr[t][k+2];
+			pcell.push_back(c);ptri.push_back(tr[t][k+1]);
+			poff.push_back(poff.back()+n);
+			ar=*gp;area[c]+=ar;
+			mo[3*c]+=ar*gp[1];mo[3*c+1]+=ar*gp[2];mo[3*c+2]+=ar*gp[3];
+			pv.insert(pv.end(),gp+4,gp+4+3*n);
+			gp+=4+3*n;
+		}
+	}
+	np=pcell.size();
+	for(l=0;l<nc;l++) if(area[l]>0) {
+		ar=1/area[l];
+		cen[3*l]=mo[3*l]*ar;cen[3*l+1]=mo[3*l+1]*ar;cen[3*l+2]=mo[3*l+2]*ar;
+	}
+}
+
+/** Saves the restricted polygons in gnuplot format, as closed loops.
+ * \param[in] fp a file handle to write to. */
+void restricted_voronoi::draw_gnuplot(FILE *fp) {
+	for(int i=0;i<np;i++) {
+		double *pp=pv.data()+3*poff[i],*pe=pv.data()+3*poff[i+1];
+		for(double *u=pp;u<pe;u+=3) fprintf(fp,"%g %g %g\n",*u,u[1],u[2]);
+		fprintf(fp,"%g %g %g\n\n\n",*pp,pp[1],pp[2]);
+	}
+}
+
+/** Computes the total area of the restricted cells.
+ * \return The area. */
+double restricted_voronoi::total_area() {
+	double ar=0;
+	for(std::vector<double>::iterator ap=area.begin();ap<area.end();ap++) ar+=*ap;
+	return ar;
+}
+
+}
@@ -0,0 +1,126 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file restricted_voronoi.hh
+ * \brief Header file for the restricted_voronoi class. */
+
+#ifndef VOROPP_RESTRICTED_VORONOI_HH
+#define VOROPP_RESTRICTED_VORONOI_HH
+
+#include <cstdio>
+#include <vector>
+#include <utility>
+
+#include "config.hh"
+#include "common.hh"
+#include "container.hh"
+
+namespace voro {
+
+/** \brief A class for computing the restricted Voronoi diagram of the
+ * particles in a container on a triangle surface mesh.
+ *
+ * The restricted Voronoi diagram is made up of the intersections of the
+ * Voronoi cells with a surface. It is used for surface remeshing, where the
+ * particles are sample points on the surface that are moved to the centroids
+ * of their restricted cells in a Lloyd iteration. When the particles lie on a
+ * surface, their three-dimensional Voronoi cells are long and thin, and are
+ * expensive to compute, while only a small part of each one meets the
+ * surface. This class therefore never computes the cells, and instead clips
+ * the triangles of the mesh directly.
+ *
+ * The part of a triangle in the cell of a particle is found by clipping the
+ * triangle with the bisecting planes between that particle and the others,
+ * taken in order of increasing distance. Once the distance to the next
+ * particle is more than twice the distance to the furthest vertex of the
+ * clipped polygon, no further particle can cut it, so only a few planes are
+ * needed. The nearest particles are found by searching the blocks of the
+ * container in shells of increasing size, and a list of them is stored for
+ * each particle. Each triangle starts with the particles closest to its
+ * vertices, and moves on to the particles across any bisecting plane that
+ * its clipped polygon touches, so that only the particles whose cells meet
+ * the triangle are visited. The triangles are handled in parallel, and the
+ * results are summed in triangle order so that they do not depend on the
+ * number of threads.
+ *
+ * The cells are numbered in the order of the blocks of the container, as in
+ * the fv_mesh class. Since every point of the mesh belongs to the cell of its
+ * nearest particle, the mesh does not need to lie inside the container. The
+ * container must not be periodic, and its walls and any particle radii are
+ * not considered. */
+class restricted_voronoi {
+	public:
+		/** The number of cells. */
+		int nc;
+		/** The number of restricted polygons. */
+		int np;
+		/** The particle IDs of the cells. */
+		std::vector<int> id;
+		/** The areas of the restricted cells. */
+		std::vector<double> area;
+		/** The centroids of the restricted cells, three per cell. For
+		 * a cell that does not meet the mesh, the particle position is
+		 * stored instead. */
+		std::vector<double> cen;
+		/** The cell that each restricted polygon belongs to. */
+		std::vector<int> pcell;
+		/** The triangle that each restricted polygon lies in. */
+		std::vector<int> ptri;
+		/** The offsets of the vertex lists of the polygons, so that
+		 * the vertices of polygon i are stored from entry 3*poff[i] to
+		 * entry 3*poff[i+1]-1 of pv. */
+		std::vector<int> poff;
+		/** The vertex positions of the polygons. */
+		std::vector<double> pv;
+		restricted_voronoi() : nc(0), np(0) {}
+		void clear();
+		void compute(container_base &con,int nv,const double *v,int ntri,const int *tri,int nt=0);
+		void draw_gnuplot(FILE *fp=stdout);
+		/** Saves the restricted polygons in gnuplot format.
+		 * \param[in] filename the name of the file to write to. */
+		inline void draw_gnuplot(const char *filename) {
+			FILE *fp=safe_fopen(filename,"w");
+			draw_gnuplot(fp);
+			fclose(fp);
+		}
+		double total_area();
+	private:
+		/** The minimum coordinates of the container. */
+		double ax,ay,az;
+		/** The block sizes of the container. */
+		double boxx,boxy,boxz;
+		/** The number of blocks of the container in each direction. */
+		int nx,ny,nz;
+		/** The distance from a plane within which a polygon vertex is
+		 * taken to lie on it. */
+		double ptol;
+		/** The index of the first cell in each block, with an extra
+		 * entry holding the total number of cells. */
+		std::vector<int> bo;
+		/** The particle positions, three per cell. */
+		std::vector<double> sp;
+		/** The lists of nearest particles of the cells, each holding
+		 * restricted_neighbors entries of the squared distance and the
+		 * cell index, in order of increasing distance. */
+		std::vector<std::pair<double,int> > nn;
+		/** The number of entries in the nearest particle list of each
+		 * cell, which is smaller than restricted_neighbors if the list
+		 * holds every other particle. */
+		std::vector<int> nnc;
+		/** The cell of the nearest particle to each mesh vertex, or -1
+		 * if there are no particles. */
+		std::vector<int> vs;
+		bool nearest(double x,double y,double z,int k,int ex,std::vector<std::pair<double,int> > &nb);
+		void clip_triangle(const double *v,const int *tri,int i,std::vector<int> &qu,
+				   std::vector<int> &cu,std::vector<double> &pa,std::vector<double> &pb,
+				   std::vector<std::pair<double,int> > &nb,std::vector<int> &rr,std::vector<double> &rg);
+		int clip_cell(const double *t,int c,std::vector<double> &pa,std::vector<double> &pb,
+			      std::vector<std::pair<double,int> > &nb,std::vector<int> &cu);
+		static void bisector(const double *s,const double *q,double *pl);
+		static double polygon_radius(const double *s,const double *a,int n);
+		static int clip(const double *pp,const double *a,double *b,int n);
+		void gather_polygons(std::vector<std::vector<int> > &tr,std::vector<std::vector<double> > &tg);
+};
+
+}
+
+#endif
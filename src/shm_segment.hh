@@ -0,0 +1,353 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file shm_segment.hh
+ * \brief Header file for the shm_segment class, which describes the layout
+ * of a POSIX shared memory segment used to exchange particles and results
+ * with the shm_service class.
+ *
+ * All of the routines are defined in this file, so that a simulation code
+ * can include it to act as a producer without linking to the library. */
+
+#ifndef VOROPP_SHM_SEGMENT_HH
+#define VOROPP_SHM_SEGMENT_HH
+
+#if defined(__unix__)&&!defined(__APPLE__)
+#define VOROPP_SHM_SEGMENT
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "config.hh"
+
+namespace voro {
+
+/** The commands that a producer can send to the service. */
+enum shm_command {
+	/** Compute the requested results for the particles in the segment. */
+	shm_compute=1,
+	/** Stop serving requests. */
+	shm_quit=2
+};
+
+/** The status codes that the service sends back. */
+enum shm_status {
+	/** The request was carried out. */
+	shm_ok=0,
+	/** The request was invalid, for example because the number of
+	 * particles exceeds the capacity of the segment, or because the
+	 * container bounds are empty. */
+	shm_bad_request=1,
+	/** The command was not recognized. */
+	shm_bad_command=2,
+	/** The producer stopped waiting for a reply. */
+	shm_timeout=-1
+};
+
+/** Requests the volume of each Voronoi cell. */
+const unsigned int shm_volume=1;
+/** Requests the surface area of each Voronoi cell. */
+const unsigned int shm_area=2;
+/** Requests the number of faces of each Voronoi cell. */
+const unsigned int shm_faces=4;
+/** Requests the number of vertices of each Voronoi cell. */
+const unsigned int shm_vertices=8;
+/** Requests the centroid of each Voronoi cell, as three columns holding its
+ * absolute position. */
+const unsigned int shm_centroid=16;
+/** Requests the maximum distance from each particle to a vertex of its
+ * Voronoi cell. */
+const unsigned int shm_max_radius=32;
+/** The number of result columns when all of the results are requested. */
+const int shm_max_columns=8;
+/** The number that marks the header of a valid segment. */
+const unsigned int shm_magic=0x766f726f;
+
+/** \brief The header at the start of a shared memory segment.
+ *
+ * The header holds the two semaphores of the handshake, a request written by
+ * the producer, and a reply written by the service. The producer must only
+ * modify the request and the particle arrays while the service is idle, and
+ * it must only read the results after the reply semaphore has been posted.
+ * Since posting and waiting on a semaphore synchronizes memory, no other
+ * locking is needed. */
+struct shm_header {
+	/** A number that identifies a valid segment. */
+	unsigned int magic;
+	/** The maximum number of particles that the segment can hold. */
+	int max_n;
+	/** The semaphore that the producer posts when a request is ready. */
+	sem_t request;
+	/** The semaphore that the service posts when a reply is ready. */
+	sem_t reply;
+	/** The command to carry out. */
+	int command;
+	/** The number of particles. */
+	int n;
+	/** Whether the particle radii should be used, in which case the
+	 * radical Voronoi tessellation is computed. */
+	int polydisperse;
+	/** A combination of the result flags, selecting the columns of the
+	 * results. */
+	unsigned int fields;
+	/** The bounds of the container, in the order ax, bx, ay, by, az, and
+	 * bz. */
+	double bounds[6];
+	/** Flags that determine whether the container is periodic in each
+	 * direction. */
+	int periodic[3];
+	/** The number of blocks of the container in each direction, or zeros
+	 * to choose them from the particle density. */
+	int grid[3];
+	/** A counter that the producer can use to label its requests, which
+	 * is copied to the reply. */
+	long step;
+	/** The status of the last request. */
+	int status;
+	/** The number of result columns per particle. */
+	int columns;
+	/** The number of particles whose Voronoi cells were computed. */
+	int computed;
+	/** The step counter of the last request that was carried out. */
+	long reply_step;
+	/** The total volume of the computed Voronoi cells. */
+	double volume;
+};
+
+/** \brief A class representing a POSIX shared memory segment that holds
+ * particle arrays and per-particle results.
+ *
+ * A segment is created by the producer, which is typically a simulation code,
+ * with a fixed capacity, and the service attaches to it by name. After the
+ * header, the segment holds an array of particle IDs, an array of positions
+ * with three entries per particle, an array of radii, and space for
+ * shm_max_columns results per particle. The results of particle i are stored
+ * consecutively, starting at entry columns*i, in the order that the flags are
+ * listed in, so that they line up with the input arrays. The results of
+ * particles whose Voronoi cells could not be computed, for example because
+ * they lie outside a non-periodic container, are set to NaN.
+ *
+ * The two sides exchange requests through a pair of process-shared semaphores
+ * in the header. On Linux these wait on futexes, so that neither side spins
+ * while the other is working. */
+class shm_segment {
+	public:
+		/** A pointer to the header of the segment. */
+		shm_header *h;
+		/** The particle IDs. */
+		int *id;
+		/** The particle positions, three per particle. */
+		double *pos;
+		/** The particle radii. */
+		double *rad;
+		/** The per-particle results. */
+		double *out;
+		shm_segment(const char *name_,int max_n);
+		shm_segment(const char *name_);
+		/** The class cannot be copied, since each instance unmaps the
+		 * segment, and the creating instance removes it. */
+		shm_segment(const shm_segment &) = delete;
+		shm_segment& operator=(const shm_segment &) = delete;
+		~shm_segment();
+		int request(int command,double timeout=0);
+		int wait_reply(double timeout=0);
+		void wait_request();
+		void reply(int status);
+	private:
+		/** The name of the segment. */
+		char *name;
+		/** Whether this process created the segment, in which case it
+		 * removes the segment when it is finished. */
+		bool owner;
+		/** The size of the segment in bytes. */
+		size_t len;
+		static size_t offset(int max_n,int a);
+		void map(int fd);
+		void locate(int max_n);
+		static void fatal(const char *p);
+};
+
+/** Creates a new shared memory segment, replacing any existing segment with
+ * the same name, and initializes its header and semaphores.
+ * \param[in] name_ the name of the segment, which should start with a slash.
+ * \param[in] max_n the maximum number of particles that the segment can
+ *                  hold. */
+inline shm_segment::shm_segment(const char *name_,int max_n)
+	: name(new char[strlen(name_)+1]), owner(true), len(offset(max_n,4)) {
+	strcpy(name,name_);
+	if(max_n<0) fatal("Negative shared memory segment capacity");
+	shm_unlink(name);
+	int fd=shm_open(name,O_RDWR|O_CREAT|O_EXCL,0600);
+	if(fd<0) fatal("Unable to create shared memory segment");
+	if(ftruncate(fd,len)!=0) {
+		close(fd);shm_unlink(name);
+		fatal("Unable to size shared memory segment");
+	}
+	map(fd);
+	if(sem_init(&h->request,1,0)!=0) {
+		munmap(h,len);shm_unlink(name);
+		fatal("Unable to initialize shared memory semaphores");
+	}
+	if(sem_init(&h->reply,1,0)!=0) {
+		sem_destroy(&h->request);
+		munmap(h,len);shm_unlink(name);
+		fatal("Unable to initialize shared memory semaphores");
+	}
+	h->max_n=max_n;
+	h->fields=shm_volume;
+	h->bounds[1]=h->bounds[3]=h->bounds[5]=1;
+	locate(max_n);
+	h->magic=shm_magic;
+}
+
+/** Attaches to an existing shared memory segment, checking that it has been
+ * set up by the other constructor.
+ * \param[in] name_ the name of the segment. */
+inline shm_segment::shm_segment(const char *name_)
+	: name(new char[strlen(name_)+1]), owner(false) {
+	strcpy(name,name_);
+	int fd=shm_open(name,O_RDWR,0);
+	if(fd<0) fatal("Unable to open shared memory segment");
+	struct stat st;
+	if(fstat(fd,&st)!=0||size_t(st.st_size)<sizeof(shm_header)) {
+		close(fd);
+		fatal("Invalid shared memory segment");
+	}
+	len=st.st_size;
+	map(fd);
+	if(h->magic!=shm_magic||h->max_n<0||offset(h->max_n,4)!=len)
+		fatal("Invalid shared memory segment");
+	locate(h->max_n);
+}
+
+/** The class destructor unmaps the segment. If this process created the
+ * segment, then the semaphores are destroyed and the segment is removed, so
+ * the producer should send the quit command first. */
+inline shm_segment::~shm_segment() {
+	if(owner) {
+		h->magic=0;
+		sem_destroy(&h->request);
+		sem_destroy(&h->reply);
+	}
+	munmap(h,len);
+	if(owner) shm_unlink(name);
+	delete [] name;
+}
+
+/** Sends a command to the service, and waits for it to reply. This is called
+ * by the producer, after it has filled in the request fields of the header
+ * and the particle arrays.
+ * \param[in] command the command to send.
+ * \param[in] timeout the maximum time in seconds to wait for the reply, or
+ *                    zero to wait indefinitely.
+ * \return The status sent back by the service, or shm_timeout if it did not
+ *         reply in time. */
+inline int shm_segment::request(int command,double timeout) {
+	h->command=command;
+	if(sem_post(&h->request)!=0) fatal("Unable to post shared memory request");
+	return wait_reply(timeout);
+}
+
+/** Waits for the service to reply to a request. After a request has timed
+ * out, the service may still be working on it, and this routine can be used
+ * to wait again before the segment is modified.
+ * \param[in] timeout the maximum time in seconds to wait, or zero to wait
+ *                    indefinitely.
+ * \return The status sent back by the service, or shm_timeout if it did not
+ *         reply in time. */
+inline int shm_segment::wait_reply(double timeout) {
+	int r;
+	if(timeout>0) {
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME,&ts);
+		double s=floor(timeout);
+		ts.tv_sec+=time_t(s);
+		ts.tv_nsec+=long(1e9*(timeout-s));
+		if(ts.tv_nsec>=1000000000L) {ts.tv_sec++;ts.tv_nsec-=1000000000L;}
+		while((r=sem_timedwait(&h->reply,&ts))!=0&&errno==EINTR);
+		if(r!=0) {
+			if(errno==ETIMEDOUT) return shm_timeout;
+			fatal("Unable to wait for shared memory reply");
+		}
+	} else while(sem_wait(&h->reply)!=0)
+		if(errno!=EINTR) fatal("Unable to wait for shared memory reply");
+	return h->status;
+}
+
+/** Waits for the producer to send a request. This is called by the
+ * service. */
+inline void shm_segment::wait_request() {
+	while(sem_wait(&h->request)!=0)
+		if(errno!=EINTR) fatal("Unable to wait for shared memory request");
+}
+
+/** Sends a reply to the producer. This is called by the service, after it
+ * has written the results into the segment.
+ * \param[in] status the status to send back. */
+inline void shm_segment::reply(int status) {
+	h->status=status;
+	h->reply_step=h->step;
+	if(sem_post(&h->reply)!=0) fatal("Unable to post shared memory reply");
+}
+
+/** Computes the offset of one of the arrays in a segment. Each array starts
+ * on a 64-byte boundary, so that the arrays are suitably aligned and do not
+ * share cache lines with the header.
+ * \param[in] max_n the maximum number of particles that the segment can hold.
+ * \param[in] a the array to consider, from 0 for the particle IDs to 3 for
+ *              the results, or 4 to obtain the size of the whole segment.
+ * \return The offset in bytes. */
+inline size_t shm_segment::offset(int max_n,int a) {
+	size_t m=max_n,o=(sizeof(shm_header)+63)&~size_t(63);
+	const size_t sz[4]={sizeof(int)*m,3*sizeof(double)*m,sizeof(double)*m,
+		shm_max_columns*sizeof(double)*m};
+	for(int i=0;i<a;i++) o+=(sz[i]+63)&~size_t(63);
+	return o;
+}
+
+/** Maps the segment into memory, and closes its file descriptor. If this
+ * process created the segment and it cannot be mapped, then it is removed.
+ * \param[in] fd the file descriptor of the segment. */
+inline void shm_segment::map(int fd) {
+	void *mp=mmap(NULL,len,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if(mp==MAP_FAILED) {
+		if(owner) shm_unlink(name);
+		fatal("Unable to map shared memory segment");
+	}
+	h=static_cast<shm_header*>(mp);
+}
+
+/** Sets up the pointers to the arrays in the segment.
+ * \param[in] max_n the maximum number of particles that the segment can
+ *                  hold. */
+inline void shm_segment::locate(int max_n) {
+	char *b=reinterpret_cast<char*>(h);
+	id=reinterpret_cast<int*>(b+offset(max_n,0));
+	pos=reinterpret_cast<double*>(b+offset(max_n,1));
+	rad=reinterpret_cast<double*>(b+offset(max_n,2));
+	out=reinterpret_cast<double*>(b+offset(max_n,3));
+}
+
+/** Prints an error message about the shared memory segment and exits, in the
+ * same way as voro_fatal_error, which is not used so that this file does not
+ * depend on the library.
+ * \param[in] p the message to print. */
+inline void shm_segment::fatal(const char *p) {
+	fprintf(stderr,"voro++: %s\n",p);
+	exit(VOROPP_FILE_ERROR);
+}
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file shm_service.cc
+ * \brief Function implementations for the shm_service class. */
+
+#include "shm_service.hh"
+
+#ifdef VOROPP_SHM_SEGMENT
+
+#include <cmath>
+#include <limits>
+
+#include "order_parallel.hh"
+
+namespace voro {
+
+/** The class constructor sets up a service for a segment, without building a
+ * container, since the geometry is only known once a request arrives.
+ * \param[in] seg_ the segment to serve requests from.
+ * \param[in] init_mem_ the initial memory allocation per block of the
+ *                      container.
+ * \param[in] nt_ the number of threads to use, or zero to use the default. */
+shm_service::shm_service(shm_segment &seg_,int init_mem_,int nt_)
+	: seg(seg_), init_mem(init_mem_), nt(nt_), served(0), built(0),
+	con(NULL), conp(NULL) {
+	for(int i=0;i<6;i++) shape[i]=-1;
+}
+
+/** The class destructor frees the container. */
+shm_service::~shm_service() {
+	delete conp;
+	delete con;
+}
+
+/** Waits for a request from the producer, carries it out, and sends back the
+ * reply.
+ * \return False if the producer sent the quit command, true otherwise. */
+bool shm_service::serve() {
+	seg.wait_request();
+	switch(seg.h->command) {
+		case shm_compute: seg.reply(compute());return true;
+		case shm_quit: seg.reply(shm_ok);return false;
+		default: seg.reply(shm_bad_command);return true;
+	}
+}
+
+/** Serves requests until the producer sends the quit command. */
+void shm_service::run() {
+	while(serve());
+}
+
+/** Counts the number of result columns for a combination of result flags.
+ * \param[in] fields the combination of flags.
+ * \return The number of columns. */
+int shm_service::columns(unsigned int fields) {
+	int c=0;
+	if(fields&shm_volume) c++;
+	if(fields&shm_area) c++;
+	if(fields&shm_faces) c++;
+	if(fields&shm_vertices) c++;
+	if(fields&shm_centroid) c+=3;
+	if(fields&shm_max_radius) c++;
+	return c;
+}
+
+/** Carries out a compute request, by putting the particles in the segment
+ * into the container, and computing the requested results for their Voronoi
+ * cells.
+ * \return The status to send back. */
+int shm_service::compute() {
+	shm_header *h=seg.h;
+	const double *b=h->bounds;
+	int i,n=h->n,cols=columns(h->fields),sh[6];
+	if(n<0||n>h->max_n||!(b[0]<b[1])||!(b[2]<b[3])||!(b[4]<b[5])) return shm_bad_request;
+
+	// Set up the periodicity flags and the block grid, choosing the grid
+	// from the particle density if it is not given
+	for(i=0;i<3;i++) sh[i]=h->periodic[i]!=0;
+	if(h->grid[0]>0&&h->grid[1]>0&&h->grid[2]>0) for(i=0;i<3;i++) sh[i+3]=h->grid[i];
+	else {
+		double ilscale=pow(n/(optimal_particles*(b[1]-b[0])*(b[3]-b[2])*(b[5]-b[4])),1/3.0);
+		for(i=0;i<3;i++) sh[i+3]=int((b[2*i+1]-b[2*i])*ilscale+1);
+	}
+	setup(sh,h->polydisperse!=0);
+
+	// Put the particles into the container, recording the index of each one
+	// that is inside it
+	vo.clear();src.clear();
+	for(i=0;i<n;i++) {
+		int t=vo.total();
+		double *pp=seg.pos+3*i;
+		if(conp!=NULL) conp->put(vo,seg.id[i],*pp,pp[1],pp[2],seg.rad[i]);
+		else con->put(vo,seg.id[i],*pp,pp[1],pp[2]);
+		if(vo.total()>t) src.push_back(i);
+	}
+
+	// Compute the results, marking those of the particles that were not
+	// inserted as missing
+	h->columns=cols;
+	for(double *op=seg.out;op<seg.out+long(cols)*n;op++) *op=std::numeric_limits<double>::quiet_NaN();
+	if(conp!=NULL) compute_cells(*conp,cols);
+	else compute_cells(*con,cols);
+	served++;
+	return shm_ok;
+}
+
+/** Makes sure that the container matches the geometry of a request. If it
+ * does, then the container is cleared so that its memory can be reused, and
+ * otherwise a new container is built.
+ * \param[in] sh an array holding the three periodicity flags, followed by the
+ *               number of blocks in each direction.
+ * \param[in] poly whether a container for polydisperse particles is needed. */
+void shm_service::setup(const int *sh,bool poly) {
+	const double *b=seg.h->bounds;
+	bool same=(poly?conp!=NULL:con!=NULL);
+	for(int i=0;i<6;i++) if(b[i]!=bounds[i]||sh[i]!=shape[i]) same=false;
+	if(same) {
+		if(poly) conp->clear();
+		else con->clear();
+		return;
+	}
+	delete conp;conp=NULL;
+	delete con;con=NULL;
+	for(int i=0;i<6;i++) {bounds[i]=b[i];shape[i]=sh[i];}
+	if(poly) conp=new container_poly(b[0],b[1],b[2],b[3],b[4],b[5],sh[3],sh[4],sh[5],
+					 sh[0],sh[1],sh[2],init_mem);
+	else con=new container(b[0],b[1],b[2],b[3],b[4],b[5],sh[3],sh[4],sh[5],
+			       sh[0],sh[1],sh[2],init_mem);
+	built++;
+}
+
+/** Computes the Voronoi cells of the inserted particles in parallel, and
+ * writes the requested results into the segment. The total volume is summed
+ * in the order that the particles were inserted, so that it does not depend
+ * on the number of threads.
+ * \param[in] co the container to use.
+ * \param[in] cols the number of result columns. */
+template<class c_class>
+void shm_service::compute_cells(c_class &co,int cols) {
+	int m=vo.total();
+	unsigned int f=seg.h->fields;
+	std::vector<double> vol(m,0);
+	std::vector<char> done(m,0);
+	compute_order_parallel<voronoicell>(co,vo,[&](voronoicell &c,int,int,int l) {
+		int i=src[l];
+		double *op=seg.out+long(cols)*i,*pp=seg.pos+3*i,cx,cy,cz,cv;
+		vol[l]=c.volume();
+		done[l]=1;
+		if(f&shm_volume) *(op++)=vol[l];
+		if(f&shm_area) *(op++)=c.surface_area();
+		if(f&shm_faces) *(op++)=c.number_of_faces();
+		if(f&shm_vertices) *(op++)=c.p;
+		if(f&shm_centroid) {
+			c.centroid(cx,cy,cz,cv);
+			*(op++)=*pp+cx;
+			*(op++)=pp[1]+cy;
+			*(op++)=pp[2]+cz;
+		}
+		if(f&shm_max_radius) *op=0.5*sqrt(c.max_radius_squared());
+	},nt);
+	double tvol=0;
+	int k=0;
+	for(int l=0;l<m;l++) if(done[l]) {tvol+=vol[l];k++;}
+	seg.h->computed=k;
+	seg.h->volume=tvol;
+}
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file shm_service.hh
+ * \brief Header file for the shm_service class, which carries out Voronoi
+ * analysis on particles held in POSIX shared memory. */
+
+#ifndef VOROPP_SHM_SERVICE_HH
+#define VOROPP_SHM_SERVICE_HH
+
+#include "shm_segment.hh"
+
+#ifdef VOROPP_SHM_SEGMENT
+
+#include <vector>
+
+#include "config.hh"
+#include "common.hh"
+#include "c_loops.hh"
+#include "container.hh"
+
+namespace voro {
+
+/** \brief A class that carries out Voronoi analysis on particles held in a
+ * shared memory segment.
+ *
+ * This allows a simulation code to analyze its particles every few steps
+ * without writing snapshots to disk. The producer writes the particles and
+ * the container geometry into a segment, posts a request, and waits for the
+ * reply, while the service, running in a separate process, computes the
+ * requested results in parallel and writes them back into the segment. The
+ * producer only needs the shm_segment class, which is defined entirely in its
+ * header file, so the simulation code does not need to link to the library.
+ * The container is kept between requests, and is only rebuilt when the
+ * geometry or the block grid changes, so that its memory does not need to be
+ * allocated again. */
+class shm_service {
+	public:
+		/** The segment to serve requests from. */
+		shm_segment &seg;
+		/** The initial memory allocation per block of the container. */
+		const int init_mem;
+		/** The number of threads to use, or zero to use the default. */
+		int nt;
+		/** The number of requests that have been carried out. */
+		long served;
+		/** The number of times that the container has been built. */
+		int built;
+		shm_service(shm_segment &seg_,int init_mem_=8,int nt_=0);
+		~shm_service();
+		bool serve();
+		void run();
+		static int columns(unsigned int fields);
+	private:
+		/** The container used for monodisperse particles. */
+		container *con;
+		/** The container used for polydisperse particles. */
+		container_poly *conp;
+		/** The bounds of the current container. */
+		double bounds[6];
+		/** The periodicity flags and block grid of the current
+		 * container. */
+		int shape[6];
+		/** The ordering that records where each inserted particle is
+		 * stored. */
+		particle_order vo;
+		/** The index in the input arrays of each record in the
+		 * ordering. */
+		std::vector<int> src;
+		int compute();
+		void setup(const int *sh,bool poly);
+		template<class c_class>
+		void compute_cells(c_class &co,int cols);
+};
+
+}
+
+#endif
+
+#endif
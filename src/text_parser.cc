@@ -0,0 +1,271 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file text_parser.cc
+ * \brief Function implementations for the text_parser class. */
+
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <cfloat>
+#include <clocale>
+#include <string>
+
+#if defined(__unix__)||defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "text_parser.hh"
+
+namespace voro {
+
+/** The powers of ten that are exactly representable as doubles. */
+static const double exact_pow10[23]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,
+	1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+#if LDBL_MANT_DIG==64&&(defined(__x86_64__)||defined(__i386__))
+#define VOROPP_PARSE_EXTENDED
+/** The powers of ten that are exactly representable in the x87 extended
+ * precision format. */
+static const long double ext_pow10[28]={1e0L,1e1L,1e2L,1e3L,1e4L,1e5L,1e6L,1e7L,1e8L,1e9L,
+	1e10L,1e11L,1e12L,1e13L,1e14L,1e15L,1e16L,1e17L,1e18L,1e19L,1e20L,1e21L,1e22L,
+	1e23L,1e24L,1e25L,1e26L,1e27L};
+#endif
+
+/** The class constructor sets up an empty list of records.
+ * \param[in] nf_ the number of fields in each record, including the particle
+ *                ID. */
+text_parser::text_parser(int nf_) : nf(nf_), n(0), dpc('.') {
+	if(nf<1) voro_fatal_error("A record must have at least one field",VOROPP_INTERNAL_ERROR);
+}
+
+/** Parses the records in a block of memory. The block is split into chunks at
+ * line boundaries, the fields in each chunk are counted in parallel to find
+ * where each chunk starts within the list of records, and the chunks are then
+ * parsed in parallel. Any records previously stored are replaced.
+ * \param[in] buf a pointer to the start of the block.
+ * \param[in] len the length of the block in bytes.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \return True if the block was parsed successfully, false if it contains a
+ *         field that is not a number, or ends with an incomplete record. */
+bool text_parser::parse(const char *buf,size_t len,int nt) {
+	int c,nc=int(len/parse_chunk_size)+1;
+	const char *bp;
+	if(nt<=0) nt=voro_max_threads();
+	dpc=*localeconv()->decimal_point;
+
+	// Choose the chunk boundaries, moving each one to just after the
+	// next newline so that no field is split between two chunks
+	std::vector<size_t> cb(nc+1);
+	std::vector<long> tc(nc+1);
+	cb[0]=0;cb[nc]=len;
+	for(c=1;c<nc;c++) {
+		cb[c]=len/nc*c;
+		if(cb[c]<cb[c-1]) cb[c]=cb[c-1];
+		bp=(const char*) memchr(buf+cb[c],'\n',len-cb[c]);
+		cb[c]=bp==NULL?len:bp+1-buf;
+	}
+
+	// Count the fields in each chunk, and use the totals to find the index
+	// of the first field in each chunk
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nt)
+#endif
+	for(c=0;c<nc;c++) tc[c+1]=count(buf+cb[c],buf+cb[c+1]);
+	for(tc[0]=0,c=0;c<nc;c++) tc[c+1]+=tc[c];
+	if(tc[nc]%nf!=0) return false;
+	n=int(tc[nc]/nf);
+	id.resize(n);
+	v.resize(long(n)*(nf-1));
+
+	// Parse the chunks
+	std::vector<char> ok(nc);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nt)
+#endif
+	for(c=0;c<nc;c++) ok[c]=parse_chunk(buf+cb[c],buf+cb[c+1],tc[c]);
+	for(c=0;c<nc;c++) if(!ok[c]) return false;
+	return true;
+}
+
+/** Reads the whole of an open file stream into memory in large blocks, and
+ * parses the records in it.
+ * \param[in] fp the file handle to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \return True if the file was read and parsed successfully, false
+ *         otherwise. */
+bool text_parser::parse(FILE *fp,int nt) {
+	std::vector<char> buf(parse_chunk_size);
+	size_t l=0,k;
+	while((k=fread(buf.data()+l,1,buf.size()-l,fp))>0)
+		if((l+=k)==buf.size()) buf.resize(buf.size()<<1);
+	if(ferror(fp)) return false;
+	return parse(buf.data(),l,nt);
+}
+
+/** Parses the records in a file. On POSIX systems, the file is mapped into
+ * memory so that it does not need to be copied. If the file cannot be mapped,
+ * for example because it is a pipe, then it is read in large blocks instead.
+ * \param[in] filename the name of the file to read from.
+ * \param[in] nt the number of threads to use, or zero to use the default.
+ * \return True if the file was read and parsed successfully, false
+ *         otherwise. */
+bool text_parser::parse(const char *filename,int nt) {
+#if defined(__unix__)||defined(__APPLE__)
+	int fd=open(filename,O_RDONLY);
+	if(fd<0) {
+		fprintf(stderr,"voro++: Unable to open file '%s'\n",filename);
+		exit(VOROPP_FILE_ERROR);
+	}
+	struct stat st;
+	if(fstat(fd,&st)==0&&S_ISREG(st.st_mode)) {
+		if(st.st_size==0) {close(fd);return parse("",0,nt);}
+		void *mp=mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+		if(mp!=MAP_FAILED) {
+			close(fd);
+			bool r=parse((const char*) mp,st.st_size,nt);
+			munmap(mp,st.st_size);
+			return r;
+		}
+	}
+	close(fd);
+#endif
+	FILE *fp=safe_fopen(filename,"rb");
+	bool r=parse(fp,nt);
+	fclose(fp);
+	return r;
+}
+
+/** Counts the whitespace-separated fields in a range of characters.
+ * \param[in] (p,e) pointers to the start and end of the range.
+ * \return The number of fields. */
+long text_parser::count(const char *p,const char *e) {
+	long k=0;
+	while(true) {
+		while(p<e&&blank(*p)) p++;
+		if(p==e) return k;
+		k++;
+		while(p<e&&!blank(*p)) p++;
+	}
+}
+
+/** Parses the fields in a chunk, storing them in the records.
+ * \param[in] (p,e) pointers to the start and end of the chunk.
+ * \param[in] g the index of the first field in the chunk, counting over all
+ *              of the records.
+ * \return True if all of the fields were numbers, false otherwise. */
+bool text_parser::parse_chunk(const char *p,const char *e,long g) {
+	const char *q;
+	int f;
+	while(true) {
+		while(p<e&&blank(*p)) p++;
+		if(p==e) return true;
+		for(q=p+1;q<e&&!blank(*q);q++);
+		f=int(g%nf);
+		if(f==0) {
+			if(!parse_int(p,q,id[g/nf])) return false;
+		} else if(!parse_double(p,q,v[g/nf*(nf-1)+f-1])) return false;
+		p=q;g++;
+	}
+}
+
+/** Parses a field as an integer, in the same format as the %d conversion of
+ * scanf.
+ * \param[in] (p,e) pointers to the start and end of the field.
+ * \param[out] i the integer.
+ * \return True if the field is an integer that fits in an int, false
+ *         otherwise. */
+bool text_parser::parse_int(const char *p,const char *e,int &i) {
+	bool neg=false;
+	long long k=0;
+	if(*p=='-'||*p=='+') neg=*(p++)=='-';
+	if(p==e) return false;
+	for(;p<e;p++) {
+		if(*p<'0'||*p>'9') return false;
+		k=10*k+(*p-'0');
+		if(k>(long long) INT_MAX+1) return false;
+	}
+	if(neg) k=-k;
+	if(k>INT_MAX) return false;
+	i=int(k);
+	return true;
+}
+
+/** Parses a field as a floating point number. Decimal numbers whose
+ * significand is at most 2^53 and whose exponent is at most 22 in magnitude
+ * are converted with a single multiplication or division by an exact power of
+ * ten, which is correctly rounded. On x86 processors, numbers with up to
+ * nineteen significant digits and an exponent of up to 27 in magnitude, such
+ * as those printed with the %.17g format, are converted in the same way using
+ * extended precision, and the result is then rounded to double precision. This
+ * is correct unless the extended precision result lies exactly halfway between
+ * two doubles, which is checked for. Any other field, including infinities,
+ * NaNs and hexadecimal numbers, is passed to strtod, after its decimal point
+ * is replaced with the one of the current locale.
+ * \param[in] (p,e) pointers to the start and end of the field.
+ * \param[out] x the number.
+ * \return True if the field is a number, false otherwise. */
+bool text_parser::parse_double(const char *p,const char *e,double &x) {
+	const char *s=p;
+	bool neg=false,dig=false;
+	unsigned long long m=0;
+	int nd=0,ex=0,ee=0,es=1;
+
+	// Read the sign and the digits of the significand
+	if(*p=='-'||*p=='+') neg=*(p++)=='-';
+	for(;p<e&&*p>='0'&&*p<='9';p++) {
+		dig=true;
+		if(m>0||*p!='0') {
+			if(++nd>19) break;
+			m=10*m+(*p-'0');
+		}
+	}
+	if(p<e&&*p=='.') for(p++;p<e&&*p>='0'&&*p<='9';p++) {
+		dig=true;
+		if(m>0||*p!='0') {
+			if(++nd>19) break;
+			m=10*m+(*p-'0');
+		}
+		ex--;
+	}
+
+	// Read the exponent
+	if(dig&&p<e&&(*p=='e'||*p=='E')&&p+1<e) {
+		p++;
+		if(*p=='-'||*p=='+') es=*(p++)=='-'?-1:1;
+		if(p<e&&*p>='0'&&*p<='9') {
+			for(;p<e&&*p>='0'&&*p<='9';p++) if(ee<10000) ee=10*ee+(*p-'0');
+			ex+=es*ee;
+		} else p=s;
+	}
+
+	// Use the fast conversion if the whole field has been read and the
+	// result is exact
+	if(dig&&p==e&&m<=(1ULL<<53)&&ex>=-22&&ex<=22) {
+		x=ex<0?double(m)/exact_pow10[-ex]:double(m)*exact_pow10[ex];
+		if(neg) x=-x;
+		return true;
+	}
+#ifdef VOROPP_PARSE_EXTENDED
+	if(dig&&p==e&&ex>=-27&&ex<=27) {
+		long double y=ex<0?(long double) m/ext_pow10[-ex]:(long double) m*ext_pow10[ex];
+		unsigned long long b;
+		memcpy(&b,&y,sizeof(b));
+		if((b&0x7ff)!=0x400) {
+			x=neg?-double(y):double(y);
+			return true;
+		}
+	}
+#endif
+
+	// Otherwise, copy the field and convert it with strtod
+	std::string t(s,e);
+	if(dpc!='.') for(std::string::iterator ip=t.begin();ip!=t.end();ip++) if(*ip=='.') *ip=dpc;
+	char *r;
+	x=strtod(t.c_str(),&r);
+	return r==t.c_str()+t.size()&&r!=t.c_str();
+}
+
+}
@@ -0,0 +1,67 @@
+// Voro++, a 3D cell-based Voronoi library
+
+/** \file text_parser.hh
+ * \brief Header file for the text_parser class. */
+
+#ifndef VOROPP_TEXT_PARSER_HH
+#define VOROPP_TEXT_PARSER_HH
+
+#include <cstdio>
+#include <vector>
+
+#include "config.hh"
+#include "common.hh"
+
+namespace voro {
+
+/** \brief A class for reading text files of particle records in parallel.
+ *
+ * The import routines of the container classes read particles with fscanf,
+ * which processes the file on a single core and is often slower than the
+ * Voronoi computation itself. This class reads the whole file into memory,
+ * either by mapping it or by reading it in large blocks, and splits it into
+ * chunks at line boundaries. The numbers in each chunk are counted and then
+ * parsed in parallel, using a locale-independent routine that converts most
+ * decimal numbers exactly using a single floating point operation, and
+ * falls back to strtod for the rest.
+ *
+ * Each record consists of a fixed number of whitespace-separated fields,
+ * where the first is an integer particle ID and the others are floating point
+ * numbers. As with fscanf, records do not need to be on separate lines. Unlike
+ * fscanf, each field must be a complete number, so that a field like "1.5x"
+ * is an error rather than being split in two. */
+class text_parser {
+	public:
+		/** The number of fields in each record. */
+		const int nf;
+		/** The number of records that have been read. */
+		int n;
+		/** The particle IDs of the records. */
+		std::vector<int> id;
+		/** The floating point fields of the records, with nf-1 entries
+		 * per record. */
+		std::vector<double> v;
+		text_parser(int nf_);
+		bool parse(const char *buf,size_t len,int nt=0);
+		bool parse(FILE *fp,int nt=0);
+		bool parse(const char *filename,int nt=0);
+	private:
+		/** The decimal point character of the current locale, which
+		 * is used when a number is passed to strtod. */
+		char dpc;
+		/** Tests whether a character separates fields, in the same way
+		 * as the isspace function in the C locale.
+		 * \param[in] c the character to test.
+		 * \return True if the character is whitespace. */
+		static inline bool blank(char c) {
+			return c==' '||(c>='\t'&&c<='\r');
+		}
+		static long count(const char *p,const char *e);
+		bool parse_chunk(const char *p,const char *e,long g);
+		static bool parse_int(const char *p,const char *e,int &i);
+		bool parse_double(const char *p,const char *e,double &x);
+};
+
+}
+
+#endif
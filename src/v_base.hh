@@ -55,8 +55,14 @@ class voro_base {
 		double *mrad;
 		/** The pre-computed block worklists. */
 		static const unsigned int wl[wl_seq_length*wl_hgridcu];
-		bool contains_neighbor(const char* format);
+		static bool contains_neighbor(const char* format);
 		voro_base(int nx_,int ny_,int nz_,double boxx_,double boxy_,double boxz_);
+		/** The move constructor copies the grid geometry and takes
+		 * over the worklist radius array of another class.
+		 * \param[in] vb the class to move from. */
+		voro_base(voro_base &&vb) noexcept : nx(vb.nx), ny(vb.ny), nz(vb.nz),
+			nxy(vb.nxy), nxyz(vb.nxyz), boxx(vb.boxx), boxy(vb.boxy), boxz(vb.boxz),
+			xsp(vb.xsp), ysp(vb.ysp), zsp(vb.zsp), mrad(vb.mrad) {vb.mrad=0;}
 		~voro_base() {delete [] mrad;}
 	protected:
 		/** A custom int function that returns consistent stepping
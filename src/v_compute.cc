@@ -12,6 +12,7 @@
 #include "rad_option.hh"
 #include "container.hh"
 #include "container_prd.hh"
+#include "container_quant.hh"
 
 namespace voro {
 
@@ -23,11 +24,33 @@ template<class c_class>
 voro_compute<c_class>::voro_compute(c_class &con_,int hx_,int hy_,int hz_) :
 	con(con_), boxx(con_.boxx), boxy(con_.boxy), boxz(con_.boxz),
 	xsp(con_.xsp), ysp(con_.ysp), zsp(con_.zsp),
-	hx(hx_), hy(hy_), hz(hz_), hxy(hx_*hy_), hxyz(hxy*hz_), ps(con_.ps),
-	id(con_.id), p(con_.p), co(con_.co), bxsq(boxx*boxx+boxy*boxy+boxz*boxz),
-	mv(0), qu_size(3*(3+hxy+hz*(hx+hy))), wl(con_.wl), mrad(con_.mrad),
-	mask(new unsigned int[hxyz]), qu(new int[qu_size]), qu_l(qu+qu_size) {
+	hx(hx_), hy(hy_), hz(hz_), hxy(hx_*hy_), hxyz(hxy*hz_),
+	id(con_.id), co(con_.co), bxsq(boxx*boxx+boxy*boxy+boxz*boxz),
+	mv(0), wl(con_.wl), mrad(con_.mrad), mask(0) {
+	setup_mask_window(init_mask_window);
+	qu_size=3*(3+mwxy+mwz*(mwx+mwy));
+	qu=new int[qu_size];qu_l=qu+qu_size;
+}
+
+/** Allocates the mask window. In each direction, the window extends a given
+ * number of blocks either side of the central block. If this would make it at
+ * least as wide as the search grid, then the window spans the grid in that
+ * direction instead, and is indexed by absolute block position, so that the
+ * mask is never larger than one entry per block of the grid.
+ * \param[in] w the half-width of the window. */
+template<class c_class>
+void voro_compute<c_class>::setup_mask_window(int w) {
+	mw=w;
+	mwx=2*w+1<hx?2*w+1:hx;
+	mwy=2*w+1<hy?2*w+1:hy;
+	mwz=2*w+1<hz?2*w+1:hz;
+	mwxy=mwx*mwy;mwxyz=mwxy*mwz;
+	delete [] mask;
+	mask=new unsigned int[mwxyz];
 	reset_mask();
+#if VOROPP_VERBOSE >=2
+	if(w>init_mask_window) fprintf(stderr,"Mask window scaled up to %dx%dx%d\n",mwx,mwy,mwz);
+#endif
 }
 
 /** Scans all of the particles within a block to see if any of them have a
@@ -47,9 +70,7 @@ template<class c_class>
 inline void voro_compute<c_class>::scan_all(int ijk,double x,double y,double z,int di,int dj,int dk,particle_record &w,double &mrs) {
 	double x1,y1,z1,rs;bool in_block=false;
 	for(int l=0;l<co[ijk];l++) {
-		x1=p[ijk][ps*l]-x;
-		y1=p[ijk][ps*l+1]-y;
-		z1=p[ijk][ps*l+2]-z;
+		con.rel_pos(ijk,l,x,y,z,x1,y1,z1);
 		rs=con.r_current_sub(x1*x1+y1*y1+z1*z1,ijk,l);
 		if(rs<mrs) {mrs=rs;w.l=l;in_block=true;}
 	}
@@ -70,7 +91,7 @@ inline void voro_compute<c_class>::scan_all(int ijk,double x,double y,double z,i
 template<class c_class>
 void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,int cj,int ck,int ijk,particle_record &w,double &mrs) {
 	double qx=0,qy=0,qz=0,rs;
-	int i,j,k,di,dj,dk,ei,ej,ek,f,g,disp;
+	int i,j,k,di,dj,dk,ei,ej,ek,f,g,disp,oijk=ijk;
 	double fx,fy,fz,mxs,mys,mzs,*radp;
 	unsigned int q,*e,*mijk;
 
@@ -161,9 +182,11 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 		scan_all(ijk,x-qx,y-qy,z-qz,di,dj,dk,w,mrs);
 	} while(g<f);
 
-	// Update mask value and initialize queue
+	// Update mask value, center the mask window on the current block, and
+	// initialize queue
 	mv++;
 	if(mv==0) {reset_mask();mv=1;}
+	center_mask(i,j,k);
 	int *qu_s=qu,*qu_e=qu;
 
 	while(g<wl_seq_length-1) {
@@ -187,7 +210,7 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 		ei=di+i;if(ei<0||ei>=hx) continue;
 		ej=dj+j;if(ej<0||ej>=hy) continue;
 		ek=dk+k;if(ek<0||ek>=hz) continue;
-		mijk=mask+ei+hx*(ej+hy*ek);
+		mijk=mask_entry(ei,ej,ek);
 		*mijk=mv;
 
 		// Skip this block if it is further away than the current
@@ -220,6 +243,14 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
 		ijk=con.region_index(ci,cj,ck,ei,ej,ek,qx,qy,qz,disp);
 		scan_all(ijk,x-qx,y-qy,z-qz,di,dj,dk,w,mrs);
 
+		// If the neighbors of this block may lie outside the mask
+		// window, then enlarge the window and start the search again
+		if(mask_edge(ei,ej,ek,i,j,k)) {
+			setup_mask_window(mw<<1);
+			find_voronoi_cell(x,y,z,ci,cj,ck,oijk,w,mrs);
+			return;
+		}
+
 		// Test the neighbors of the current block, and add them to the
 		// block list if they haven't already been tested
 		if((qu_s<=qu_e?(qu_l-qu_e)+(qu_s-qu):qu_s-qu_e)<18) add_list_memory(qu_s,qu_e);
@@ -234,13 +265,13 @@ void voro_compute<c_class>::find_voronoi_cell(double x,double y,double z,int ci,
  * \param[in,out] qu_e a pointer to the end of the queue. */
 template<class c_class>
 inline void voro_compute<c_class>::add_to_mask(int ei,int ej,int ek,int *&qu_e) {
-	unsigned int *mijk=mask+ei+hx*(ej+hy*ek);
-	if(ek>0) if(*(mijk-hxy)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
-	if(ej>0) if(*(mijk-hx)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
+	unsigned int *mijk=mask_entry(ei,ej,ek);
+	if(ek>0) if(*(mijk-mwxy)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-mwxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
+	if(ej>0) if(*(mijk-mwx)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-mwx)=mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
 	if(ei>0) if(*(mijk-1)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk-1)=mv;*(qu_e++)=ei-1;*(qu_e++)=ej;*(qu_e++)=ek;}
 	if(ei<hx-1) if(*(mijk+1)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+1)=mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
-	if(ej<hy-1) if(*(mijk+hx)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
-	if(ek<hz-1) if(*(mijk+hxy)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
+	if(ej<hy-1) if(*(mijk+mwx)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+mwx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
+	if(ek<hz-1) if(*(mijk+mwxy)!=mv) {if(qu_e==qu_l) qu_e=qu;*(mijk+mwxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
 }
 
 /** Scans a worklist entry and adds any blocks to the queue
@@ -254,13 +285,13 @@ inline void voro_compute<c_class>::scan_bits_mask_add(unsigned int q,unsigned in
 		if((q&b1)==0&&ei<hx-1) {*(mijk+1)=mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
 	} else if((q&b1)==b1&&ei<hx-1) {*(mijk+1)=mv;*(qu_e++)=ei+1;*(qu_e++)=ej;*(qu_e++)=ek;}
 	if((q&b4)==b4) {
-		if(ej>0) {*(mijk-hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
-		if((q&b3)==0&&ej<hy-1) {*(mijk+hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
-	} else if((q&b3)==b3&&ej<hy-1) {*(mijk+hx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
+		if(ej>0) {*(mijk-mwx)=mv;*(qu_e++)=ei;*(qu_e++)=ej-1;*(qu_e++)=ek;}
+		if((q&b3)==0&&ej<hy-1) {*(mijk+mwx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
+	} else if((q&b3)==b3&&ej<hy-1) {*(mijk+mwx)=mv;*(qu_e++)=ei;*(qu_e++)=ej+1;*(qu_e++)=ek;}
 	if((q&b6)==b6) {
-		if(ek>0) {*(mijk-hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
-		if((q&b5)==0&&ek<hz-1) {*(mijk+hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
-	} else if((q&b5)==b5&&ek<hz-1) {*(mijk+hxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
+		if(ek>0) {*(mijk-mwxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek-1;}
+		if((q&b5)==0&&ek<hz-1) {*(mijk+mwxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
+	} else if((q&b5)==b5&&ek<hz-1) {*(mijk+mwxy)=mv;*(qu_e++)=ei;*(qu_e++)=ej;*(qu_e++)=ek+1;}
 }
 
 /** This routine computes a Voronoi cell for a single particle in the
@@ -289,35 +320,28 @@ inline void voro_compute<c_class>::scan_bits_mask_add(unsigned int q,unsigned in
 template<class c_class>
 template<class v_cell>
 bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,int ck) {
-	static const int count_list[8]={7,11,15,19,26,35,45,59},*count_e=count_list+8;
 	double x,y,z,x1,y1,z1,qx=0,qy=0,qz=0;
 	double xlo,ylo,zlo,xhi,yhi,zhi,x2,y2,z2,rs;
-	int i,j,k,di,dj,dk,ei,ej,ek,f,g,l,disp;
+	int i,j,k,di,dj,dk,ei,ej,ek,f,g,l,disp,oijk=ijk;
 	double fx,fy,fz,gxs,gys,gzs,*radp;
 	unsigned int q,*e,*mijk;
 
 	if(!con.initialize_voronoicell(c,ijk,s,ci,cj,ck,i,j,k,x,y,z,disp)) return false;
-	con.r_init(ijk,s);
+	con.r_init(rst,ijk,s);
 
 	// Initialize the Voronoi cell to fill the entire container
 	double crs,mrs;
 
-	int next_count=3,*count_p=(const_cast<int*> (count_list));
-
 	// Test all particles in the particle's local region first
 	for(l=0;l<s;l++) {
-		x1=p[ijk][ps*l]-x;
-		y1=p[ijk][ps*l+1]-y;
-		z1=p[ijk][ps*l+2]-z;
-		rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+		con.rel_pos(ijk,l,x,y,z,x1,y1,z1);
+		rs=con.r_scale(rst,x1*x1+y1*y1+z1*z1,ijk,l);
 		if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 	}
 	l++;
 	while(l<co[ijk]) {
-		x1=p[ijk][ps*l]-x;
-		y1=p[ijk][ps*l+1]-y;
-		z1=p[ijk][ps*l+2]-z;
-		rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+		con.rel_pos(ijk,l,x,y,z,x1,y1,z1);
+		rs=con.r_scale(rst,x1*x1+y1*y1+z1*z1,ijk,l);
 		if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 		l++;
 	}
@@ -366,16 +390,14 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 	f=e[0];g=0;
 	do {
 
-		// At the intervals specified by count_list, we recompute the
-		// maximum radius squared
-		if(g==next_count) {
-			mrs=c.max_radius_squared();
-			if(count_p!=count_e) next_count=*(count_p++);
-		}
+		// Update the maximum radius squared. This is cached by the
+		// cell and only requires a vertex scan if the furthest vertex
+		// has been cut off, so it is cheap to do for every block.
+		mrs=c.max_radius_squared();
 
 		// If mrs is less than the minimum distance to any untested
 		// block, then we are done
-		if(con.r_ctest(radp[g],mrs)) return true;
+		if(con.r_ctest(rst,radp[g],mrs)) return true;
 		g++;
 
 		// Load in a block off the worklist, permute it with the
@@ -408,22 +430,18 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		// those particles which can't possibly intersect the block.
 		if(co[ijk]>0) {
 			l=0;x2=x-qx;y2=y-qy;z2=z-qz;
-			if(!con.r_ctest(crs,mrs)) {
+			if(!con.r_ctest(rst,crs,mrs)) {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
-					rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+					con.rel_pos(ijk,l,x2,y2,z2,x1,y1,z1);
+					rs=con.r_scale(rst,x1*x1+y1*y1+z1*z1,ijk,l);
 					if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			} else {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
+					con.rel_pos(ijk,l,x2,y2,z2,x1,y1,z1);
 					rs=x1*x1+y1*y1+z1*z1;
-					if(con.r_scale_check(rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
+					if(con.r_scale_check(rst,rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			}
@@ -439,25 +457,25 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 	// block are not also on the worklist, and we start storing those
 	// points in a list in case we have to go block by block. Update the
 	// mask counter, and if it wraps around then reset the whole mask; that
-	// will only happen once every 2^32 tries.
+	// will only happen once every 2^32 tries. The mask only covers a window
+	// of blocks around the current one, so center it here.
 	mv++;
 	if(mv==0) {reset_mask();mv=1;}
+	center_mask(i,j,k);
 
 	// Set the queue pointers
 	int *qu_s=qu,*qu_e=qu;
 
 	while(g<wl_seq_length-1) {
 
-		// At the intervals specified by count_list, we recompute the
-		// maximum radius squared
-		if(g==next_count) {
-			mrs=c.max_radius_squared();
-			if(count_p!=count_e) next_count=*(count_p++);
-		}
+		// Update the maximum radius squared. This is cached by the
+		// cell and only requires a vertex scan if the furthest vertex
+		// has been cut off, so it is cheap to do for every block.
+		mrs=c.max_radius_squared();
 
 		// If mrs is less than the minimum distance to any untested
 		// block, then we are done
-		if(con.r_ctest(radp[g],mrs)) return true;
+		if(con.r_ctest(rst,radp[g],mrs)) return true;
 		g++;
 
 		// Load in a block off the worklist, permute it with the
@@ -474,7 +492,7 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		ei=di+i;if(ei<0||ei>=hx) continue;
 		ej=dj+j;if(ej<0||ej>=hy) continue;
 		ek=dk+k;if(ek<0||ek>=hz) continue;
-		mijk=mask+ei+hx*(ej+hy*ek);
+		mijk=mask_entry(ei,ej,ek);
 		*mijk=mv;
 
 		// Call the compute_min_max_radius() function. This returns
@@ -494,22 +512,18 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		// those particles which can't possibly intersect the block.
 		if(co[ijk]>0) {
 			l=0;x2=x-qx;y2=y-qy;z2=z-qz;
-			if(!con.r_ctest(crs,mrs)) {
+			if(!con.r_ctest(rst,crs,mrs)) {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
-					rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+					con.rel_pos(ijk,l,x2,y2,z2,x1,y1,z1);
+					rs=con.r_scale(rst,x1*x1+y1*y1+z1*z1,ijk,l);
 					if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			} else {
 				do {
-					x1=p[ijk][ps*l]-x2;
-					y1=p[ijk][ps*l+1]-y2;
-					z1=p[ijk][ps*l+2]-z2;
+					con.rel_pos(ijk,l,x2,y2,z2,x1,y1,z1);
 					rs=x1*x1+y1*y1+z1*z1;
-					if(con.r_scale_check(rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
+					if(con.r_scale_check(rst,rs,mrs,ijk,l)&&!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 					l++;
 				} while (l<co[ijk]);
 			}
@@ -526,11 +540,13 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 	}
 
 	// Do a check to see if we've reached the radius cutoff
-	if(con.r_ctest(radp[g],mrs)) return true;
+	if(con.r_ctest(rst,radp[g],mrs)) return true;
 
 	// We were unable to completely compute the cell based on the blocks in
 	// the worklist, so now we have to go block by block, reading in items
-	// off the list
+	// off the list. The support values of the cell are computed when
+	// first needed, and are reused until the cell is cut again.
+	sb_ok=false;
 	while(qu_s!=qu_e) {
 
 		// If we reached the end of the list memory loop back to the
@@ -600,13 +616,20 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 		if(co[ijk]>0) {
 			l=0;x2=x-qx;y2=y-qy;z2=z-qz;
 			do {
-				x1=p[ijk][ps*l]-x2;
-				y1=p[ijk][ps*l+1]-y2;
-				z1=p[ijk][ps*l+2]-z2;
-				rs=con.r_scale(x1*x1+y1*y1+z1*z1,ijk,l);
+				con.rel_pos(ijk,l,x2,y2,z2,x1,y1,z1);
+				rs=con.r_scale(rst,x1*x1+y1*y1+z1*z1,ijk,l);
 				if(!c.nplane(x1,y1,z1,rs,id[ijk][l])) return false;
 				l++;
 			} while (l<co[ijk]);
+			sb_ok=false;
+		}
+
+		// If the neighbors of this block may lie outside the mask
+		// window, then enlarge the window and compute the cell again.
+		// This happens rarely, since the window only grows.
+		if(mask_edge(ei,ej,ek,i,j,k)) {
+			setup_mask_window(mw<<1);
+			return compute_cell(c,oijk,s,ci,cj,ck);
 		}
 
 		// If there's not much memory on the block list then add more
@@ -632,14 +655,14 @@ bool voro_compute<c_class>::compute_cell(v_cell &c,int ijk,int s,int ci,int cj,i
 template<class c_class>
 template<class v_cell>
 bool voro_compute<c_class>::corner_test(v_cell &c,double xl,double yl,double zl,double xh,double yh,double zh) {
-	con.r_prime(xl*xl+yl*yl+zl*zl);
-	if(c.plane_intersects_guess(xh,yl,zl,con.r_cutoff(xl*xh+yl*yl+zl*zl))) return false;
-	if(c.plane_intersects(xh,yh,zl,con.r_cutoff(xl*xh+yl*yh+zl*zl))) return false;
-	if(c.plane_intersects(xl,yh,zl,con.r_cutoff(xl*xl+yl*yh+zl*zl))) return false;
-	if(c.plane_intersects(xl,yh,zh,con.r_cutoff(xl*xl+yl*yh+zl*zh))) return false;
-	if(c.plane_intersects(xl,yl,zh,con.r_cutoff(xl*xl+yl*yl+zl*zh))) return false;
-	if(c.plane_intersects(xh,yl,zh,con.r_cutoff(xl*xh+yl*yl+zl*zh))) return false;
-	return true;
+	con.r_prime(rst,xl*xl+yl*yl+zl*zl);
+	block_plane(0,xh,yl,zl,con.r_cutoff(rst,xl*xh+yl*yl+zl*zl));
+	block_plane(1,xh,yh,zl,con.r_cutoff(rst,xl*xh+yl*yh+zl*zl));
+	block_plane(2,xl,yh,zl,con.r_cutoff(rst,xl*xl+yl*yh+zl*zl));
+	block_plane(3,xl,yh,zh,con.r_cutoff(rst,xl*xl+yl*yh+zl*zh));
+	block_plane(4,xl,yl,zh,con.r_cutoff(rst,xl*xl+yl*yl+zl*zh));
+	block_plane(5,xh,yl,zh,con.r_cutoff(rst,xl*xh+yl*yl+zl*zh));
+	return block_test(c,6);
 }
 
 /** This function checks to see whether a particular block can possibly have
@@ -657,14 +680,14 @@ bool voro_compute<c_class>::corner_test(v_cell &c,double xl,double yl,double zl,
 template<class c_class>
 template<class v_cell>
 inline bool voro_compute<c_class>::edge_x_test(v_cell &c,double x0,double yl,double zl,double x1,double yh,double zh) {
-	con.r_prime(yl*yl+zl*zl);
-	if(c.plane_intersects_guess(x0,yl,zh,con.r_cutoff(yl*yl+zl*zh))) return false;
-	if(c.plane_intersects(x1,yl,zh,con.r_cutoff(yl*yl+zl*zh))) return false;
-	if(c.plane_intersects(x1,yl,zl,con.r_cutoff(yl*yl+zl*zl))) return false;
-	if(c.plane_intersects(x0,yl,zl,con.r_cutoff(yl*yl+zl*zl))) return false;
-	if(c.plane_intersects(x0,yh,zl,con.r_cutoff(yl*yh+zl*zl))) return false;
-	if(c.plane_intersects(x1,yh,zl,con.r_cutoff(yl*yh+zl*zl))) return false;
-	return true;
+	con.r_prime(rst,yl*yl+zl*zl);
+	block_plane(0,x0,yl,zh,con.r_cutoff(rst,yl*yl+zl*zh));
+	block_plane(1,x1,yl,zh,con.r_cutoff(rst,yl*yl+zl*zh));
+	block_plane(2,x1,yl,zl,con.r_cutoff(rst,yl*yl+zl*zl));
+	block_plane(3,x0,yl,zl,con.r_cutoff(rst,yl*yl+zl*zl));
+	block_plane(4,x0,yh,zl,con.r_cutoff(rst,yl*yh+zl*zl));
+	block_plane(5,x1,yh,zl,con.r_cutoff(rst,yl*yh+zl*zl));
+	return block_test(c,6);
 }
 
 /** This function checks to see whether a particular block can possibly have
@@ -682,14 +705,14 @@ inline bool voro_compute<c_class>::edge_x_test(v_cell &c,double x0,double yl,dou
 template<class c_class>
 template<class v_cell>
 inline bool voro_compute<c_class>::edge_y_test(v_cell &c,double xl,double y0,double zl,double xh,double y1,double zh) {
-	con.r_prime(xl*xl+zl*zl);
-	if(c.plane_intersects_guess(xl,y0,zh,con.r_cutoff(xl*xl+zl*zh))) return false;
-	if(c.plane_intersects(xl,y1,zh,con.r_cutoff(xl*xl+zl*zh))) return false;
-	if(c.plane_intersects(xl,y1,zl,con.r_cutoff(xl*xl+zl*zl))) return false;
-	if(c.plane_intersects(xl,y0,zl,con.r_cutoff(xl*xl+zl*zl))) return false;
-	if(c.plane_intersects(xh,y0,zl,con.r_cutoff(xl*xh+zl*zl))) return false;
-	if(c.plane_intersects(xh,y1,zl,con.r_cutoff(xl*xh+zl*zl))) return false;
-	return true;
+	con.r_prime(rst,xl*xl+zl*zl);
+	block_plane(0,xl,y0,zh,con.r_cutoff(rst,xl*xl+zl*zh));
+	block_plane(1,xl,y1,zh,con.r_cutoff(rst,xl*xl+zl*zh));
+	block_plane(2,xl,y1,zl,con.r_cutoff(rst,xl*xl+zl*zl));
+	block_plane(3,xl,y0,zl,con.r_cutoff(rst,xl*xl+zl*zl));
+	block_plane(4,xh,y0,zl,con.r_cutoff(rst,xl*xh+zl*zl));
+	block_plane(5,xh,y1,zl,con.r_cutoff(rst,xl*xh+zl*zl));
+	return block_test(c,6);
 }
 
 /** This function checks to see whether a particular block can possibly have
@@ -706,14 +729,14 @@ inline bool voro_compute<c_class>::edge_y_test(v_cell &c,double xl,double y0,dou
 template<class c_class>
 template<class v_cell>
 inline bool voro_compute<c_class>::edge_z_test(v_cell &c,double xl,double yl,double z0,double xh,double yh,double z1) {
-	con.r_prime(xl*xl+yl*yl);
-	if(c.plane_intersects_guess(xl,yh,z0,con.r_cutoff(xl*xl+yl*yh))) return false;
-	if(c.plane_intersects(xl,yh,z1,con.r_cutoff(xl*xl+yl*yh))) return false;
-	if(c.plane_intersects(xl,yl,z1,con.r_cutoff(xl*xl+yl*yl))) return false;
-	if(c.plane_intersects(xl,yl,z0,con.r_cutoff(xl*xl+yl*yl))) return false;
-	if(c.plane_intersects(xh,yl,z0,con.r_cutoff(xl*xh+yl*yl))) return false;
-	if(c.plane_intersects(xh,yl,z1,con.r_cutoff(xl*xh+yl*yl))) return false;
-	return true;
+	con.r_prime(rst,xl*xl+yl*yl);
+	block_plane(0,xl,yh,z0,con.r_cutoff(rst,xl*xl+yl*yh));
+	block_plane(1,xl,yh,z1,con.r_cutoff(rst,xl*xl+yl*yh));
+	block_plane(2,xl,yl,z1,con.r_cutoff(rst,xl*xl+yl*yl));
+	block_plane(3,xl,yl,z0,con.r_cutoff(rst,xl*xl+yl*yl));
+	block_plane(4,xh,yl,z0,con.r_cutoff(rst,xl*xh+yl*yl));
+	block_plane(5,xh,yl,z1,con.r_cutoff(rst,xl*xh+yl*yl));
+	return block_test(c,6);
 }
 
 /** This function checks to see whether a particular block can possibly have
@@ -729,12 +752,12 @@ inline bool voro_compute<c_class>::edge_z_test(v_cell &c,double xl,double yl,dou
 template<class c_class>
 template<class v_cell>
 inline bool voro_compute<c_class>::face_x_test(v_cell &c,double xl,double y0,double z0,double y1,double z1) {
-	con.r_prime(xl*xl);
-	if(c.plane_intersects_guess(xl,y0,z0,con.r_cutoff(xl*xl))) return false;
-	if(c.plane_intersects(xl,y0,z1,con.r_cutoff(xl*xl))) return false;
-	if(c.plane_intersects(xl,y1,z1,con.r_cutoff(xl*xl))) return false;
-	if(c.plane_intersects(xl,y1,z0,con.r_cutoff(xl*xl))) return false;
-	return true;
+	con.r_prime(rst,xl*xl);
+	block_plane(0,xl,y0,z0,con.r_cutoff(rst,xl*xl));
+	block_plane(1,xl,y0,z1,con.r_cutoff(rst,xl*xl));
+	block_plane(2,xl,y1,z1,con.r_cutoff(rst,xl*xl));
+	block_plane(3,xl,y1,z0,con.r_cutoff(rst,xl*xl));
+	return block_test(c,4);
 }
 
 /** This function checks to see whether a particular block can possibly have
@@ -750,12 +773,12 @@ inline bool voro_compute<c_class>::face_x_test(v_cell &c,double xl,double y0,dou
 template<class c_class>
 template<class v_cell>
 inline bool voro_compute<c_class>::face_y_test(v_cell &c,double x0,double yl,double z0,double x1,double z1) {
-	con.r_prime(yl*yl);
-	if(c.plane_intersects_guess(x0,yl,z0,con.r_cutoff(yl*yl))) return false;
-	if(c.plane_intersects(x0,yl,z1,con.r_cutoff(yl*yl))) return false;
-	if(c.plane_intersects(x1,yl,z1,con.r_cutoff(yl*yl))) return false;
-	if(c.plane_intersects(x1,yl,z0,con.r_cutoff(yl*yl))) return false;
-	return true;
+	con.r_prime(rst,yl*yl);
+	block_plane(0,x0,yl,z0,con.r_cutoff(rst,yl*yl));
+	block_plane(1,x0,yl,z1,con.r_cutoff(rst,yl*yl));
+	block_plane(2,x1,yl,z1,con.r_cutoff(rst,yl*yl));
+	block_plane(3,x1,yl,z0,con.r_cutoff(rst,yl*yl));
+	return block_test(c,4);
 }
 
 /** This function checks to see whether a particular block can possibly have
@@ -771,12 +794,35 @@ inline bool voro_compute<c_class>::face_y_test(v_cell &c,double x0,double yl,dou
 template<class c_class>
 template<class v_cell>
 inline bool voro_compute<c_class>::face_z_test(v_cell &c,double x0,double y0,double zl,double x1,double y1) {
-	con.r_prime(zl*zl);
-	if(c.plane_intersects_guess(x0,y0,zl,con.r_cutoff(zl*zl))) return false;
-	if(c.plane_intersects(x0,y1,zl,con.r_cutoff(zl*zl))) return false;
-	if(c.plane_intersects(x1,y1,zl,con.r_cutoff(zl*zl))) return false;
-	if(c.plane_intersects(x1,y0,zl,con.r_cutoff(zl*zl))) return false;
-	return true;
+	con.r_prime(rst,zl*zl);
+	block_plane(0,x0,y0,zl,con.r_cutoff(rst,zl*zl));
+	block_plane(1,x0,y1,zl,con.r_cutoff(rst,zl*zl));
+	block_plane(2,x1,y1,zl,con.r_cutoff(rst,zl*zl));
+	block_plane(3,x1,y0,zl,con.r_cutoff(rst,zl*zl));
+	return block_test(c,4);
+}
+
+/** This function checks whether a block can possibly have any intersection
+ * with a Voronoi cell, using the rejection planes that have been stored in the
+ * bp array. Each plane is first compared against the support values of the
+ * cell, which bound the vertex positions along the coordinate directions, and
+ * is discarded if the bound shows that it cannot intersect. The remaining
+ * planes are then tested together in a single pass over the cell vertices.
+ * \param[in] c a reference to a Voronoi cell.
+ * \param[in] n the number of rejection planes.
+ * \return False if the block may intersect, true if does not. */
+template<class c_class>
+template<class v_cell>
+inline bool voro_compute<c_class>::block_test(v_cell &c,int n) {
+	double *pp,*qp=bp;
+	if(!sb_ok) {c.support_box(sb);sb_ok=true;}
+	for(pp=bp;pp<bp+(n<<2);pp+=4)
+		if((*pp>0?*pp*sb[1]:*pp*sb[0])+(pp[1]>0?pp[1]*sb[3]:pp[1]*sb[2])
+		  +(pp[2]>0?pp[2]*sb[5]:pp[2]*sb[4])>pp[3]) {
+			if(qp!=pp) {*qp=*pp;qp[1]=pp[1];qp[2]=pp[2];qp[3]=pp[3];}
+			qp+=4;
+		}
+	return qp==bp||!c.planes_intersect(int(qp-bp)>>2,bp);
 }
 
 /** This routine checks to see whether a point is within a particular distance
@@ -804,14 +850,14 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo+boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo+boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxx*(2*xlo+boxx)+boxy*(2*ylo+boxy)+gzs;
 			}
 		} else if(dj<0) {
@@ -819,27 +865,27 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo-boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(boxx*xlo-boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxx*(2*xlo+boxx)+boxy*(-2*ylo+boxy)+gzs;
 			}
 		} else {
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=gys+boxx*(2*xlo+boxx);
@@ -852,14 +898,14 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo+boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo+boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxx*(-2*xlo+boxx)+boxy*(2*ylo+boxy)+gzs;
 			}
 		} else if(dj<0) {
@@ -867,27 +913,27 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs+=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo-boxy*ylo+boxz*zlo);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=bxsq+2*(-boxx*xlo-boxy*ylo-boxz*zlo);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxx*(-2*xlo+boxx)+boxy*(-2*ylo+boxy)+gzs;
 			}
 		} else {
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=gys+boxx*(-2*xlo+boxx);
@@ -898,14 +944,14 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=boxy*(2*ylo+boxy);
@@ -914,23 +960,23 @@ bool voro_compute<c_class>::compute_min_max_radius(int di,int dj,int dk,double f
 			crs=ylo*ylo;
 			if(dk>0) {
 				zlo=dk*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
 				zlo=(dk+1)*boxz-fz;
-				crs+=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				crs+=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
-				if(con.r_ctest(crs,mrs)) return true;
+				if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=gzs;
 			}
 			crs+=boxy*(-2*ylo+boxy);
 		} else {
 			if(dk>0) {
-				zlo=dk*boxz-fz;crs=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				zlo=dk*boxz-fz;crs=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(2*zlo+boxz);
 			} else if(dk<0) {
-				zlo=(dk+1)*boxz-fz;crs=zlo*zlo;if(con.r_ctest(crs,mrs)) return true;
+				zlo=(dk+1)*boxz-fz;crs=zlo*zlo;if(con.r_ctest(rst,crs,mrs)) return true;
 				crs+=boxz*(-2*zlo+boxz);
 			} else {
 				crs=0;
@@ -1003,4 +1049,9 @@ template bool voro_compute<container_periodic_poly>::compute_cell(voronoicell&,i
 template bool voro_compute<container_periodic_poly>::compute_cell(voronoicell_neighbor&,int,int,int,int,int);
 template void voro_compute<container_periodic_poly>::find_voronoi_cell(double,double,double,int,int,int,int,particle_record&,double&);
 
+// Explicit template instantiation
+template voro_compute<container_quant>::voro_compute(container_quant&,int,int,int);
+template bool voro_compute<container_quant>::compute_cell(voronoicell&,int,int,int,int,int);
+template bool voro_compute<container_quant>::compute_cell(voronoicell_neighbor&,int,int,int,int,int);
+
 }
@@ -13,6 +13,7 @@
 #include "config.hh"
 #include "worklist.hh"
 #include "cell.hh"
+#include "rad_option.hh"
 
 namespace voro {
 
@@ -71,20 +72,32 @@ class voro_compute {
 		/** A constant, set to the value of hx*hy*hz, which is used in
 		 * the routines which step through mask boxes in sequence. */
 		const int hxyz;
-		/** The number of floating point entries to store for each
-		 * particle. */
-		const int ps;
 		/** This array holds the numerical IDs of each particle in each
 		 * computational box. */
 		int **id;
-		/** A two dimensional array holding particle positions. For the
-		 * derived container_poly class, this also holds particle
-		 * radii. */
-		double **p;
 		/** An array holding the number of particles within each
 		 * computational box of the container. */
 		int *co;
 		voro_compute(c_class &con_,int hx_,int hy_,int hz_);
+		/** The move constructor takes over the mask and queue of
+		 * another class, and binds to a given container. This is used
+		 * when a container is moved, since the computation class must
+		 * then refer to the new container.
+		 * \param[in] con_ the container to bind to.
+		 * \param[in] vc the class to move from. */
+		voro_compute(c_class &con_,voro_compute &&vc) noexcept :
+			con(con_), boxx(vc.boxx), boxy(vc.boxy), boxz(vc.boxz),
+			xsp(vc.xsp), ysp(vc.ysp), zsp(vc.zsp), hx(vc.hx), hy(vc.hy), hz(vc.hz),
+			hxy(vc.hxy), hxyz(vc.hxyz), id(con_.id), co(con_.co),
+			bxsq(vc.bxsq), mv(vc.mv), qu_size(vc.qu_size), wl(vc.wl), mrad(con_.mrad),
+			mw(vc.mw), mwx(vc.mwx), mwy(vc.mwy), mwz(vc.mwz), mwxy(vc.mwxy), mwxyz(vc.mwxyz),
+			moff(vc.moff), mask(vc.mask), qu(vc.qu), qu_l(vc.qu_l) {
+			vc.mask=0;vc.qu=vc.qu_l=0;
+		}
+		/** The move constructor takes over the mask and queue of
+		 * another class, remaining bound to the same container.
+		 * \param[in] vc the class to move from. */
+		voro_compute(voro_compute &&vc) noexcept : voro_compute(vc.con,std::move(vc)) {}
 		/** The class destructor frees the dynamically allocated memory
 		 * for the mask and queue. */
 		~voro_compute() {
@@ -108,8 +121,29 @@ class voro_compute {
 		/** An pointer to the array holding the minimum distances
 		 * associated with the worklists. */
 		double *mrad;
+		/** The half-width of the mask window, in blocks. */
+		int mw;
+		/** The number of boxes in the x direction of the mask window.
+		 */
+		int mwx;
+		/** The number of boxes in the y direction of the mask window.
+		 */
+		int mwy;
+		/** The number of boxes in the z direction of the mask window.
+		 */
+		int mwz;
+		/** The number of boxes in the mask window in an xy slice. */
+		int mwxy;
+		/** The total number of boxes in the mask window. */
+		int mwxyz;
+		/** The offset that maps a block position to its position in
+		 * the mask window, for the block currently being computed. */
+		int moff;
 		/** This array is used during the cell computation to determine
-		 * which blocks have been considered. */
+		 * which blocks have been considered. It covers a window of
+		 * blocks centered on the block of the particle being
+		 * computed, rather than the whole grid, and it is enlarged if
+		 * a search reaches its edge. */
 		unsigned int *mask;
 		/** An array is used to store the queue of blocks to test
 		 * during the Voronoi cell computation. */
@@ -117,6 +151,18 @@ class voro_compute {
 		/** A pointer to the end of the queue array, used to determine
 		 * when the queue is full. */
 		int *qu_l;
+		/** An array holding the rejection planes of the block currently
+		 * being tested, with four entries per plane. */
+		double bp[24];
+		/** The support values of the cell along the coordinate
+		 * directions, which are used to discard rejection planes
+		 * without examining the vertices. */
+		double sb[6];
+		/** Whether the support values are up to date with the cell. */
+		bool sb_ok;
+		/** The constants set up by the container's radius routines for
+		 * the cell currently being computed. */
+		radius_state rst;
 		template<class v_cell>
 		bool corner_test(v_cell &c,double xl,double yl,double zl,double xh,double yh,double zh);
 		template<class v_cell>
@@ -131,16 +177,55 @@ class voro_compute {
 		inline bool face_y_test(v_cell &c,double x0,double yl,double z0,double x1,double z1);
 		template<class v_cell>
 		inline bool face_z_test(v_cell &c,double x0,double y0,double zl,double x1,double y1);
+		template<class v_cell>
+		inline bool block_test(v_cell &c,int n);
+		/** Stores one of the rejection planes of the block currently
+		 * being tested.
+		 * \param[in] l the index of the plane.
+		 * \param[in] (x,y,z) the normal vector to the plane.
+		 * \param[in] rsq the distance along this vector of the plane. */
+		inline void block_plane(int l,double x,double y,double z,double rsq) {
+			double *pp=bp+(l<<2);
+			*pp=x;pp[1]=y;pp[2]=z;pp[3]=rsq;
+		}
 		bool compute_min_max_radius(int di,int dj,int dk,double fx,double fy,double fz,double gx,double gy,double gz,double& crs,double mrs);
 		bool compute_min_radius(int di,int dj,int dk,double fx,double fy,double fz,double mrs);
 		inline void add_to_mask(int ei,int ej,int ek,int *&qu_e);
 		inline void scan_bits_mask_add(unsigned int q,unsigned int *mijk,int ei,int ej,int ek,int *&qu_e);
 		inline void scan_all(int ijk,double x,double y,double z,int di,int dj,int dk,particle_record &w,double &mrs);
 		void add_list_memory(int*& qu_s,int*& qu_e);
+		void setup_mask_window(int w);
 		/** Resets the mask in cases where the mask counter wraps
 		 * around. */
 		inline void reset_mask() {
-			for(unsigned int *mp(mask);mp<mask+hxyz;mp++) *mp=0;
+			for(unsigned int *mp(mask);mp<mask+mwxyz;mp++) *mp=0;
+		}
+		/** Centers the mask window on a given block. In directions
+		 * where the window spans the whole search grid, it is left in
+		 * place.
+		 * \param[in] (i,j,k) the mask coordinates of the block. */
+		inline void center_mask(int i,int j,int k) {
+			moff=(mwx<hx?(mwx>>1)-i:0)+mwx*((mwy<hy?(mwy>>1)-j:0)
+			    +mwy*(mwz<hz?(mwz>>1)-k:0));
+		}
+		/** Returns a pointer to the mask entry for a block.
+		 * \param[in] (ei,ej,ek) the mask coordinates of the block.
+		 * \return The pointer. */
+		inline unsigned int* mask_entry(int ei,int ej,int ek) {
+			return mask+(moff+ei+mwx*(ej+mwy*ek));
+		}
+		/** Checks whether a block lies on the edge of the mask window,
+		 * so that its neighbors within the search grid may fall
+		 * outside the window.
+		 * \param[in] (ei,ej,ek) the mask coordinates of the block.
+		 * \param[in] (i,j,k) the mask coordinates of the block at the
+		 *                    center of the window.
+		 * \return True if the block is on the edge, false otherwise.
+		 */
+		inline bool mask_edge(int ei,int ej,int ek,int i,int j,int k) {
+			return (mwx<hx&&((ei-i>=mwx>>1&&ei<hx-1)||(i-ei>=mwx>>1&&ei>0)))
+			     ||(mwy<hy&&((ej-j>=mwy>>1&&ej<hy-1)||(j-ej>=mwy>>1&&ej>0)))
+			     ||(mwz<hz&&((ek-k>=mwz>>1&&ek<hz-1)||(k-ek>=mwz>>1&&ek>0)));
 		}
 };
 
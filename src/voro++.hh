@@ -85,10 +85,26 @@
  * the plane, and from there, traces out a new face on the cell, recomputing
  * the edge and vertex structure accordingly.
  *
+ * When a cell is computed without a container, from a list of neighbors
+ * supplied by the user, the nplanes() routine can be used to cut it by a
+ * whole batch of planes at once. It applies the planes in order of increasing
+ * distance, skipping those that lie beyond the cell, and the
+ * voronoicell_neighbor version can report which planes produced faces.
+ *
  * Once the cell is computed, there are many routines for computing features of
  * the the Voronoi cell, such as its volume, surface area, or centroid. There
  * are also many routines for outputting features of the Voronoi cell, or
- * writing its shape in formats that can be read by Gnuplot or POV-Ray.
+ * writing its shape in formats that can be read by Gnuplot or POV-Ray. The
+ * ball_intersection() routine computes the volume of the intersection of the
+ * cell with balls centered on the particle, together with the sphere and face
+ * areas inside the cell, analytically and for several radii in one traversal,
+ * which is useful for local packing fractions. The gradients() routine of the
+ * voronoicell_neighbor class gives the derivatives of the cell volume and
+ * surface area with respect to the positions of the particle and its
+ * neighbors, by integrating the motion of each face over its area and the
+ * motion of each edge along its length. The minkowski_tensors() routine
+ * computes the rank two Minkowski tensors of the cell, its inertia tensor,
+ * and their anisotropy indices in a traversal of the faces and edges.
  *
  * \subsection internal Internal data representation
  * The voronoicell class has a public member p representing the
@@ -170,6 +186,11 @@
  * Each container class contains routines that tell the voro_compute template
  * about the specific geometry of this container.
  *
+ * The container and container_poly classes can optionally maintain an
+ * id_index, which records where each particle is stored as it is added. This
+ * allows the cell of a particle, or the position of a neighboring particle,
+ * to be found from its ID in constant time.
+ *
  * \section voro_compute The voro_compute template
  * The voro_compute template encapsulates the routines for carrying out the
  * Voronoi cell computations. It contains data structures suchs as a mask and a
@@ -312,7 +333,129 @@
  * available, and the pre_container_poly class can be used when radius
  * information is available. At present, the pre_container classes can only be
  * used with the container and container_poly classes. They do not support
- * the container_periodic and container_periodic_poly classes. */
+ * the container_periodic and container_periodic_poly classes.
+ *
+ * \section cell_store The cell_store class
+ * Analyses that query the same tessellation several times can avoid
+ * recomputing the cells by saving them in a cell_store. This holds each cell
+ * in a compact form in a single memory arena, with vertex positions quantized
+ * relative to the particle, a face vertex list, and the neighbor IDs. A stored
+ * cell can be restored into a voronoicell or voronoicell_neighbor class, so
+ * that all of the statistics and output routines can be used on it.
+ *
+ * \section flat_cell The flat_cell class
+ * When several statistics of a cell are needed, the cell can be converted into
+ * a flat_cell, which splits each face into a fan of triangles in a single
+ * traversal and stores their corner positions in contiguous arrays. The
+ * volume, centroid, face areas, and face normals are then computed by loops
+ * over the triangles that can be vectorized, rather than by repeatedly tracing
+ * around the edges of the cell. The class can also extract the face planes,
+ * test batches of points for containment, and generate uniform random points
+ * inside the cell using a tetrahedral decomposition.
+ *
+ * \section fv_mesh The fv_mesh class
+ * The fv_mesh class assembles the cells of a container into a finite-volume
+ * mesh. The cells are computed in parallel, and the area, unit normal, and
+ * centroid of every face, together with the volume and centroid of the cell,
+ * are found in one traversal by the face_geometry() routine. The faces are
+ * then linked so that each face between two cells is stored once, with an
+ * owner and a neighbor, and the faces of each cell are listed in compressed
+ * sparse row format.
+ *
+ * \section kinetic The kinetic_container class
+ * The kinetic_container class follows the tessellation of particles that move
+ * with constant velocities, for event-driven and coarse-stepped simulations.
+ * It stores the neighbors of each cell, and computes the time at which they
+ * could first change from certificates on the vertices of the cell, which
+ * are polynomials in time. The failure times are kept in a priority queue,
+ * and when the simulation advances, only the cells whose certificates have
+ * failed are recomputed. The cell of any particle can be rebuilt quickly from
+ * its stored neighbors.
+ *
+ * \section container_quant The container_quant class
+ * For very large systems, most of the memory of a container is taken up by
+ * the particle positions. The container_quant class stores each coordinate as
+ * a 16-bit or 32-bit integer giving the position of the particle within its
+ * computational block, chosen so that the error in each coordinate is within
+ * a bound given by the user. The voro_compute template converts the positions
+ * back to doubles as it tests the particles in each block, using the rel_pos
+ * routine of the container class.
+ *
+ * \section text_parser The text_parser class
+ * The text_parser class reads text files of particle records in parallel. The
+ * file is mapped into memory, split into chunks at line boundaries, and the
+ * numbers in each chunk are parsed by a separate thread using a
+ * locale-independent routine. The import_parallel routines of the container
+ * classes use it to read the same formats as the import routines, and pass
+ * the records to the put_bulk routines, which locate the blocks of the
+ * particles in parallel and allocate the memory of each block once.
+ *
+ * \section shm_service The shm_service class
+ * A simulation code can have its particles analyzed every few steps by a
+ * separate process, without writing snapshots to disk. The shm_segment class
+ * creates a POSIX shared memory segment holding the particle arrays, the
+ * container geometry, and space for per-particle results, and exchanges
+ * requests and replies through a pair of process-shared semaphores. It is
+ * defined entirely in its header file, so the simulation code does not need
+ * to link to the library. The shm_service class attaches to the segment,
+ * keeps a container between requests, and computes the requested results in
+ * parallel, writing them back in the order of the input arrays.
+ *
+ * \section restricted_voronoi The restricted_voronoi class
+ * For surface remeshing, the particles are sample points on a surface, and
+ * only the intersections of their Voronoi cells with the surface are needed.
+ * The restricted_voronoi class computes these for a triangle mesh, without
+ * computing the three-dimensional cells. Each triangle is clipped by the
+ * bisecting planes between a particle and its nearest neighbors, stopping
+ * once the neighbors are too far away to cut the clipped polygon. The class
+ * stores the polygons along with the area and centroid of each restricted
+ * cell, which can be used for a Lloyd iteration on the surface.
+ *
+ * \section container_roi The container_roi class
+ * When only the cells within a small region of interest of a large snapshot
+ * are needed, the container_roi class can be used instead of importing the
+ * whole snapshot. It reads particles from a particle_stream, which can be a
+ * text file or a binary file, and only keeps those within the region of
+ * interest and a surrounding halo. The cells in the region of interest are
+ * then checked: a cell is exact if the sphere with twice its maximum vertex
+ * radius lies within the loaded region. If any cell fails this test, the halo
+ * is grown and the stream is read again, so that the cost of the computation
+ * scales with the size of the region of interest.
+ *
+ * \section cell_profiler The cell_profiler class
+ * The cost of computing a Voronoi cell can vary widely, and a small number of
+ * slow cells can dominate the total time. The container compute_all_cells and
+ * print_custom routines have variants that take a cell_profiler, which
+ * records the computation time, number of plane cuts, and peak vertex count of
+ * each cell in logarithmic histograms. It also keeps the slowest cells, which
+ * can be written to a replay file with the particle position and its local
+ * neighborhood. The replay routine reads this file and reconstructs each cell
+ * with a standalone voronoicell, so that a difficult case can be reproduced
+ * without the original particle set.
+ *
+ * \section order_parallel Parallel computation of particle orderings
+ * When the cells of a selected subset of particles are required, the subset
+ * can be stored in a particle_order class, either as the particles are added
+ * to a container, or afterwards from a list of IDs with the add_ids routine.
+ * The compute_order_parallel routine computes the cells in the ordering using
+ * several threads, each with its own voro_compute class, and calls a function
+ * object for each cell along with its index in the ordering. The
+ * print_custom_order_parallel routine uses this approach to produce custom
+ * output, which is buffered in batches so that it is written in the original
+ * insertion order. The sample_cells_order_parallel routine generates random
+ * points inside each cell of the ordering, with results that do not depend on
+ * the number of threads, and the ball_intersection_order_parallel routine
+ * computes cell-ball intersection measures. The gradients_order_parallel
+ * routine assembles the volume and surface area gradients of the cells into a
+ * sparse matrix, with walls taken to be fixed, and the
+ * minkowski_tensors_order_parallel routine stores the shape descriptors of the
+ * cells in a flat array. The compute_all_parallel
+ * routine computes all of the cells in a container, dividing the blocks between the threads in contiguous
+ * ranges. On a NUMA machine, the container's first_touch routine can be called
+ * beforehand so that each block is placed on the memory node of the thread
+ * that computes it, and the voro_pin_threads routine keeps the threads on
+ * fixed CPUs. These routines use OpenMP, and run serially if the code is
+ * compiled without it. */
 
 #ifndef VOROPP_HH
 #define VOROPP_HH
@@ -325,7 +468,18 @@
 #include "container.hh"
 #include "unitcell.hh"
 #include "container_prd.hh"
+#include "container_quant.hh"
 #include "pre_container.hh"
+#include "container_roi.hh"
+#include "cell_store.hh"
+#include "flat_cell.hh"
+#include "cell_profiler.hh"
+#include "order_parallel.hh"
+#include "fv_mesh.hh"
+#include "kinetic.hh"
+#include "text_parser.hh"
+#include "shm_service.hh"
+#include "restricted_voronoi.hh"
 #include "v_compute.hh"
 #include "c_loops.hh"
 #include "wall.hh"